@@ -24,11 +24,24 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <openddlparser/OpenDDLParser.h>
 
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 
 BEGIN_ODDLPARSER_NS
 
 DDLNode::DllNodeList DDLNode::s_allocatedNodes;
 
+const size_t DDLNode::InvalidTreeIndex = static_cast<size_t>( -1 );
+
+static std::atomic<size_t> s_treeGeneration( 0 );
+
+static std::mutex s_materializeMutex;
+
+// nodes created by a parser worker thread are collected here until they are spliced
+static thread_local DDLNode::DllNodeList *s_threadArena = ddl_nullptr;
+
+static const size_t ArenaIndex = static_cast<size_t>( -1 );
+
 template<class T>
 inline
 static void releaseDataType( T *ptr ) {
@@ -55,15 +68,28 @@ static void releaseReferencedNames( Reference *ref ) {
 DDLNode::DDLNode( const std::string &type, const std::string &name, size_t idx, DDLNode *parent )
 : m_type( type )
 , m_name( name )
+, m_nameType( GlobalName )
 , m_parent( parent )
 , m_children()
 , m_properties( ddl_nullptr )
 , m_value( ddl_nullptr )
 , m_dtArrayList( ddl_nullptr )
 , m_references( ddl_nullptr )
-, m_idx( idx ) {
+, m_idx( idx )
+, m_lazyParser( ddl_nullptr )
+, m_lazyBegin( 0 )
+, m_lazyEnd( 0 )
+, m_treeIdx( InvalidTreeIndex )
+, m_treeEnd( InvalidTreeIndex )
+, m_treeGeneration( 0 )
+, m_typeMask( getTypeMask( type ) )
+, m_dirty( true )
+, m_subtreeDirty( true )
+, m_snapshot() {
     if( m_parent ) {
         m_parent->m_children.push_back( this );
+        m_parent->addSubtreeTypeMask( m_typeMask );
+        m_parent->markSubtreeDirty();
     }
 }
 
@@ -74,8 +100,14 @@ DDLNode::~DDLNode() {
 
     delete m_dtArrayList;
     m_dtArrayList = ddl_nullptr;
-    if( s_allocatedNodes[ m_idx ] == this ) {
+    // arena and retired nodes must not touch the registry, other threads may use it
+    if( ArenaIndex != m_idx && m_idx < s_allocatedNodes.size() && s_allocatedNodes[ m_idx ] == this ) {
         s_allocatedNodes[ m_idx ] = ddl_nullptr;
+
+        // nodes released in creation order ( streaming ) keep the registry small
+        while( !s_allocatedNodes.empty() && ddl_nullptr == s_allocatedNodes.back() ) {
+            s_allocatedNodes.pop_back();
+        }
     }
 }
 
@@ -87,7 +119,10 @@ void DDLNode::attachParent( DDLNode *parent ) {
     m_parent = parent;
     if( ddl_nullptr != m_parent ) {
         m_parent->m_children.push_back( this );
+        m_parent->addSubtreeTypeMask( m_typeMask );
+        m_parent->markSubtreeDirty();
     }
+    invalidateTreeIndex();
 }
 
 void DDLNode::detachParent() {
@@ -97,7 +132,9 @@ void DDLNode::detachParent() {
         if( m_parent->m_children.end() != it ) {
             m_parent->m_children.erase( it );
         }
+        m_parent->markSubtreeDirty();
         m_parent = ddl_nullptr;
+        invalidateTreeIndex();
     }
 }
 
@@ -106,11 +143,33 @@ DDLNode *DDLNode::getParent() const {
 }
 
 const DDLNode::DllNodeList &DDLNode::getChildNodeList() const {
+    materialize();
     return m_children;
 }
 
+bool DDLNode::isMaterialized() const {
+    return ( ddl_nullptr == m_lazyParser );
+}
+
+bool DDLNode::materialize() const {
+    if( ddl_nullptr == m_lazyParser ) {
+        return true;
+    }
+
+    // the bodies are parsed with the state of their parser, one at a time
+    std::unique_lock<std::mutex> lock( s_materializeMutex );
+    OpenDDLParser *parser( m_lazyParser );
+    if( ddl_nullptr == parser ) {
+        return true;
+    }
+
+    return parser->materializeNode( const_cast<DDLNode*>( this ) );
+}
+
 void DDLNode::setType( const std::string &type ) {
     m_type = type;
+    touch();
+    addSubtreeTypeMask( getTypeMask( type ) );
 }
 
 const std::string &DDLNode::getType() const {
@@ -119,21 +178,32 @@ const std::string &DDLNode::getType() const {
 
 void DDLNode::setName( const std::string &name ) {
     m_name = name;
+    touch();
 }
 
 const std::string &DDLNode::getName() const {
     return m_name;
 }
 
+void DDLNode::setNameType( NameType type ) {
+    m_nameType = type;
+    touch();
+}
+
+NameType DDLNode::getNameType() const {
+    return m_nameType;
+}
+
 void DDLNode::setProperties( Property *prop ) {
     m_properties = prop;
+    touch();
 }
 
 Property *DDLNode::getProperties() const {
     return m_properties;
 }
 
-bool DDLNode::hasProperty( const std::string &name ) {
+bool DDLNode::hasProperty( const std::string &name ) const {
     const Property *prop( findPropertyByName( name ) );
     return ( ddl_nullptr != prop );
 }
@@ -142,7 +212,7 @@ bool DDLNode::hasProperties() const {
     return( ddl_nullptr != m_properties );
 }
 
-Property *DDLNode::findPropertyByName( const std::string &name ) {
+Property *DDLNode::findPropertyByName( const std::string &name ) const {
     if( name.empty() ) {
         return ddl_nullptr;
     }
@@ -165,29 +235,211 @@ Property *DDLNode::findPropertyByName( const std::string &name ) {
 
 void DDLNode::setValue( Value *val ) {
     m_value = val;
+    touch();
 }
 
 Value *DDLNode::getValue() const {
+    materialize();
     return m_value;
 }
 
 void DDLNode::setDataArrayList( DataArrayList  *dtArrayList ) {
     m_dtArrayList = dtArrayList;
+    touch();
 }
 
 DataArrayList *DDLNode::getDataArrayList() const {
+    materialize();
     return m_dtArrayList;
 }
 
 void DDLNode::setReferences( Reference *refs ) {
     m_references = refs;
+    touch();
 }
 
 Reference *DDLNode::getReferences() const {
+    materialize();
     return m_references;
 }
 
+void DDLNode::touch() {
+    m_dirty = true;
+    markSubtreeDirty();
+}
+
+bool DDLNode::isDirty() const {
+    return m_subtreeDirty;
+}
+
+size_t DDLNode::getTreeIndex() const {
+    if( 0 == m_treeGeneration ) {
+        return InvalidTreeIndex;
+    }
+
+    return m_treeIdx;
+}
+
+size_t DDLNode::getSubtreeSize() const {
+    if( 0 == m_treeGeneration ) {
+        return 0;
+    }
+
+    return m_treeEnd - m_treeIdx;
+}
+
+bool DDLNode::isAncestorOf( const DDLNode *node ) const {
+    if( ddl_nullptr == node || this == node ) {
+        return false;
+    }
+
+    if( 0 != m_treeGeneration && m_treeGeneration == node->m_treeGeneration ) {
+        return ( m_treeIdx < node->m_treeIdx && node->m_treeIdx < m_treeEnd );
+    }
+
+    for( const DDLNode *parent( node->m_parent ); ddl_nullptr != parent; parent = parent->m_parent ) {
+        if( this == parent ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool DDLNode::isDescendantOf( const DDLNode *node ) const {
+    if( ddl_nullptr == node ) {
+        return false;
+    }
+
+    return node->isAncestorOf( this );
+}
+
+void DDLNode::updateTreeIndex() {
+    const size_t generation( nextTreeGeneration() );
+    size_t idx( 0 );
+
+    // iterative pre-order walk, the end index is set when the last child was visited
+    std::vector<std::pair<DDLNode*, size_t> > stack;
+    stack.push_back( std::make_pair( this, 0 ) );
+    m_treeIdx = idx++;
+    m_treeGeneration = generation;
+    while( !stack.empty() ) {
+        DDLNode *current( stack.back().first );
+        const size_t childIdx( stack.back().second );
+        if( childIdx < current->m_children.size() ) {
+            stack.back().second++;
+            DDLNode *child( current->m_children[ childIdx ] );
+            if( ddl_nullptr != child ) {
+                child->m_treeIdx = idx++;
+                child->m_treeGeneration = generation;
+                stack.push_back( std::make_pair( child, 0 ) );
+            }
+        } else {
+            current->m_treeEnd = idx;
+            stack.pop_back();
+        }
+    }
+}
+
+uint64 DDLNode::getTypeMask( const std::string &type ) {
+    // FNV-1a, the bits are taken from different parts of the hash
+    uint64 hash( 14695981039346656037ULL );
+    for( size_t i = 0; i < type.size(); i++ ) {
+        hash ^= static_cast<unsigned char>( type[ i ] );
+        hash *= 1099511628211ULL;
+    }
+
+    const uint64 one( 1 );
+    return ( one << ( hash & 63 ) ) | ( one << ( ( hash >> 32 ) & 63 ) );
+}
+
+uint64 DDLNode::getSubtreeTypeMask() const {
+    return m_typeMask;
+}
+
+bool DDLNode::mayContainType( const std::string &type ) const {
+    const uint64 mask( getTypeMask( type ) );
+    return ( m_typeMask & mask ) == mask;
+}
+
+size_t DDLNode::findNodesByType( const std::string &type, DllNodeList &result ) const {
+    const size_t numNodes( result.size() );
+    collectNodesByType( type, getTypeMask( type ), result, false );
+
+    return result.size() - numNodes;
+}
+
+DDLNode *DDLNode::findFirstNodeByType( const std::string &type ) const {
+    DllNodeList result;
+    collectNodesByType( type, getTypeMask( type ), result, true );
+    if( result.empty() ) {
+        return ddl_nullptr;
+    }
+
+    return result[ 0 ];
+}
+
+void DDLNode::addSubtreeTypeMask( uint64 mask ) {
+    // masks only grow, the walk stops at the first parent which knows all bits already
+    for( DDLNode *node( this ); ddl_nullptr != node; node = node->m_parent ) {
+        if( ( node->m_typeMask | mask ) == node->m_typeMask ) {
+            break;
+        }
+        node->m_typeMask |= mask;
+    }
+}
+
+void DDLNode::collectNodesByType( const std::string &type, uint64 mask, DllNodeList &result, bool firstOnly ) const {
+    const DllNodeList &childs( getChildNodeList() );
+    for( size_t i = 0; i < childs.size(); i++ ) {
+        const DDLNode *child( childs[ i ] );
+        if( ddl_nullptr == child || ( child->m_typeMask & mask ) != mask ) {
+            continue;
+        }
+        if( child->m_type == type ) {
+            result.push_back( const_cast<DDLNode*>( child ) );
+            if( firstOnly ) {
+                return;
+            }
+        }
+        child->collectNodesByType( type, mask, result, firstOnly );
+        if( firstOnly && !result.empty() ) {
+            return;
+        }
+    }
+}
+
+size_t DDLNode::nextTreeGeneration() {
+    return ++s_treeGeneration;
+}
+
+void DDLNode::markSubtreeDirty() {
+    // the walk stops at the first dirty ancestor, the nodes above it are dirty already
+    for( DDLNode *node = this; ddl_nullptr != node && !node->m_subtreeDirty; node = node->m_parent ) {
+        node->m_subtreeDirty = true;
+    }
+}
+
+void DDLNode::invalidateTreeIndex() {
+    if( 0 == m_treeGeneration ) {
+        return;
+    }
+
+    m_treeGeneration = 0;
+    for( size_t i = 0; i < m_children.size(); i++ ) {
+        if( ddl_nullptr != m_children[ i ] ) {
+            m_children[ i ]->invalidateTreeIndex();
+        }
+    }
+}
+
 DDLNode *DDLNode::create( const std::string &type, const std::string &name, DDLNode *parent ) {
+    if( ddl_nullptr != s_threadArena ) {
+        DDLNode *node = new DDLNode( type, name, ArenaIndex, parent );
+        s_threadArena->push_back( node );
+        return node;
+    }
+
     const size_t idx( s_allocatedNodes.size() );
     DDLNode *node = new DDLNode( type, name, idx, parent );
     s_allocatedNodes.push_back( node );
@@ -195,14 +447,64 @@ DDLNode *DDLNode::create( const std::string &type, const std::string &name, DDLN
     return node;
 }
 
+void DDLNode::takeNodes( DllNodeList &nodes ) {
+    nodes.clear();
+    nodes.swap( s_allocatedNodes );
+}
+
+void DDLNode::takeSubtree( DDLNode *node, DllNodeList &nodes ) {
+    nodes.clear();
+    if( ddl_nullptr == node ) {
+        return;
+    }
+
+    node->detachParent();
+    nodes.push_back( node );
+    for( size_t i = 0; i < nodes.size(); i++ ) {
+        DDLNode *current( nodes[ i ] );
+        if( current->m_idx < s_allocatedNodes.size() && s_allocatedNodes[ current->m_idx ] == current ) {
+            s_allocatedNodes[ current->m_idx ] = ddl_nullptr;
+        }
+        current->m_idx = ArenaIndex;
+        nodes.insert( nodes.end(), current->m_children.begin(), current->m_children.end() );
+    }
+    while( !s_allocatedNodes.empty() && ddl_nullptr == s_allocatedNodes.back() ) {
+        s_allocatedNodes.pop_back();
+    }
+}
+
+void DDLNode::deleteNodes( DllNodeList &nodes ) {
+    // the nodes are no longer part of the registry, which may be used by other threads meanwhile
+    for( size_t i = 0; i < nodes.size(); i++ ) {
+        if( ddl_nullptr != nodes[ i ] ) {
+            nodes[ i ]->m_idx = ArenaIndex;
+            delete nodes[ i ];
+        }
+    }
+    nodes.clear();
+}
+
+void DDLNode::setThreadArena( DllNodeList *arena ) {
+    s_threadArena = arena;
+}
+
+void DDLNode::spliceArena( DllNodeList &arena ) {
+    s_allocatedNodes.reserve( s_allocatedNodes.size() + arena.size() );
+    for( size_t i = 0; i < arena.size(); i++ ) {
+        arena[ i ]->m_idx = s_allocatedNodes.size();
+        s_allocatedNodes.push_back( arena[ i ] );
+    }
+    arena.clear();
+}
+
 void DDLNode::releaseNodes() {
-    if( s_allocatedNodes.size() > 0 ) {
-        for( DllNodeList::iterator it = s_allocatedNodes.begin(); it != s_allocatedNodes.end(); it++ ) {
-            if( *it ) {
-                delete *it;
-            }
+    // the destructors must not see the list while it is walked
+    DllNodeList nodes;
+    nodes.swap( s_allocatedNodes );
+    for( DllNodeList::iterator it = nodes.begin(); it != nodes.end(); it++ ) {
+        if( *it ) {
+            delete *it;
         }
-        s_allocatedNodes.clear();
     }
 }
 
@@ -0,0 +1,226 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <openddlparser/OpenDDLAsyncLogger.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+BEGIN_ODDLPARSER_NS
+
+const size_t AsyncLogger::DefaultCapacity = 1024;
+
+namespace {
+
+// a slot of the ring, the sequence tells whether the slot is free or filled for a position
+struct Slot {
+    std::atomic<size_t> m_sequence;
+    LogSeverity m_severity;
+    std::string m_message;
+};
+
+// a bounded ring with many producers and the drain thread as single consumer
+struct LoggerState {
+    Slot *m_slots;
+    size_t m_mask;
+    std::atomic<size_t> m_tail;
+    std::atomic<size_t> m_head;
+    std::atomic<size_t> m_dropped;
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_stop;
+    OpenDDLParser::logCallback m_target;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    std::condition_variable m_drained;
+
+    LoggerState()
+    : m_slots( ddl_nullptr )
+    , m_mask( 0 )
+    , m_tail( 0 )
+    , m_head( 0 )
+    , m_dropped( 0 )
+    , m_running( false )
+    , m_stop( false )
+    , m_target( ddl_nullptr )
+    , m_thread()
+    , m_mutex()
+    , m_wakeup()
+    , m_drained() {
+        // empty
+    }
+
+    ~LoggerState() {
+        // a logger which was not stopped is stopped at the exit, a joinable thread would terminate
+        if( m_thread.joinable() ) {
+            m_running.store( false );
+            m_stop.store( true );
+            m_wakeup.notify_one();
+            m_thread.join();
+        }
+        delete [] m_slots;
+        m_slots = ddl_nullptr;
+    }
+};
+
+static LoggerState s_state;
+
+// the drain thread sleeps at most this time, a missed wakeup only delays the output
+static const std::chrono::milliseconds MaxSleep( 10 );
+
+static bool push( LogSeverity severity, const std::string &msg ) {
+    size_t pos( s_state.m_tail.load( std::memory_order_relaxed ) );
+    for( ;; ) {
+        Slot &slot( s_state.m_slots[ pos & s_state.m_mask ] );
+        const size_t sequence( slot.m_sequence.load( std::memory_order_acquire ) );
+        if( sequence == pos ) {
+            if( s_state.m_tail.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) ) {
+                slot.m_severity = severity;
+                slot.m_message = msg;
+                slot.m_sequence.store( pos + 1, std::memory_order_release );
+                return true;
+            }
+        } else if( sequence < pos ) {
+            // the slot still holds the message of the former round, the ring is full
+            return false;
+        } else {
+            pos = s_state.m_tail.load( std::memory_order_relaxed );
+        }
+    }
+}
+
+static bool pop() {
+    const size_t pos( s_state.m_head.load( std::memory_order_relaxed ) );
+    Slot &slot( s_state.m_slots[ pos & s_state.m_mask ] );
+    if( slot.m_sequence.load( std::memory_order_acquire ) != pos + 1 ) {
+        return false;
+    }
+
+    s_state.m_target( slot.m_severity, slot.m_message );
+    slot.m_message.clear();
+    slot.m_sequence.store( pos + s_state.m_mask + 1, std::memory_order_release );
+    s_state.m_head.store( pos + 1, std::memory_order_release );
+
+    return true;
+}
+
+static void drainMain() {
+    for( ;; ) {
+        while( pop() ) {
+            // empty
+        }
+        const bool stop( s_state.m_stop.load( std::memory_order_acquire ) );
+        if( stop ) {
+            // messages logged before the stop request are still passed to the target
+            while( pop() ) {
+                // empty
+            }
+        }
+
+        // the lock orders the new head before the check of a waiting flush
+        {
+            std::lock_guard<std::mutex> lock( s_state.m_mutex );
+        }
+        s_state.m_drained.notify_all();
+        if( stop ) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock( s_state.m_mutex );
+        s_state.m_wakeup.wait_for( lock, MaxSleep );
+    }
+}
+
+} // Namespace
+
+bool AsyncLogger::start( OpenDDLParser::logCallback target, size_t capacity ) {
+    if( ddl_nullptr == target || s_state.m_running.load() ) {
+        return false;
+    }
+
+    size_t size( 2 );
+    while( size < capacity ) {
+        size *= 2;
+    }
+    s_state.m_slots = new Slot[ size ];
+    for( size_t i = 0; i < size; i++ ) {
+        s_state.m_slots[ i ].m_sequence.store( i );
+    }
+    s_state.m_mask = size - 1;
+    s_state.m_tail.store( 0 );
+    s_state.m_head.store( 0 );
+    s_state.m_dropped.store( 0 );
+    s_state.m_target = target;
+    s_state.m_stop.store( false );
+    s_state.m_thread = std::thread( &drainMain );
+    s_state.m_running.store( true );
+
+    return true;
+}
+
+void AsyncLogger::stop() {
+    if( !s_state.m_running.load() ) {
+        return;
+    }
+
+    s_state.m_running.store( false );
+    s_state.m_stop.store( true );
+    s_state.m_wakeup.notify_one();
+    s_state.m_thread.join();
+    delete [] s_state.m_slots;
+    s_state.m_slots = ddl_nullptr;
+}
+
+bool AsyncLogger::isRunning() {
+    return s_state.m_running.load();
+}
+
+void AsyncLogger::log( LogSeverity severity, const std::string &msg ) {
+    if( !s_state.m_running.load( std::memory_order_acquire ) || !push( severity, msg ) ) {
+        s_state.m_dropped.fetch_add( 1, std::memory_order_relaxed );
+        return;
+    }
+
+    s_state.m_wakeup.notify_one();
+}
+
+void AsyncLogger::flush() {
+    if( !s_state.m_running.load() ) {
+        return;
+    }
+
+    const size_t tail( s_state.m_tail.load() );
+    s_state.m_wakeup.notify_one();
+    std::unique_lock<std::mutex> lock( s_state.m_mutex );
+    while( s_state.m_head.load( std::memory_order_acquire ) < tail ) {
+        s_state.m_drained.wait( lock );
+    }
+}
+
+size_t AsyncLogger::getNumDropped() {
+    return s_state.m_dropped.load( std::memory_order_relaxed );
+}
+
+END_ODDLPARSER_NS
@@ -0,0 +1,272 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <openddlparser/OpenDDLBatchLoader.h>
+#include <openddlparser/OpenDDLParser.h>
+#include <openddlparser/OpenDDLThreadPool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+
+#include <sys/stat.h>
+
+BEGIN_ODDLPARSER_NS
+
+// the error messages of the file which is loaded by the current thread
+static thread_local std::string *s_batchErrors = ddl_nullptr;
+
+static void logBatchMessage( LogSeverity severity, const std::string &msg ) {
+    if( ddl_error_msg != severity || ddl_nullptr == s_batchErrors ) {
+        return;
+    }
+
+    if( !s_batchErrors->empty() ) {
+        s_batchErrors->append( "\n" );
+    }
+    s_batchErrors->append( msg );
+}
+
+static size_t getFileSize( const std::string &path ) {
+    struct stat info;
+    if( 0 != ::stat( path.c_str(), &info ) ) {
+        return 0;
+    }
+
+    return static_cast<size_t>( info.st_size );
+}
+
+static bool readFile( const std::string &path, std::vector<char> &buffer ) {
+    FILE *file( ::fopen( path.c_str(), "rb" ) );
+    if( ddl_nullptr == file ) {
+        return false;
+    }
+
+    bool success( 0 == ::fseek( file, 0, SEEK_END ) );
+    const long size( success ? ::ftell( file ) : -1 );
+    success = size >= 0 && 0 == ::fseek( file, 0, SEEK_SET );
+    if( success ) {
+        buffer.resize( static_cast<size_t>( size ) );
+        success = buffer.empty() || ::fread( &buffer[ 0 ], 1, buffer.size(), file ) == buffer.size();
+    }
+    ::fclose( file );
+
+    return success;
+}
+
+static void releaseArena( DDLNode::DllNodeList &arena ) {
+    for( size_t i = 0; i < arena.size(); i++ ) {
+        delete arena[ i ];
+    }
+    arena.clear();
+}
+
+static double getSeconds( std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end ) {
+    return std::chrono::duration<double>( end - begin ).count();
+}
+
+namespace {
+
+// the files of one thread, the owner takes the biggest ones from the front, other threads steal
+// the smallest ones from the back
+struct WorkQueue {
+    std::mutex m_mutex;
+    std::deque<size_t> m_items;
+
+    bool pop( size_t &idx ) {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        if( m_items.empty() ) {
+            return false;
+        }
+        idx = m_items.front();
+        m_items.pop_front();
+
+        return true;
+    }
+
+    bool steal( size_t &idx ) {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        if( m_items.empty() ) {
+            return false;
+        }
+        idx = m_items.back();
+        m_items.pop_back();
+
+        return true;
+    }
+};
+
+} // Namespace
+
+// no work is added after the start, so a thread is done when all queues are empty
+static bool getNextFile( std::vector<WorkQueue> &queues, size_t owner, size_t &idx ) {
+    if( queues[ owner ].pop( idx ) ) {
+        return true;
+    }
+    for( size_t i = 1; i < queues.size(); i++ ) {
+        if( queues[ ( owner + i ) % queues.size() ].steal( idx ) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+BatchResult::BatchResult()
+: m_path()
+, m_context( ddl_nullptr )
+, m_error()
+, m_size( 0 )
+, m_readTime( 0.0 )
+, m_parseTime( 0.0 ) {
+    // empty
+}
+
+OpenDDLBatchLoader::OpenDDLBatchLoader( size_t numThreads )
+: m_numThreads( numThreads )
+, m_pool( ddl_nullptr )
+, m_useIndex( false )
+, m_results()
+, m_arenas() {
+    // empty
+}
+
+OpenDDLBatchLoader::~OpenDDLBatchLoader() {
+    clear();
+    delete m_pool;
+    m_pool = ddl_nullptr;
+}
+
+void OpenDDLBatchLoader::setUseStructuralIndex( bool enabled ) {
+    m_useIndex = enabled;
+}
+
+bool OpenDDLBatchLoader::isStructuralIndexEnabled() const {
+    return m_useIndex;
+}
+
+bool OpenDDLBatchLoader::load( const std::vector<std::string> &paths ) {
+    clear();
+    if( paths.empty() ) {
+        return true;
+    }
+
+    m_results.resize( paths.size() );
+    m_arenas.resize( paths.size() );
+    std::vector<size_t> order( paths.size() );
+    for( size_t i = 0; i < paths.size(); i++ ) {
+        m_results[ i ].m_path = paths[ i ];
+        m_results[ i ].m_size = getFileSize( paths[ i ] );
+        order[ i ] = i;
+    }
+    std::stable_sort( order.begin(), order.end(), [this]( size_t lhs, size_t rhs ) {
+        return m_results[ lhs ].m_size > m_results[ rhs ].m_size;
+    } );
+
+    // the calling thread works on its own queue as well
+    if( ddl_nullptr == m_pool ) {
+        m_pool = new ThreadPool( m_numThreads );
+    }
+    std::vector<WorkQueue> queues( std::min( paths.size(), m_pool->getNumThreads() + 1 ) );
+    for( size_t i = 0; i < order.size(); i++ ) {
+        queues[ i % queues.size() ].m_items.push_back( order[ i ] );
+    }
+    m_pool->parallelFor( queues.size(), [&]( size_t owner ) {
+        size_t idx( 0 );
+        while( getNextFile( queues, owner, idx ) ) {
+            loadFile( idx );
+        }
+    } );
+
+    bool success( true );
+    for( size_t i = 0; i < m_results.size(); i++ ) {
+        success = ( ddl_nullptr != m_results[ i ].m_context ) && success;
+    }
+
+    return success;
+}
+
+size_t OpenDDLBatchLoader::getNumResults() const {
+    return m_results.size();
+}
+
+const BatchResult &OpenDDLBatchLoader::getResult( size_t idx ) const {
+    return m_results[ idx ];
+}
+
+void OpenDDLBatchLoader::clear() {
+    for( size_t i = 0; i < m_results.size(); i++ ) {
+        Context *ctx( m_results[ i ].m_context );
+        if( ddl_nullptr != ctx ) {
+            // the root is released with the other nodes of the file
+            ctx->m_root = ddl_nullptr;
+            delete ctx;
+        }
+        releaseArena( m_arenas[ i ] );
+    }
+    m_results.clear();
+    m_arenas.clear();
+}
+
+void OpenDDLBatchLoader::loadFile( size_t idx ) {
+    BatchResult &result( m_results[ idx ] );
+    const std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+    OpenDDLParser parser;
+    parser.m_ownsNodes = false;
+    parser.setLogCallback( &logBatchMessage );
+    parser.setLogSeverity( ddl_error_msg );
+    parser.setUseStructuralIndex( m_useIndex );
+    if( !readFile( result.m_path, parser.m_buffer ) ) {
+        result.m_error = "Cannot read file " + result.m_path;
+        return;
+    }
+    result.m_size = parser.m_buffer.size();
+    const std::chrono::steady_clock::time_point read( std::chrono::steady_clock::now() );
+
+    // the nodes of the file are collected in its arena instead of the node registry
+    std::string errors;
+    s_batchErrors = &errors;
+    DDLNode::setThreadArena( &m_arenas[ idx ] );
+    const bool success( parser.parse() );
+    DDLNode::setThreadArena( ddl_nullptr );
+    s_batchErrors = ddl_nullptr;
+    result.m_readTime = getSeconds( start, read );
+    result.m_parseTime = getSeconds( read, std::chrono::steady_clock::now() );
+
+    Context *ctx( parser.m_context );
+    parser.m_context = ddl_nullptr;
+    if( success ) {
+        result.m_context = ctx;
+        return;
+    }
+
+    if( ddl_nullptr != ctx ) {
+        ctx->m_root = ddl_nullptr;
+        delete ctx;
+    }
+    releaseArena( m_arenas[ idx ] );
+    result.m_error = errors.empty() ? "Cannot parse file " + result.m_path : errors;
+}
+
+END_ODDLPARSER_NS
@@ -0,0 +1,381 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <openddlparser/OpenDDLBinaryExport.h>
+#include <openddlparser/OpenDDLExport.h>
+#include <openddlparser/DDLNode.h>
+
+#include <stddef.h>
+#include <string.h>
+
+BEGIN_ODDLPARSER_NS
+
+static const size_t MaxBinarySize = 0xffffffff;
+
+static bool isLittleEndian() {
+    const uint16 value( 1 );
+    unsigned char first( 0 );
+    ::memcpy( &first, &value, 1 );
+
+    return 1 == first;
+}
+
+// returns the size of one value in the payload, 0 for types which can not be stored
+static size_t getPayloadSize( Value::ValueType type ) {
+    switch( type ) {
+        case Value::ddl_bool:
+        case Value::ddl_int8:
+        case Value::ddl_unsigned_int8:
+            return 1;
+        case Value::ddl_int16:
+        case Value::ddl_unsigned_int16:
+        case Value::ddl_half:
+            return 2;
+        case Value::ddl_int32:
+        case Value::ddl_unsigned_int32:
+        case Value::ddl_float:
+        case Value::ddl_string:
+        case Value::ddl_ref:
+            return 4;
+        case Value::ddl_int64:
+        case Value::ddl_unsigned_int64:
+        case Value::ddl_double:
+            return 8;
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+static size_t alignSize( size_t size ) {
+    return ( size + BinaryAlignment - 1 ) & ~( BinaryAlignment - 1 );
+}
+
+OpenDDLBinaryExport::OpenDDLBinaryExport()
+: m_buffer( ddl_nullptr )
+, m_stringIds()
+, m_strings() {
+    // empty
+}
+
+OpenDDLBinaryExport::~OpenDDLBinaryExport() {
+    // empty
+}
+
+bool OpenDDLBinaryExport::exportContext( Context *ctx, const std::string &filename ) {
+    if( filename.empty() ) {
+        return false;
+    }
+
+    std::vector<char> buffer;
+    if( !exportContext( ctx, buffer ) ) {
+        return false;
+    }
+
+    IOStreamBase stream;
+    if( !stream.open( filename ) ) {
+        return false;
+    }
+    const size_t written( stream.write( &buffer[ 0 ], buffer.size() ) );
+
+    return stream.close() && written == buffer.size();
+}
+
+bool OpenDDLBinaryExport::exportContext( Context *ctx, std::vector<char> &buffer ) {
+    if( ddl_nullptr == ctx ) {
+        return false;
+    }
+
+    return exportNode( ctx->m_root, buffer );
+}
+
+bool OpenDDLBinaryExport::exportNode( DDLNode *node, std::vector<char> &buffer ) {
+    buffer.clear();
+    if( ddl_nullptr == node ) {
+        return false;
+    }
+
+    m_buffer = &buffer;
+    m_stringIds.clear();
+    m_strings.clear();
+
+    const size_t header( append( sizeof( BinaryHeader ) ) );
+    ::memcpy( &buffer[ header ], BinaryMagic, sizeof( BinaryMagic ) );
+    put32( header + offsetof( BinaryHeader, m_version ), BinaryVersion );
+
+    align();
+    put32( header + offsetof( BinaryHeader, m_rootOffset ), static_cast<uint32>( buffer.size() ) );
+    bool success( writeStructure( node ) );
+    if( success ) {
+        align();
+        put32( header + offsetof( BinaryHeader, m_stringTableOffset ), static_cast<uint32>( buffer.size() ) );
+        put32( header + offsetof( BinaryHeader, m_numStrings ), static_cast<uint32>( m_strings.size() ) );
+        writeStringTable();
+        align();
+        put64( header + offsetof( BinaryHeader, m_fileSize ), buffer.size() );
+        success = buffer.size() <= MaxBinarySize;
+    }
+
+    m_buffer = ddl_nullptr;
+    m_stringIds.clear();
+    m_strings.clear();
+    if( !success ) {
+        buffer.clear();
+    }
+
+    return success;
+}
+
+uint32 OpenDDLBinaryExport::internString( const std::string &str ) {
+    std::map<std::string, uint32>::const_iterator it( m_stringIds.find( str ) );
+    if( m_stringIds.end() != it ) {
+        return it->second;
+    }
+
+    const uint32 id( static_cast<uint32>( m_strings.size() ) );
+    m_strings.push_back( str );
+    m_stringIds[ str ] = id;
+
+    return id;
+}
+
+uint32 OpenDDLBinaryExport::internName( const Name *name ) {
+    if( ddl_nullptr == name || ddl_nullptr == name->m_id ) {
+        return BinaryNoString;
+    }
+
+    std::string str( GlobalName == name->m_type ? "$" : "%" );
+    str.append( name->m_id->m_buffer, name->m_id->m_len );
+
+    return internString( str );
+}
+
+bool OpenDDLBinaryExport::writeStructure( DDLNode *node ) {
+    std::vector<DDLNode*> children;
+    const DDLNode::DllNodeList &childs( node->getChildNodeList() );
+    for( size_t i = 0; i < childs.size(); i++ ) {
+        if( ddl_nullptr != childs[ i ] ) {
+            children.push_back( childs[ i ] );
+        }
+    }
+    size_t numProperties( 0 );
+    for( Property *prop( node->getProperties() ); ddl_nullptr != prop; prop = prop->m_next ) {
+        numProperties++;
+    }
+
+    align();
+    const size_t start( append( sizeof( BinaryStructure ) ) );
+    put32( start + offsetof( BinaryStructure, m_type ), internString( node->getType() ) );
+    const std::string &name( node->getName() );
+    put32( start + offsetof( BinaryStructure, m_name ), name.empty() ? BinaryNoString : internString( name ) );
+    put32( start + offsetof( BinaryStructure, m_nameType ), static_cast<uint32>( node->getNameType() ) );
+    put32( start + offsetof( BinaryStructure, m_numProperties ), static_cast<uint32>( numProperties ) );
+    put32( start + offsetof( BinaryStructure, m_numChildren ), static_cast<uint32>( children.size() ) );
+    const size_t childOffsets( append( children.size() * sizeof( uint32 ) ) );
+    align();
+
+    bool success( true );
+    size_t pos( append( numProperties * sizeof( BinaryProperty ) ) );
+    for( Property *prop( node->getProperties() ); ddl_nullptr != prop; prop = prop->m_next ) {
+        success = writeProperty( prop, pos ) && success;
+        pos += sizeof( BinaryProperty );
+    }
+
+    uint32 numData( 0 );
+    std::vector<Value*> values;
+    for( DataArrayList *al( node->getDataArrayList() ); ddl_nullptr != al; al = al->m_next ) {
+        for( Value *v( al->m_dataList ); ddl_nullptr != v; v = v->m_next ) {
+            values.push_back( v );
+        }
+    }
+    if( !values.empty() ) {
+        DataArrayList *al( node->getDataArrayList() );
+        success = writeData( values[ 0 ]->m_type, static_cast<uint32>( al->m_numItems ), values ) && success;
+        numData++;
+    }
+    values.clear();
+    for( Value *v( node->getValue() ); ddl_nullptr != v; v = v->m_next ) {
+        values.push_back( v );
+    }
+    if( !values.empty() ) {
+        success = writeData( values[ 0 ]->m_type, 0, values ) && success;
+        numData++;
+    }
+    if( ddl_nullptr != node->getReferences() ) {
+        success = writeReferences( node->getReferences() ) && success;
+        numData++;
+    }
+    put32( start + offsetof( BinaryStructure, m_numData ), numData );
+
+    for( size_t i = 0; success && i < children.size(); i++ ) {
+        align();
+        put32( childOffsets + i * sizeof( uint32 ), static_cast<uint32>( m_buffer->size() - start ) );
+        success = writeStructure( children[ i ] );
+    }
+
+    align();
+    const size_t size( m_buffer->size() - start );
+    put32( start + offsetof( BinaryStructure, m_size ), static_cast<uint32>( size ) );
+
+    return success && m_buffer->size() <= MaxBinarySize;
+}
+
+bool OpenDDLBinaryExport::writeProperty( Property *prop, size_t pos ) {
+    if( ddl_nullptr == prop->m_key ) {
+        return false;
+    }
+
+    put32( pos + offsetof( BinaryProperty, m_key ), internString( std::string( prop->m_key->m_buffer, prop->m_key->m_len ) ) );
+    if( ddl_nullptr != prop->m_ref ) {
+        put32( pos + offsetof( BinaryProperty, m_type ), static_cast<uint32>( Value::ddl_ref ) );
+        const Name *name( prop->m_ref->m_numRefs > 0 ? prop->m_ref->m_referencedName[ 0 ] : ddl_nullptr );
+        put64( pos + offsetof( BinaryProperty, m_value ), internName( name ) );
+        return true;
+    }
+
+    Value *value( prop->m_value );
+    if( ddl_nullptr == value ) {
+        put32( pos + offsetof( BinaryProperty, m_type ), static_cast<uint32>( Value::ddl_none ) );
+        return true;
+    }
+
+    put32( pos + offsetof( BinaryProperty, m_type ), static_cast<uint32>( value->m_type ) );
+    const size_t payloadSize( getPayloadSize( value->m_type ) );
+    if( Value::ddl_string == value->m_type ) {
+        put64( pos + offsetof( BinaryProperty, m_value ), internString( value->getString() ) );
+    } else if( Value::ddl_ref == value->m_type ) {
+        Reference *ref( value->getRef() );
+        const Name *name( ddl_nullptr != ref && ref->m_numRefs > 0 ? ref->m_referencedName[ 0 ] : ddl_nullptr );
+        put64( pos + offsetof( BinaryProperty, m_value ), internName( name ) );
+    } else if( Value::ddl_bool == value->m_type ) {
+        put64( pos + offsetof( BinaryProperty, m_value ), value->getBool() ? 1 : 0 );
+    } else if( 0 != payloadSize && value->m_size == payloadSize ) {
+        putRaw( pos + offsetof( BinaryProperty, m_value ), value->m_data, payloadSize );
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+bool OpenDDLBinaryExport::writeData( Value::ValueType type, uint32 arraySize, const std::vector<Value*> &values ) {
+    const size_t payloadSize( getPayloadSize( type ) );
+    if( 0 == payloadSize ) {
+        return false;
+    }
+
+    align();
+    const size_t start( append( sizeof( BinaryData ) ) );
+    const size_t payloadStart( append( values.size() * payloadSize ) );
+    align();
+    put32( start + offsetof( BinaryData, m_type ), static_cast<uint32>( type ) );
+    put32( start + offsetof( BinaryData, m_arraySize ), arraySize );
+    put32( start + offsetof( BinaryData, m_numValues ), static_cast<uint32>( values.size() ) );
+    put32( start + offsetof( BinaryData, m_payloadSize ), static_cast<uint32>( m_buffer->size() - payloadStart ) );
+
+    size_t pos( payloadStart );
+    for( size_t i = 0; i < values.size(); i++, pos += payloadSize ) {
+        Value *v( values[ i ] );
+        if( type != v->m_type ) {
+            return false;
+        }
+
+        if( Value::ddl_string == type ) {
+            put32( pos, internString( v->getString() ) );
+        } else if( Value::ddl_ref == type ) {
+            Reference *ref( v->getRef() );
+            put32( pos, internName( ddl_nullptr != ref && ref->m_numRefs > 0 ? ref->m_referencedName[ 0 ] : ddl_nullptr ) );
+        } else if( Value::ddl_bool == type ) {
+            ( *m_buffer )[ pos ] = v->getBool() ? 1 : 0;
+        } else if( v->m_size == payloadSize ) {
+            putRaw( pos, v->m_data, payloadSize );
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool OpenDDLBinaryExport::writeReferences( Reference *ref ) {
+    align();
+    const size_t start( append( sizeof( BinaryData ) ) );
+    const size_t payloadStart( append( ref->m_numRefs * sizeof( uint32 ) ) );
+    align();
+    put32( start + offsetof( BinaryData, m_type ), static_cast<uint32>( Value::ddl_ref ) );
+    put32( start + offsetof( BinaryData, m_numValues ), static_cast<uint32>( ref->m_numRefs ) );
+    put32( start + offsetof( BinaryData, m_payloadSize ), static_cast<uint32>( m_buffer->size() - payloadStart ) );
+    for( size_t i = 0; i < ref->m_numRefs; i++ ) {
+        put32( payloadStart + i * sizeof( uint32 ), internName( ref->m_referencedName[ i ] ) );
+    }
+
+    return true;
+}
+
+void OpenDDLBinaryExport::writeStringTable() {
+    const size_t table( m_buffer->size() );
+    append( m_strings.size() * sizeof( BinaryString ) );
+    for( size_t i = 0; i < m_strings.size(); i++ ) {
+        const std::string &str( m_strings[ i ] );
+        const size_t pos( append( str.size() + 1 ) );
+        if( !str.empty() ) {
+            ::memcpy( &( *m_buffer )[ pos ], str.c_str(), str.size() );
+        }
+        const size_t entry( table + i * sizeof( BinaryString ) );
+        put32( entry + offsetof( BinaryString, m_offset ), static_cast<uint32>( pos - table ) );
+        put32( entry + offsetof( BinaryString, m_length ), static_cast<uint32>( str.size() ) );
+    }
+}
+
+size_t OpenDDLBinaryExport::append( size_t len ) {
+    const size_t pos( m_buffer->size() );
+    m_buffer->resize( pos + len, 0 );
+
+    return pos;
+}
+
+void OpenDDLBinaryExport::align() {
+    m_buffer->resize( alignSize( m_buffer->size() ), 0 );
+}
+
+void OpenDDLBinaryExport::put32( size_t pos, uint32 value ) {
+    putRaw( pos, reinterpret_cast<const unsigned char*>( &value ), sizeof( uint32 ) );
+}
+
+void OpenDDLBinaryExport::put64( size_t pos, uint64 value ) {
+    putRaw( pos, reinterpret_cast<const unsigned char*>( &value ), sizeof( uint64 ) );
+}
+
+void OpenDDLBinaryExport::putRaw( size_t pos, const unsigned char *data, size_t len ) {
+    char *dest( &( *m_buffer )[ pos ] );
+    if( isLittleEndian() ) {
+        ::memcpy( dest, data, len );
+        return;
+    }
+
+    for( size_t i = 0; i < len; i++ ) {
+        dest[ i ] = static_cast<char>( data[ len - 1 - i ] );
+    }
+}
+
+END_ODDLPARSER_NS
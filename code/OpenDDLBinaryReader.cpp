@@ -0,0 +1,715 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <openddlparser/OpenDDLBinaryReader.h>
+#include <openddlparser/DDLNode.h>
+#include <openddlparser/OpenDDLParserUtils.h>
+
+#include <algorithm>
+
+#include <string.h>
+
+#ifdef _WIN32
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif // _WIN32
+
+BEGIN_ODDLPARSER_NS
+
+static const char EmptyString[] = "";
+
+static size_t alignSize( size_t size ) {
+    return ( size + BinaryAlignment - 1 ) & ~( BinaryAlignment - 1 );
+}
+
+static size_t getBinaryValueSize( uint32 type ) {
+    switch( static_cast<Value::ValueType>( type ) ) {
+        case Value::ddl_bool:
+        case Value::ddl_int8:
+        case Value::ddl_unsigned_int8:
+            return 1;
+        case Value::ddl_int16:
+        case Value::ddl_unsigned_int16:
+        case Value::ddl_half:
+            return 2;
+        case Value::ddl_int32:
+        case Value::ddl_unsigned_int32:
+        case Value::ddl_float:
+        case Value::ddl_string:
+        case Value::ddl_ref:
+            return 4;
+        case Value::ddl_int64:
+        case Value::ddl_unsigned_int64:
+        case Value::ddl_double:
+            return 8;
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+template<class T>
+static T readBits( uint64 bits ) {
+    T data;
+    ::memcpy( &data, &bits, sizeof( T ) );
+    return data;
+}
+
+BinaryPropertyView::BinaryPropertyView()
+: m_reader( ddl_nullptr )
+, m_prop( ddl_nullptr ) {
+    // empty
+}
+
+BinaryPropertyView::BinaryPropertyView( const OpenDDLBinaryReader *reader, const BinaryProperty *prop )
+: m_reader( reader )
+, m_prop( prop ) {
+    if( ddl_nullptr == m_reader || !m_reader->isInside( m_prop, sizeof( BinaryProperty ) ) ) {
+        m_prop = ddl_nullptr;
+    }
+}
+
+bool BinaryPropertyView::isValid() const {
+    return ddl_nullptr != m_prop;
+}
+
+const char *BinaryPropertyView::getKey() const {
+    return isValid() ? m_reader->getString( m_prop->m_key ) : EmptyString;
+}
+
+Value::ValueType BinaryPropertyView::getType() const {
+    return isValid() ? static_cast<Value::ValueType>( m_prop->m_type ) : Value::ddl_none;
+}
+
+uint64 BinaryPropertyView::getRawValue() const {
+    return isValid() ? m_prop->m_value : 0;
+}
+
+bool BinaryPropertyView::getBool() const {
+    return 0 != getRawValue();
+}
+
+int64 BinaryPropertyView::getInt() const {
+    const uint64 bits( getRawValue() );
+    switch( getType() ) {
+        case Value::ddl_bool:
+            return 0 != bits ? 1 : 0;
+        case Value::ddl_int8:
+            return readBits<int8>( bits );
+        case Value::ddl_int16:
+            return readBits<int16>( bits );
+        case Value::ddl_int32:
+            return readBits<int32>( bits );
+        case Value::ddl_int64:
+            return readBits<int64>( bits );
+        case Value::ddl_unsigned_int8:
+            return readBits<uint8>( bits );
+        case Value::ddl_unsigned_int16:
+            return readBits<uint16>( bits );
+        case Value::ddl_unsigned_int32:
+            return readBits<uint32>( bits );
+        case Value::ddl_unsigned_int64:
+            return static_cast<int64>( bits );
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+double BinaryPropertyView::getDouble() const {
+    switch( getType() ) {
+        case Value::ddl_half:
+            return halfToFloat( readBits<uint16>( getRawValue() ) );
+        case Value::ddl_float:
+            return readBits<float>( getRawValue() );
+        case Value::ddl_double:
+            return readBits<double>( getRawValue() );
+        case Value::ddl_unsigned_int64:
+            return static_cast<double>( getRawValue() );
+        default:
+            break;
+    }
+
+    return static_cast<double>( getInt() );
+}
+
+const char *BinaryPropertyView::getString() const {
+    const Value::ValueType type( getType() );
+    if( Value::ddl_string != type && Value::ddl_ref != type ) {
+        return EmptyString;
+    }
+
+    return m_reader->getString( static_cast<uint32>( m_prop->m_value ) );
+}
+
+BinaryDataView::BinaryDataView()
+: m_reader( ddl_nullptr )
+, m_data( ddl_nullptr ) {
+    // empty
+}
+
+BinaryDataView::BinaryDataView( const OpenDDLBinaryReader *reader, const BinaryData *data )
+: m_reader( reader )
+, m_data( data ) {
+    if( ddl_nullptr == m_reader || !m_reader->isInside( m_data, sizeof( BinaryData ) ) ) {
+        m_data = ddl_nullptr;
+        return;
+    }
+
+    const size_t valueSize( getBinaryValueSize( m_data->m_type ) );
+    const size_t payloadSize( static_cast<size_t>( m_data->m_numValues ) * valueSize );
+    if( 0 == valueSize || payloadSize > m_data->m_payloadSize || !m_reader->isInside( m_data + 1, m_data->m_payloadSize ) ) {
+        m_data = ddl_nullptr;
+    }
+}
+
+bool BinaryDataView::isValid() const {
+    return ddl_nullptr != m_data;
+}
+
+Value::ValueType BinaryDataView::getType() const {
+    return isValid() ? static_cast<Value::ValueType>( m_data->m_type ) : Value::ddl_none;
+}
+
+size_t BinaryDataView::getArraySize() const {
+    return isValid() ? m_data->m_arraySize : 0;
+}
+
+size_t BinaryDataView::getNumValues() const {
+    return isValid() ? m_data->m_numValues : 0;
+}
+
+const void *BinaryDataView::getPayload() const {
+    return isValid() ? static_cast<const void*>( m_data + 1 ) : ddl_nullptr;
+}
+
+const char *BinaryDataView::getString( size_t index ) const {
+    const Value::ValueType type( getType() );
+    if( ( Value::ddl_string != type && Value::ddl_ref != type ) || index >= m_data->m_numValues ) {
+        return EmptyString;
+    }
+
+    return m_reader->getString( getValues<uint32>()[ index ] );
+}
+
+size_t BinaryDataView::getValueSize() const {
+    return isValid() ? getBinaryValueSize( m_data->m_type ) : 0;
+}
+
+BinaryNodeView::BinaryNodeView()
+: m_reader( ddl_nullptr )
+, m_node( ddl_nullptr ) {
+    // empty
+}
+
+BinaryNodeView::BinaryNodeView( const OpenDDLBinaryReader *reader, const BinaryStructure *node )
+: m_reader( reader )
+, m_node( node ) {
+    if( ddl_nullptr == m_reader || !m_reader->isInside( m_node, sizeof( BinaryStructure ) ) ) {
+        m_node = ddl_nullptr;
+        return;
+    }
+
+    const size_t header( sizeof( BinaryStructure ) + alignSize( m_node->m_numChildren * sizeof( uint32 ) ) );
+    if( m_node->m_size < header || !m_reader->isInside( m_node, m_node->m_size ) ) {
+        m_node = ddl_nullptr;
+    }
+}
+
+bool BinaryNodeView::isValid() const {
+    return ddl_nullptr != m_node;
+}
+
+const char *BinaryNodeView::getType() const {
+    return isValid() ? m_reader->getString( m_node->m_type ) : EmptyString;
+}
+
+const char *BinaryNodeView::getName() const {
+    return isValid() ? m_reader->getString( m_node->m_name ) : EmptyString;
+}
+
+NameType BinaryNodeView::getNameType() const {
+    return isValid() && LocalName == m_node->m_nameType ? LocalName : GlobalName;
+}
+
+size_t BinaryNodeView::getNumChildren() const {
+    return isValid() ? m_node->m_numChildren : 0;
+}
+
+BinaryNodeView BinaryNodeView::getChild( size_t index ) const {
+    if( index >= getNumChildren() ) {
+        return BinaryNodeView();
+    }
+
+    // a child lies behind the properties and data of its parent and is nested inside of it, so
+    // a broken offset cannot point back into the parent record
+    const size_t offset( reinterpret_cast<const uint32*>( m_node + 1 )[ index ] );
+    const size_t begin( getChildrenOffset() );
+    if( 0 == begin || offset < begin || offset + sizeof( BinaryStructure ) > m_node->m_size ) {
+        return BinaryNodeView();
+    }
+    const char *child( reinterpret_cast<const char*>( m_node ) + offset );
+    BinaryNodeView view( m_reader, reinterpret_cast<const BinaryStructure*>( child ) );
+    if( view.isValid() && view.m_node->m_size > m_node->m_size - offset ) {
+        return BinaryNodeView();
+    }
+
+    return view;
+}
+
+BinaryNodeView BinaryNodeView::findChild( const char *type ) const {
+    if( ddl_nullptr == type ) {
+        return BinaryNodeView();
+    }
+
+    for( size_t i = 0; i < getNumChildren(); i++ ) {
+        BinaryNodeView child( getChild( i ) );
+        if( child.isValid() && 0 == ::strcmp( type, child.getType() ) ) {
+            return child;
+        }
+    }
+
+    return BinaryNodeView();
+}
+
+size_t BinaryNodeView::getNumProperties() const {
+    return isValid() ? m_node->m_numProperties : 0;
+}
+
+BinaryPropertyView BinaryNodeView::getProperty( size_t index ) const {
+    if( index >= getNumProperties() ) {
+        return BinaryPropertyView();
+    }
+
+    const BinaryProperty *props( reinterpret_cast<const BinaryProperty*>( getBody() ) );
+
+    return BinaryPropertyView( m_reader, props + index );
+}
+
+BinaryPropertyView BinaryNodeView::findProperty( const char *key ) const {
+    if( ddl_nullptr == key ) {
+        return BinaryPropertyView();
+    }
+
+    for( size_t i = 0; i < getNumProperties(); i++ ) {
+        BinaryPropertyView prop( getProperty( i ) );
+        if( prop.isValid() && 0 == ::strcmp( key, prop.getKey() ) ) {
+            return prop;
+        }
+    }
+
+    return BinaryPropertyView();
+}
+
+size_t BinaryNodeView::getNumData() const {
+    return isValid() ? m_node->m_numData : 0;
+}
+
+BinaryDataView BinaryNodeView::getData( size_t index ) const {
+    if( index >= getNumData() ) {
+        return BinaryDataView();
+    }
+
+    // the blocks have different sizes, walk to the requested one
+    const char *current( getBody() + m_node->m_numProperties * sizeof( BinaryProperty ) );
+    for( size_t i = 0; i < index; i++ ) {
+        BinaryDataView data( m_reader, reinterpret_cast<const BinaryData*>( current ) );
+        if( !data.isValid() ) {
+            return BinaryDataView();
+        }
+        const BinaryData *header( reinterpret_cast<const BinaryData*>( current ) );
+        current += sizeof( BinaryData ) + header->m_payloadSize;
+    }
+
+    return BinaryDataView( m_reader, reinterpret_cast<const BinaryData*>( current ) );
+}
+
+const char *BinaryNodeView::getBody() const {
+    return reinterpret_cast<const char*>( m_node + 1 ) + alignSize( m_node->m_numChildren * sizeof( uint32 ) );
+}
+
+size_t BinaryNodeView::getChildrenOffset() const {
+    // returns the offset behind the last data block, 0 if the body does not fit into the record
+    size_t offset( getBody() - reinterpret_cast<const char*>( m_node ) );
+    offset += static_cast<size_t>( m_node->m_numProperties ) * sizeof( BinaryProperty );
+    for( size_t i = 0; i < m_node->m_numData; i++ ) {
+        if( offset + sizeof( BinaryData ) > m_node->m_size ) {
+            return 0;
+        }
+        const BinaryData *header( reinterpret_cast<const BinaryData*>( reinterpret_cast<const char*>( m_node ) + offset ) );
+        if( !BinaryDataView( m_reader, header ).isValid() ) {
+            return 0;
+        }
+        offset += sizeof( BinaryData ) + header->m_payloadSize;
+    }
+
+    return offset <= m_node->m_size ? offset : 0;
+}
+
+static Name *createName( const char *str ) {
+    if( '\0' == *str ) {
+        return ddl_nullptr;
+    }
+
+    const NameType type( '$' == *str ? GlobalName : LocalName );
+    const char *id( str + 1 );
+
+    return new Name( type, new Text( id, ::strlen( id ) ) );
+}
+
+static Value *createValue( const BinaryDataView &data, size_t index ) {
+    const Value::ValueType type( data.getType() );
+    if( Value::ddl_string == type ) {
+        const char *str( data.getString( index ) );
+        Value *value( ValueAllocator::allocPrimData( type, ::strlen( str ) ) );
+        value->setString( str );
+        return value;
+    }
+
+    Value *value( ValueAllocator::allocPrimData( type ) );
+    if( ddl_nullptr == value ) {
+        return ddl_nullptr;
+    }
+    if( Value::ddl_bool == type ) {
+        value->setBool( 0 != data.getValues<uint8>()[ index ] );
+    } else {
+        const unsigned char *payload( static_cast<const unsigned char*>( data.getPayload() ) );
+        const size_t size( getBinaryValueSize( type ) );
+        ::memcpy( value->m_data, payload + index * size, size );
+    }
+
+    return value;
+}
+
+static Value *createValueList( const BinaryDataView &data, size_t first, size_t count ) {
+    Value *head( ddl_nullptr ), *prev( ddl_nullptr );
+    for( size_t i = first; i < first + count; i++ ) {
+        Value *value( createValue( data, i ) );
+        if( ddl_nullptr == value ) {
+            break;
+        }
+        if( ddl_nullptr == prev ) {
+            head = value;
+        } else {
+            prev->setNext( value );
+        }
+        prev = value;
+    }
+
+    return head;
+}
+
+static bool createData( const BinaryDataView &data, DDLNode *node ) {
+    const size_t numValues( data.getNumValues() );
+    if( Value::ddl_ref == data.getType() ) {
+        Reference *ref( new Reference );
+        ref->m_numRefs = numValues;
+        ref->m_referencedName = new Name *[ numValues ];
+        for( size_t i = 0; i < numValues; i++ ) {
+            ref->m_referencedName[ i ] = createName( data.getString( i ) );
+        }
+        node->setReferences( ref );
+        return true;
+    }
+
+    const size_t arraySize( data.getArraySize() );
+    if( 0 == arraySize ) {
+        node->setValue( createValueList( data, 0, numValues ) );
+        return true;
+    }
+
+    DataArrayList *head( ddl_nullptr ), *prev( ddl_nullptr );
+    for( size_t i = 0; i < numValues; i += arraySize ) {
+        DataArrayList *al( new DataArrayList );
+        al->m_numItems = arraySize;
+        al->m_dataList = createValueList( data, i, std::min( arraySize, numValues - i ) );
+        if( ddl_nullptr == prev ) {
+            head = al;
+        } else {
+            prev->m_next = al;
+        }
+        prev = al;
+    }
+    node->setDataArrayList( head );
+
+    return true;
+}
+
+static Property *createProperty( const BinaryPropertyView &view ) {
+    const char *key( view.getKey() );
+    Property *prop( new Property( new Text( key, ::strlen( key ) ) ) );
+    const Value::ValueType type( view.getType() );
+    if( Value::ddl_ref == type ) {
+        Name *name( createName( view.getString() ) );
+        if( ddl_nullptr != name ) {
+            prop->m_ref = new Reference;
+            prop->m_ref->m_numRefs = 1;
+            prop->m_ref->m_referencedName = new Name *[ 1 ];
+            prop->m_ref->m_referencedName[ 0 ] = name;
+        }
+    } else if( Value::ddl_string == type ) {
+        const char *str( view.getString() );
+        prop->m_value = ValueAllocator::allocPrimData( type, ::strlen( str ) );
+        prop->m_value->setString( str );
+    } else if( Value::ddl_bool == type ) {
+        prop->m_value = ValueAllocator::allocPrimData( type );
+        prop->m_value->setBool( view.getBool() );
+    } else if( 0 != getBinaryValueSize( type ) ) {
+        prop->m_value = ValueAllocator::allocPrimData( type );
+        const uint64 bits( view.getRawValue() );
+        ::memcpy( prop->m_value->m_data, &bits, prop->m_value->m_size );
+    }
+
+    return prop;
+}
+
+static DDLNode *createNode( const BinaryNodeView &view, DDLNode *parent ) {
+    if( !view.isValid() ) {
+        return ddl_nullptr;
+    }
+
+    DDLNode *node( DDLNode::create( view.getType(), view.getName(), parent ) );
+    node->setNameType( view.getNameType() );
+    Property *first( ddl_nullptr ), *prev( ddl_nullptr );
+    for( size_t i = 0; i < view.getNumProperties(); i++ ) {
+        BinaryPropertyView propView( view.getProperty( i ) );
+        if( !propView.isValid() ) {
+            return ddl_nullptr;
+        }
+        Property *prop( createProperty( propView ) );
+        if( ddl_nullptr == prev ) {
+            first = prop;
+        } else {
+            prev->m_next = prop;
+        }
+        prev = prop;
+    }
+    node->setProperties( first );
+
+    for( size_t i = 0; i < view.getNumData(); i++ ) {
+        BinaryDataView data( view.getData( i ) );
+        if( !data.isValid() || !createData( data, node ) ) {
+            return ddl_nullptr;
+        }
+    }
+
+    for( size_t i = 0; i < view.getNumChildren(); i++ ) {
+        if( ddl_nullptr == createNode( view.getChild( i ), node ) ) {
+            return ddl_nullptr;
+        }
+    }
+
+    return node;
+}
+
+OpenDDLBinaryReader::OpenDDLBinaryReader()
+: m_data( ddl_nullptr )
+, m_size( 0 )
+, m_mapped( false )
+, m_mapping( ddl_nullptr )
+, m_strings( ddl_nullptr )
+, m_numStrings( 0 ) {
+    // empty
+}
+
+OpenDDLBinaryReader::~OpenDDLBinaryReader() {
+    close();
+}
+
+bool OpenDDLBinaryReader::open( const std::string &filename ) {
+    close();
+    if( filename.empty() ) {
+        return false;
+    }
+
+#ifdef _WIN32
+    HANDLE file( ::CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, ddl_nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, ddl_nullptr ) );
+    if( INVALID_HANDLE_VALUE == file ) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if( !::GetFileSizeEx( file, &size ) || 0 == size.QuadPart ) {
+        ::CloseHandle( file );
+        return false;
+    }
+    HANDLE mapping( ::CreateFileMappingA( file, ddl_nullptr, PAGE_READONLY, 0, 0, ddl_nullptr ) );
+    ::CloseHandle( file );
+    if( ddl_nullptr == mapping ) {
+        return false;
+    }
+    const void *data( ::MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) );
+    if( ddl_nullptr == data ) {
+        ::CloseHandle( mapping );
+        return false;
+    }
+    m_mapping = mapping;
+    m_size = static_cast<size_t>( size.QuadPart );
+#else
+    const int fd( ::open( filename.c_str(), O_RDONLY ) );
+    if( fd < 0 ) {
+        return false;
+    }
+    struct stat info;
+    if( 0 != ::fstat( fd, &info ) || info.st_size <= 0 ) {
+        ::close( fd );
+        return false;
+    }
+    void *data( ::mmap( ddl_nullptr, static_cast<size_t>( info.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 ) );
+    ::close( fd );
+    if( MAP_FAILED == data ) {
+        return false;
+    }
+    m_mapping = data;
+    m_size = static_cast<size_t>( info.st_size );
+#endif // _WIN32
+
+    m_data = static_cast<const char*>( data );
+    m_mapped = true;
+    if( !validate() ) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+bool OpenDDLBinaryReader::setBuffer( const char *buffer, size_t len ) {
+    close();
+    if( ddl_nullptr == buffer || 0 != reinterpret_cast<size_t>( buffer ) % BinaryAlignment ) {
+        return false;
+    }
+
+    m_data = buffer;
+    m_size = len;
+    if( !validate() ) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void OpenDDLBinaryReader::close() {
+    if( m_mapped ) {
+#ifdef _WIN32
+        ::UnmapViewOfFile( m_data );
+        ::CloseHandle( static_cast<HANDLE>( m_mapping ) );
+#else
+        ::munmap( m_mapping, m_size );
+#endif // _WIN32
+    }
+
+    m_data = ddl_nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_mapping = ddl_nullptr;
+    m_strings = ddl_nullptr;
+    m_numStrings = 0;
+}
+
+bool OpenDDLBinaryReader::isOpen() const {
+    return ddl_nullptr != m_data;
+}
+
+BinaryNodeView OpenDDLBinaryReader::getRoot() const {
+    if( !isOpen() ) {
+        return BinaryNodeView();
+    }
+
+    const BinaryHeader *header( reinterpret_cast<const BinaryHeader*>( m_data ) );
+
+    return BinaryNodeView( this, reinterpret_cast<const BinaryStructure*>( m_data + header->m_rootOffset ) );
+}
+
+DDLNode *OpenDDLBinaryReader::createNodeTree() const {
+    // nodes of a broken tree stay in the node registry and are released with all other nodes
+    return createNode( getRoot(), ddl_nullptr );
+}
+
+size_t OpenDDLBinaryReader::getNumStrings() const {
+    return m_numStrings;
+}
+
+const char *OpenDDLBinaryReader::getString( uint32 id ) const {
+    if( id >= m_numStrings ) {
+        return EmptyString;
+    }
+
+    // the table was checked by validate, the characters are checked on access
+    const char *table( reinterpret_cast<const char*>( m_strings ) );
+    const BinaryString &entry( m_strings[ id ] );
+    const char *str( table + entry.m_offset );
+    if( !isInside( str, static_cast<size_t>( entry.m_length ) + 1 ) || '\0' != str[ entry.m_length ] ) {
+        return EmptyString;
+    }
+
+    return str;
+}
+
+size_t OpenDDLBinaryReader::getSize() const {
+    return m_size;
+}
+
+bool OpenDDLBinaryReader::isInside( const void *ptr, size_t len ) const {
+    const char *start( static_cast<const char*>( ptr ) );
+    if( ddl_nullptr == m_data || start < m_data ) {
+        return false;
+    }
+
+    const size_t offset( static_cast<size_t>( start - m_data ) );
+
+    return offset <= m_size && len <= m_size - offset;
+}
+
+bool OpenDDLBinaryReader::validate() {
+    const uint16 endianTest( 1 );
+    unsigned char first( 0 );
+    ::memcpy( &first, &endianTest, 1 );
+    if( 1 != first || m_size < sizeof( BinaryHeader ) ) {
+        return false;
+    }
+
+    const BinaryHeader *header( reinterpret_cast<const BinaryHeader*>( m_data ) );
+    if( 0 != ::memcmp( header->m_magic, BinaryMagic, sizeof( BinaryMagic ) ) || BinaryVersion != header->m_version ) {
+        return false;
+    }
+    if( header->m_fileSize > m_size || 0 != header->m_rootOffset % BinaryAlignment || 0 != header->m_stringTableOffset % BinaryAlignment ) {
+        return false;
+    }
+
+    const char *table( m_data + header->m_stringTableOffset );
+    if( header->m_stringTableOffset > m_size || !isInside( table, static_cast<size_t>( header->m_numStrings ) * sizeof( BinaryString ) ) ) {
+        return false;
+    }
+    m_strings = reinterpret_cast<const BinaryString*>( table );
+    m_numStrings = header->m_numStrings;
+
+    return header->m_rootOffset <= m_size && getRoot().isValid();
+}
+
+END_ODDLPARSER_NS
@@ -0,0 +1,165 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <openddlparser/OpenDDLBlockReader.h>
+
+BEGIN_ODDLPARSER_NS
+
+const size_t BlockReader::DefaultBlockSize = 4 * 1024 * 1024;
+
+// one block is read while the other one is consumed
+static const size_t NumBlocks = 2;
+
+BlockReader::BlockReader()
+: m_file( ddl_nullptr )
+, m_blockSize( DefaultBlockSize )
+, m_thread()
+, m_mutex()
+, m_changed()
+, m_filled()
+, m_free()
+, m_lent( false )
+, m_done( false )
+, m_stop( false )
+, m_error( false ) {
+    // empty
+}
+
+BlockReader::~BlockReader() {
+    close();
+}
+
+bool BlockReader::open( const std::string &filename, size_t blockSize ) {
+    close();
+    m_file = ::fopen( filename.c_str(), "rb" );
+    if( ddl_nullptr == m_file ) {
+        return false;
+    }
+
+    m_blockSize = ( 0 == blockSize ) ? DefaultBlockSize : blockSize;
+    m_lent = false;
+    m_done = false;
+    m_stop = false;
+    m_error = false;
+    m_free.resize( NumBlocks );
+    m_thread = std::thread( &BlockReader::readerMain, this );
+
+    return true;
+}
+
+bool BlockReader::isOpen() const {
+    return ddl_nullptr != m_file;
+}
+
+bool BlockReader::read( std::vector<char> &block ) {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    if( ddl_nullptr == m_file ) {
+        block.clear();
+        return false;
+    }
+
+    // the buffer of the former block can be filled again
+    if( m_lent ) {
+        m_lent = false;
+        block.clear();
+        m_free.push_back( std::vector<char>() );
+        m_free.back().swap( block );
+        m_changed.notify_all();
+    }
+    while( m_filled.empty() && !m_done ) {
+        m_changed.wait( lock );
+    }
+    if( m_filled.empty() ) {
+        block.clear();
+        return false;
+    }
+
+    block.swap( m_filled.front() );
+    m_filled.pop_front();
+    m_lent = true;
+
+    return true;
+}
+
+bool BlockReader::hasError() const {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return m_error;
+}
+
+void BlockReader::close() {
+    if( ddl_nullptr == m_file ) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_stop = true;
+    }
+    m_changed.notify_all();
+    m_thread.join();
+    ::fclose( m_file );
+    m_file = ddl_nullptr;
+    m_filled.clear();
+    m_free.clear();
+}
+
+size_t BlockReader::getBlockSize() const {
+    return m_blockSize;
+}
+
+void BlockReader::readerMain() {
+    for( ;; ) {
+        std::vector<char> buffer;
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            while( !m_stop && m_free.empty() ) {
+                m_changed.wait( lock );
+            }
+            if( m_stop ) {
+                return;
+            }
+            buffer.swap( m_free.front() );
+            m_free.pop_front();
+        }
+
+        buffer.resize( m_blockSize );
+        const size_t numRead( ::fread( &buffer[ 0 ], 1, m_blockSize, m_file ) );
+        buffer.resize( numRead );
+        const bool last( numRead < m_blockSize );
+
+        std::unique_lock<std::mutex> lock( m_mutex );
+        if( numRead > 0 ) {
+            m_filled.push_back( std::vector<char>() );
+            m_filled.back().swap( buffer );
+        }
+        if( last ) {
+            m_done = true;
+            m_error = ( 0 != ::ferror( m_file ) );
+        }
+        m_changed.notify_all();
+        if( last ) {
+            return;
+        }
+    }
+}
+
+END_ODDLPARSER_NS
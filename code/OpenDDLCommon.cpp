@@ -110,7 +110,7 @@ Reference::~Reference() {
     m_referencedName = ddl_nullptr;
 }
 
-size_t Reference::sizeInBytes() {
+size_t Reference::sizeInBytes() const {
     if ( 0 == m_numRefs ) {
         return 0;
     }
@@ -152,7 +152,7 @@ DataArrayList::~DataArrayList() {
     // empty
 }
 
-size_t DataArrayList::size() {
+size_t DataArrayList::size() const {
     size_t result( 0 );
     if ( ddl_nullptr == m_next ) {
         if ( m_dataList != ddl_nullptr ) {
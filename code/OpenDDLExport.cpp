@@ -24,8 +24,25 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <openddlparser/DDLNode.h>
 #include <openddlparser/Value.h>
 #include <openddlparser/OpenDDLParser.h>
+#include <openddlparser/OpenDDLThreadPool.h>
 
-#include <sstream>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#   include <io.h>
+#   include <fcntl.h>
+#   include <sys/stat.h>
+#else
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif // _WIN32
 
 BEGIN_ODDLPARSER_NS
 
@@ -42,45 +59,276 @@ std::string StreamFormatterBase::format( const std::string &statement ) {
     return tmp;
 }
 
+const size_t IOStreamBase::DefaultBufferSize = 64 * 1024;
+
+static int openFile( const std::string &name ) {
+#ifdef _WIN32
+    return ::_open( name.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE );
+#else
+    return ::open( name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+#endif // _WIN32
+}
+
+static void closeFile( int fd ) {
+#ifdef _WIN32
+    ::_close( fd );
+#else
+    ::close( fd );
+#endif // _WIN32
+}
+
+static size_t writeFile( int fd, const char *data, size_t len ) {
+    size_t written( 0 );
+    while( written < len ) {
+#ifdef _WIN32
+        const int chunk( ::_write( fd, data + written, static_cast<unsigned int>( std::min<size_t>( len - written, 1 << 30 ) ) ) );
+#else
+        const ssize_t chunk( ::write( fd, data + written, len - written ) );
+        if( chunk < 0 && EINTR == errno ) {
+            continue;
+        }
+#endif // _WIN32
+        if( chunk <= 0 ) {
+            break;
+        }
+        written += static_cast<size_t>( chunk );
+    }
+
+    return written;
+}
+
 IOStreamBase::IOStreamBase( StreamFormatterBase *formatter )
 : m_formatter( formatter )
-, m_file( ddl_nullptr ) {
-    if (ddl_nullptr == m_formatter) {
-        m_formatter = new StreamFormatterBase;
-    }
+, m_fd( -1 )
+, m_buffer()
+, m_bufferSize( DefaultBufferSize ) {
+    // empty
 }
 
 IOStreamBase::~IOStreamBase() {
+    IOStreamBase::close();
     delete m_formatter;
     m_formatter = ddl_nullptr;
 }
 
 bool IOStreamBase::open( const std::string &name ) {
-    m_file = ::fopen( name.c_str(), "a" );
-    if (m_file == ddl_nullptr) {
+    IOStreamBase::close();
+    m_fd = openFile( name );
+    if( m_fd < 0 ) {
         return false;
     }
-    
+
     return true;
 }
 
 bool IOStreamBase::close() {
-    if (ddl_nullptr == m_file) {
+    if( m_fd < 0 ) {
         return false;
     }
 
-    ::fclose( m_file );
-    m_file = ddl_nullptr;
+    const bool ok( flush() );
+    closeFile( m_fd );
+    m_fd = -1;
 
-    return true;
+    return ok;
+}
+
+bool IOStreamBase::isOpen() const {
+    return ( m_fd >= 0 );
+}
+
+bool IOStreamBase::isAborted() const {
+    return false;
 }
 
 size_t IOStreamBase::write( const std::string &statement ) {
-    if (ddl_nullptr == m_file) {
+    if( ddl_nullptr == m_formatter ) {
+        return write( statement.c_str(), statement.size() );
+    }
+
+    // the formatter may change the length, the caller checks the size of its own statement
+    const std::string formatStatement( m_formatter->format( statement ) );
+    if( write( formatStatement.c_str(), formatStatement.size() ) != formatStatement.size() ) {
+        return 0;
+    }
+
+    return statement.size();
+}
+
+size_t IOStreamBase::write( const char *data, size_t len ) {
+    if( ddl_nullptr == data || 0 == len || !isOpen() ) {
         return 0;
     }
-    std::string formatStatement = m_formatter->format( statement );
-    return ::fwrite( formatStatement.c_str(), sizeof( char ), formatStatement.size(), m_file );
+
+    if( 0 == m_bufferSize ) {
+        return writeData( data, len );
+    }
+
+    // the backend always gets whole blocks of the buffer size, only the last one may be shorter
+    size_t written( 0 );
+    while( written < len ) {
+        const size_t remaining( len - written );
+        if( m_buffer.empty() && remaining >= m_bufferSize ) {
+            // whole blocks are passed through without a copy
+            const size_t blocks( remaining - remaining % m_bufferSize );
+            if( writeData( data + written, blocks ) != blocks ) {
+                return 0;
+            }
+            written += blocks;
+            continue;
+        }
+
+        if( m_buffer.capacity() < m_bufferSize ) {
+            m_buffer.reserve( m_bufferSize );
+        }
+        const size_t count( std::min( remaining, m_bufferSize - m_buffer.size() ) );
+        m_buffer.insert( m_buffer.end(), data + written, data + written + count );
+        written += count;
+        if( m_buffer.size() == m_bufferSize && !flush() ) {
+            return 0;
+        }
+    }
+
+    return len;
+}
+
+bool IOStreamBase::flush() {
+    if( m_buffer.empty() ) {
+        return true;
+    }
+
+    const size_t len( m_buffer.size() );
+    const size_t written( writeData( &m_buffer[ 0 ], len ) );
+    m_buffer.clear();
+
+    return ( written == len );
+}
+
+void IOStreamBase::setBufferSize( size_t size ) {
+    flush();
+    m_bufferSize = size;
+}
+
+size_t IOStreamBase::getBufferSize() const {
+    return m_bufferSize;
+}
+
+size_t IOStreamBase::writeData( const char *data, size_t len ) {
+    if( m_fd < 0 ) {
+        return 0;
+    }
+
+    return writeFile( m_fd, data, len );
+}
+
+StringStream::StringStream( std::string &target, StreamFormatterBase *formatter )
+: IOStreamBase( formatter )
+, m_target( target ) {
+    // the target is a buffer already
+    setBufferSize( 0 );
+}
+
+StringStream::~StringStream() {
+    flush();
+}
+
+bool StringStream::open( const std::string & ) {
+    return true;
+}
+
+bool StringStream::close() {
+    return flush();
+}
+
+bool StringStream::isOpen() const {
+    return true;
+}
+
+size_t StringStream::writeData( const char *data, size_t len ) {
+    m_target.append( data, len );
+    return len;
+}
+
+CallbackStream::CallbackStream( chunkCallback callback, size_t chunkSize, StreamFormatterBase *formatter )
+: IOStreamBase( formatter )
+, m_callback( callback )
+, m_aborted( false ) {
+    setBufferSize( 0 == chunkSize ? DefaultBufferSize : chunkSize );
+}
+
+CallbackStream::~CallbackStream() {
+    flush();
+}
+
+bool CallbackStream::open( const std::string & ) {
+    m_aborted = false;
+    return isOpen();
+}
+
+bool CallbackStream::close() {
+    return flush() && !m_aborted;
+}
+
+bool CallbackStream::isOpen() const {
+    return static_cast<bool>( m_callback ) && !m_aborted;
+}
+
+bool CallbackStream::isAborted() const {
+    return m_aborted;
+}
+
+// the wait between two offers of a refused chunk, doubled per retry up to the maximum
+static const std::chrono::microseconds MinRetryWait( 50 );
+static const std::chrono::microseconds MaxRetryWait( 10000 );
+
+size_t CallbackStream::writeData( const char *data, size_t len ) {
+    const size_t chunkSize( getBufferSize() );
+    size_t written( 0 );
+    std::chrono::microseconds wait( MinRetryWait );
+    while( !m_aborted && written < len ) {
+        const size_t count( std::min( chunkSize, len - written ) );
+        const ChunkResult result( m_callback( data + written, count ) );
+        if( ChunkAccepted == result ) {
+            written += count;
+            wait = MinRetryWait;
+        } else if( ChunkRetry == result ) {
+            // the receiver is busy, sleep and offer the same chunk again
+            std::this_thread::sleep_for( wait );
+            wait = std::min( wait * 2, MaxRetryWait );
+        } else {
+            m_aborted = true;
+        }
+    }
+
+    return written;
+}
+
+VectorStream::VectorStream( std::vector<char> &target, StreamFormatterBase *formatter )
+: IOStreamBase( formatter )
+, m_target( target ) {
+    // the target is a buffer already
+    setBufferSize( 0 );
+}
+
+VectorStream::~VectorStream() {
+    flush();
+}
+
+bool VectorStream::open( const std::string & ) {
+    return true;
+}
+
+bool VectorStream::close() {
+    return flush();
+}
+
+bool VectorStream::isOpen() const {
+    return true;
+}
+
+size_t VectorStream::writeData( const char *data, size_t len ) {
+    m_target.insert( m_target.end(), data, data + len );
+    return len;
 }
 
 struct DDLNodeIterator {
@@ -98,9 +346,9 @@ struct DDLNodeIterator {
     }
 
     bool getNext( DDLNode **node ) {
-        if( m_childs.size() > (m_idx+1) ) {
-            m_idx++;
+        if( m_childs.size() > m_idx ) {
             *node = m_childs[ m_idx ];
+            m_idx++;
             return true;
         }
 
@@ -112,12 +360,206 @@ private:
     DDLNodeIterator &operator = ( const DDLNodeIterator & ) ddl_no_copy;
 };
 
-static void writeLineEnd( std::string &statement ) {
-    statement += "\n";
+static const char DigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// the longest formatted number: a double with 17 digits, sign, point and exponent
+static const size_t MaxNumberLength = 32;
+
+static size_t countDigits( uint64 value ) {
+    size_t numDigits( 1 );
+    for( ;; ) {
+        if( value < 10 ) {
+            return numDigits;
+        }
+        if( value < 100 ) {
+            return numDigits + 1;
+        }
+        if( value < 1000 ) {
+            return numDigits + 2;
+        }
+        if( value < 10000 ) {
+            return numDigits + 3;
+        }
+        value /= 10000;
+        numDigits += 4;
+    }
+}
+
+static char *formatUnsigned( uint64 value, char *out ) {
+    // the digits are written from the back, two at a time
+    char *end( out + countDigits( value ) ), *start( end );
+    while( value >= 100 ) {
+        const size_t idx( static_cast<size_t>( value % 100 ) * 2 );
+        value /= 100;
+        *--start = DigitPairs[ idx + 1 ];
+        *--start = DigitPairs[ idx ];
+    }
+    if( value >= 10 ) {
+        const size_t idx( static_cast<size_t>( value ) * 2 );
+        *--start = DigitPairs[ idx + 1 ];
+        *--start = DigitPairs[ idx ];
+    } else {
+        *--start = static_cast<char>( '0' + value );
+    }
+
+    return end;
+}
+
+static char *formatSigned( int64 value, char *out ) {
+    if( value < 0 ) {
+        *out++ = '-';
+        return formatUnsigned( 0 - static_cast<uint64>( value ), out );
+    }
+
+    return formatUnsigned( static_cast<uint64>( value ), out );
+}
+
+static char *formatHexBits( uint64 bits, size_t numDigits, char *out ) {
+    static const char HexDigits[] = "0123456789ABCDEF";
+    *out++ = '0';
+    *out++ = 'x';
+    for( size_t i = 0; i < numDigits; i++ ) {
+        *out++ = HexDigits[ ( bits >> ( ( numDigits - 1 - i ) * 4 ) ) & 0xF ];
+    }
+
+    return out;
+}
+
+static char *formatFloat( float value, char *out ) {
+    // there is no literal for nan and infinity, the bits are written as a hex literal
+    if( value != value || value - value != 0.0f ) {
+        uint32 bits;
+        ::memcpy( &bits, &value, sizeof( float ) );
+        return formatHexBits( bits, 8, out );
+    }
+
+    // integral values are written without the float formatting
+    if( value > -1.0e7f && value < 1.0e7f && value == static_cast<float>( static_cast<int32>( value ) )
+            && ( 0.0f != value || !std::signbit( value ) ) ) {
+        return formatSigned( static_cast<int32>( value ), out );
+    }
+
+    // the shortest precision which reads back to the same float
+    for( int precision = 6; ; precision++ ) {
+        const int len( ::snprintf( out, MaxNumberLength, "%.*g", precision, value ) );
+        if( 9 == precision || ::strtof( out, ddl_nullptr ) == value ) {
+            return out + len;
+        }
+    }
+}
+
+static char *formatDouble( double value, char *out ) {
+    if( value != value || value - value != 0.0 ) {
+        uint64 bits;
+        ::memcpy( &bits, &value, sizeof( double ) );
+        return formatHexBits( bits, 16, out );
+    }
+
+    if( value > -1.0e15 && value < 1.0e15 && value == static_cast<double>( static_cast<int64>( value ) )
+            && ( 0.0 != value || !std::signbit( value ) ) ) {
+        return formatSigned( static_cast<int64>( value ), out );
+    }
+
+    for( int precision = 15; ; precision++ ) {
+        const int len( ::snprintf( out, MaxNumberLength, "%.*g", precision, value ) );
+        if( 17 == precision || ::strtod( out, ddl_nullptr ) == value ) {
+            return out + len;
+        }
+    }
+}
+
+static void writeUnsigned( uint64 value, std::string &statement ) {
+    char buffer[ MaxNumberLength ];
+    statement.append( buffer, formatUnsigned( value, buffer ) );
+}
+
+static void writeSigned( int64 value, std::string &statement ) {
+    char buffer[ MaxNumberLength ];
+    statement.append( buffer, formatSigned( value, buffer ) );
+}
+
+static void writeFloat( float value, std::string &statement ) {
+    char buffer[ MaxNumberLength ];
+    statement.append( buffer, formatFloat( value, buffer ) );
+}
+
+static void writeDouble( double value, std::string &statement ) {
+    char buffer[ MaxNumberLength ];
+    statement.append( buffer, formatDouble( value, buffer ) );
+}
+
+template<class T>
+inline
+T readData( const Value *value ) {
+    T data;
+    ::memcpy( &data, value->m_data, sizeof( T ) );
+    return data;
+}
+
+static bool isBulkType( Value::ValueType type ) {
+    return ( type >= Value::ddl_int8 && type <= Value::ddl_double );
+}
+
+// formats one numeric value of a list, the type was checked by the caller
+static char *formatNumber( const Value *value, Value::ValueType type, char *out ) {
+    switch( type ) {
+        case Value::ddl_int8:
+            return formatSigned( readData<int8>( value ), out );
+        case Value::ddl_int16:
+            return formatSigned( readData<int16>( value ), out );
+        case Value::ddl_int32:
+            return formatSigned( readData<int32>( value ), out );
+        case Value::ddl_int64:
+            return formatSigned( readData<int64>( value ), out );
+        case Value::ddl_unsigned_int8:
+            return formatUnsigned( readData<uint8>( value ), out );
+        case Value::ddl_unsigned_int16:
+            return formatUnsigned( readData<uint16>( value ), out );
+        case Value::ddl_unsigned_int32:
+            return formatUnsigned( readData<uint32>( value ), out );
+        case Value::ddl_unsigned_int64:
+            return formatUnsigned( readData<uint64>( value ), out );
+        case Value::ddl_half:
+            return formatFloat( halfToFloat( readData<uint16>( value ) ), out );
+        case Value::ddl_float:
+            return formatFloat( readData<float>( value ), out );
+        case Value::ddl_double:
+            return formatDouble( readData<double>( value ), out );
+        default:
+            break;
+    }
+
+    return out;
+}
+
+static void writeString( const char *value, std::string &statement ) {
+    // the parser reads the characters of a string literal as they are, so nothing is escaped
+    statement += '"';
+    statement += value;
+    statement += '"';
 }
 
+// statements of big subtrees are handed over to the stream in blocks of this size
+static const size_t StatementBlockSize = 64 * 1024;
+
 OpenDDLExport::OpenDDLExport( IOStreamBase *stream )
-: m_stream( stream ) {
+: m_stream( stream )
+, m_outputMode( PrettyOutput )
+, m_indentWidth( 4 )
+, m_indentChar( ' ' )
+, m_numThreads( 1 )
+, m_pool( ddl_nullptr )
+, m_parallel( false ) {
     if (ddl_nullptr == m_stream) {
         m_stream = new IOStreamBase();
     }
@@ -128,6 +570,38 @@ OpenDDLExport::~OpenDDLExport() {
         m_stream->close();
     }
     delete m_stream;
+    delete m_pool;
+}
+
+void OpenDDLExport::setOutputMode( OutputMode mode ) {
+    m_outputMode = mode;
+}
+
+OpenDDLExport::OutputMode OpenDDLExport::getOutputMode() const {
+    return m_outputMode;
+}
+
+void OpenDDLExport::setIndentation( size_t width, char indentChar ) {
+    m_indentWidth = width;
+    m_indentChar = indentChar;
+}
+
+size_t OpenDDLExport::getIndentationWidth() const {
+    return m_indentWidth;
+}
+
+void OpenDDLExport::setNumThreads( size_t numThreads ) {
+    if( numThreads == m_numThreads ) {
+        return;
+    }
+
+    m_numThreads = numThreads;
+    delete m_pool;
+    m_pool = ddl_nullptr;
+}
+
+size_t OpenDDLExport::getNumThreads() const {
+    return m_numThreads;
 }
 
 bool OpenDDLExport::exportContext( Context *ctx, const std::string &filename ) {
@@ -146,8 +620,13 @@ bool OpenDDLExport::exportContext( Context *ctx, const std::string &filename ) {
         }
     }
 
-    const bool retValue( handleNode( root ) );
-    
+    bool retValue( handleNode( root ) );
+    if( !filename.empty() ) {
+        retValue = m_stream->close() && retValue;
+    } else {
+        retValue = m_stream->flush() && retValue;
+    }
+
     return retValue;
 }
 
@@ -160,61 +639,209 @@ bool OpenDDLExport::handleNode( DDLNode *node ) {
     if( childs.empty() ) {
         return true;
     }
+    if( 1 != m_numThreads && childs.size() > 1 ) {
+        return handleNodesParallel( childs );
+    }
+
     DDLNode *current( ddl_nullptr );
     DDLNodeIterator it( childs );
     std::string statement;
     bool success( true );
     while( it.getNext( &current ) ) {
         if( ddl_nullptr != current ) {
-            success |= writeNode( current, statement );
-            if( !handleNode( current ) ) {
+            if( !writeNode( current, 0, statement ) ) {
                 success = false;
             }
+            if( !writeToStream( statement ) ) {
+                return false;
+            }
+            statement.clear();
         }
     }
 
     return success;
 }
 
+static void materializeSubtree( DDLNode *node ) {
+    std::vector<DDLNode*> stack;
+    stack.push_back( node );
+    while( !stack.empty() ) {
+        DDLNode *current( stack.back() );
+        stack.pop_back();
+        if( ddl_nullptr != current ) {
+            const DDLNode::DllNodeList &childs( current->getChildNodeList() );
+            stack.insert( stack.end(), childs.begin(), childs.end() );
+        }
+    }
+}
+
+bool OpenDDLExport::handleNodesParallel( const DDLNode::DllNodeList &childs ) {
+    if( ddl_nullptr == m_pool ) {
+        m_pool = new ThreadPool( m_numThreads );
+    }
+
+    // the subtrees are formatted in batches, so only a part of the document is buffered
+    const size_t batchSize( m_pool->getNumThreads() * 4 );
+    std::vector<std::string> statements;
+    std::vector<char> results;
+    bool success( true );
+    m_parallel = true;
+    for( size_t first = 0; first < childs.size(); first += batchSize ) {
+        const size_t count( std::min( batchSize, childs.size() - first ) );
+
+        // lazy bodies are parsed here, the workers only read the tree
+        for( size_t i = 0; i < count; i++ ) {
+            materializeSubtree( childs[ first + i ] );
+        }
+
+        statements.assign( count, std::string() );
+        results.assign( count, 1 );
+        m_pool->parallelFor( count, [&]( size_t i ) {
+            DDLNode *node( childs[ first + i ] );
+            if( ddl_nullptr != node && !writeNode( node, 0, statements[ i ] ) ) {
+                results[ i ] = 0;
+            }
+        } );
+
+        for( size_t i = 0; success && i < count; i++ ) {
+            if( 0 == results[ i ] ) {
+                success = false;
+            }
+            success = writeToStream( statements[ i ] ) && success;
+        }
+    }
+    m_parallel = false;
+
+    return success;
+}
+
 bool OpenDDLExport::writeToStream( const std::string &statement ) {
     if (ddl_nullptr == m_stream ) {
         return false;
     }
 
-    if ( !statement.empty()) {
-        m_stream->write( statement );
+    if ( statement.empty() ) {
+        return true;
+    }
+
+    // a stream which was never opened drops the statements, an aborted one fails
+    if ( !m_stream->isOpen() ) {
+        return !m_stream->isAborted();
     }
 
-    return true;
+    return m_stream->write( statement ) == statement.size();
+}
+
+bool OpenDDLExport::handleNodeBegin( DDLNode *node, size_t level ) {
+    std::string statement;
+    const bool success( writeNodeBegin( node, level, statement ) );
+
+    return writeToStream( statement ) && success;
+}
+
+bool OpenDDLExport::handleNodeEnd( DDLNode *node, size_t level ) {
+    std::string statement;
+    bool success( writeNodeData( node, level, statement ) );
+    success = writeNodeEnd( level, statement ) && success;
+
+    return writeToStream( statement ) && success;
+}
+
+bool OpenDDLExport::flush() {
+    if( ddl_nullptr == m_stream ) {
+        return false;
+    }
+
+    return m_stream->flush();
+}
+
+bool OpenDDLExport::writeNode( DDLNode *node, size_t level, std::string &statement ) {
+    if( ddl_nullptr == node ) {
+        return false;
+    }
+
+    bool success( writeNodeBegin( node, level, statement ) );
+    success = writeNodeData( node, level, statement ) && success;
+
+    const DDLNode::DllNodeList &childs( node->getChildNodeList() );
+    for( size_t i = 0; i < childs.size(); i++ ) {
+        if( ddl_nullptr != childs[ i ] ) {
+            success = writeNode( childs[ i ], level + 1, statement ) && success;
+            if( !m_parallel && statement.size() >= StatementBlockSize ) {
+                if( !writeToStream( statement ) ) {
+                    return false;
+                }
+                statement.clear();
+            }
+        }
+    }
+
+    return writeNodeEnd( level, statement ) && success;
 }
 
-bool OpenDDLExport::writeNode( DDLNode *node, std::string &statement ) {
+bool OpenDDLExport::writeNodeBegin( DDLNode *node, size_t level, std::string &statement ) {
+    if( ddl_nullptr == node ) {
+        return false;
+    }
+
     bool success( true );
+    writeIndent( level, statement );
     writeNodeHeader( node, statement );
     if (node->hasProperties()) {
-        success |= writeProperties( node, statement );
+        writeSpace( statement );
+        success = writeProperties( node, statement ) && success;
     }
+    writeSpace( statement );
+    statement += "{";
     writeLineEnd( statement );
 
-    statement = "}";
+    return success;
+}
+
+bool OpenDDLExport::writeNodeData( DDLNode *node, size_t level, std::string &statement ) {
+    if( ddl_nullptr == node ) {
+        return false;
+    }
+
+    bool success( true );
     DataArrayList *al( node->getDataArrayList() );
-    if ( ddl_nullptr != al ) {
-        writeValueType( al->m_dataList->m_type, al->m_numItems, statement );
-        writeValueArray( al, statement );
+    if ( ddl_nullptr != al && ddl_nullptr != al->m_dataList ) {
+        writeIndent( level + 1, statement );
+        statement += getTypeToken( al->m_dataList->m_type );
+        statement += "[";
+        writeUnsigned( al->m_numItems, statement );
+        statement += "]";
+        writeOpenList( statement );
+        success = writeValueArray( al, statement ) && success;
+        writeCloseList( statement );
+        writeLineEnd( statement );
     }
     Value *v( node->getValue() );
     if (ddl_nullptr != v ) {
+        writeIndent( level + 1, statement );
         writeValueType( v->m_type, 1, statement );
-        statement = "{";
+        writeOpenList( statement );
+        success = writeValueList( v, statement ) && success;
+        writeCloseList( statement );
         writeLineEnd( statement );
-        writeValue( v, statement );
-        statement = "}";
+    }
+    Reference *ref( node->getReferences() );
+    if( ddl_nullptr != ref ) {
+        writeIndent( level + 1, statement );
+        statement += getTypeToken( Value::ddl_ref );
+        writeOpenList( statement );
+        success = writeReference( ref, statement ) && success;
+        writeCloseList( statement );
         writeLineEnd( statement );
     }
-    statement = "}";
-    writeLineEnd( statement );
 
-    writeToStream( statement );
+    return success;
+}
+
+bool OpenDDLExport::writeNodeEnd( size_t level, std::string &statement ) {
+    writeIndent( level, statement );
+    statement += "}";
+    writeLineEnd( statement );
 
     return true;
 }
@@ -228,7 +855,7 @@ bool OpenDDLExport::writeNodeHeader( DDLNode *node, std::string &statement ) {
     const std::string &name( node->getName() );
     if ( !name.empty() ) {
         statement += " ";
-        statement += "$";
+        statement += ( LocalName == node->getNameType() ) ? "%" : "$";
         statement += name;
     }
 
@@ -252,12 +879,14 @@ bool OpenDDLExport::writeProperties( DDLNode *node, std::string &statement ) {
         bool first( true );
         while ( ddl_nullptr != prop ) {
             if (!first) {
-                statement += ", ";
+                writeSeparator( statement );
             } else {
                 first = false;
             }
             statement += std::string( prop->m_key->m_buffer );
-            statement += " = ";
+            writeSpace( statement );
+            statement += "=";
+            writeSpace( statement );
             writeValue( prop->m_value, statement );
             prop = prop->m_next;
         }
@@ -278,10 +907,7 @@ bool OpenDDLExport::writeValueType( Value::ValueType type, size_t numItems, std:
     // if we have an array to write
     if ( numItems > 1 ) {
         statement += "[";
-        char buffer[ 256 ];
-        ::memset( buffer, '\0', 256 * sizeof( char ) );
-        sprintf( buffer, "%d", static_cast<int>( numItems ) );
-        statement += buffer;
+        writeUnsigned( numItems, statement );
         statement += "]";
     }
 
@@ -301,99 +927,53 @@ bool OpenDDLExport::writeValue( Value *val, std::string &statement ) {
                 statement += "false";
             }
             break;
-        case Value::ddl_int8: 
-            {
-                std::stringstream stream;
-                const int i = static_cast<int>( val->getInt8() );
-                stream << i;
-                statement += stream.str();
-            }
+        case Value::ddl_int8:
+            writeSigned( val->getInt8(), statement );
             break;
         case Value::ddl_int16:
-            {
-                std::stringstream stream;
-                char buffer[ 256 ];
-                ::memset( buffer, '\0', 256 * sizeof( char ) );
-                sprintf( buffer, "%d", val->getInt16() );
-                statement += buffer;
-        }
+            writeSigned( val->getInt16(), statement );
             break;
         case Value::ddl_int32:
-            {
-                std::stringstream stream;
-                char buffer[ 256 ];
-                ::memset( buffer, '\0', 256 * sizeof( char ) );
-                const int i = static_cast< int >( val->getInt32() );
-                sprintf( buffer, "%d", i );
-                statement += buffer;
-            }
+            writeSigned( val->getInt32(), statement );
             break;
         case Value::ddl_int64:
-            {
-                std::stringstream stream;
-                const int i = static_cast< int >( val->getInt64() );
-                stream << i;
-                statement += stream.str();
-        }
+            writeSigned( val->getInt64(), statement );
             break;
         case Value::ddl_unsigned_int8:
-            {
-                std::stringstream stream;
-                const int i = static_cast< unsigned int >( val->getUnsignedInt8() );
-                stream << i;
-                statement += stream.str();
-            }
+            writeUnsigned( val->getUnsignedInt8(), statement );
             break;
         case Value::ddl_unsigned_int16:
-            {
-                std::stringstream stream;
-                const int i = static_cast< unsigned int >( val->getUnsignedInt16() );
-                stream << i;
-                statement += stream.str();
-            }
+            writeUnsigned( val->getUnsignedInt16(), statement );
             break;
         case Value::ddl_unsigned_int32:
-            {
-                std::stringstream stream;
-                const int i = static_cast< unsigned int >( val->getUnsignedInt32() );
-                stream << i;
-                statement += stream.str();
-            }
+            writeUnsigned( val->getUnsignedInt32(), statement );
             break;
         case Value::ddl_unsigned_int64:
-            {
-                std::stringstream stream;
-                const int i = static_cast< unsigned int >( val->getUnsignedInt64() );
-                stream << i;
-                statement += stream.str();
-            }
+            writeUnsigned( val->getUnsignedInt64(), statement );
             break;
         case Value::ddl_half:
-            break;
-        case Value::ddl_float:
             {
-                std::stringstream stream;
-                stream << val->getFloat();
-                statement += stream.str();
+                uint16 bits( 0 );
+                ::memcpy( &bits, val->m_data, sizeof( uint16 ) );
+                writeFloat( halfToFloat( bits ), statement );
             }
             break;
+        case Value::ddl_float:
+            writeFloat( val->getFloat(), statement );
+            break;
         case Value::ddl_double:
+            writeDouble( val->getDouble(), statement );
             break;
         case Value::ddl_string:
-            {
-                std::stringstream stream;
-                stream << val->getString();
-                statement += "\"";
-                statement += stream.str();
-                statement += "\"";
-             }
+            writeString( val->getString(), statement );
             break;
         case Value::ddl_ref:
+            writeReference( val->getRef(), statement );
             break;
         case Value::ddl_none:
         case Value::ddl_types_max:
         default:
-            break;
+            return false;
     }
 
     return true;
@@ -412,18 +992,17 @@ bool OpenDDLExport::writeValueArray( DataArrayList *al, std::string &statement )
     Value *nextValue( nextDataArrayList->m_dataList );
     while (ddl_nullptr != nextDataArrayList) {
         if (ddl_nullptr != nextDataArrayList) {
-            statement += "{ ";
+            if( nextDataArrayList != al ) {
+                writeSeparator( statement );
+            }
+            statement += "{";
+            writeSpace( statement );
             nextValue = nextDataArrayList->m_dataList;
-            size_t idx( 0 );
-            while (ddl_nullptr != nextValue) {
-                if (idx > 0) {
-                    statement += ", ";
-                }
-                writeValue( nextValue, statement );
-                nextValue = nextValue->m_next;
-                idx++;
+            if( ddl_nullptr != nextValue ) {
+                writeValueList( nextValue, statement );
             }
-            statement += " }";
+            writeSpace( statement );
+            statement += "}";
         }
         nextDataArrayList = nextDataArrayList->m_next;
     }
@@ -431,5 +1010,108 @@ bool OpenDDLExport::writeValueArray( DataArrayList *al, std::string &statement )
     return true;
 }
 
+bool OpenDDLExport::writeValueList( Value *first, std::string &statement ) {
+    if( ddl_nullptr == first ) {
+        return false;
+    }
+
+    std::string separator;
+    writeSeparator( separator );
+    const Value::ValueType type( first->m_type );
+    if( !isBulkType( type ) ) {
+        bool success( true );
+        for( Value *current( first ); ddl_nullptr != current; current = current->m_next ) {
+            if( current != first ) {
+                statement += separator;
+            }
+            success = writeValue( current, statement ) && success;
+        }
+        return success;
+    }
+
+    // numeric lists are formatted into a local chunk, which is appended when it is full
+    static const size_t ChunkSize = 4096;
+    char chunk[ ChunkSize ];
+    char *out( chunk );
+    const char *limit( chunk + ChunkSize - MaxNumberLength - separator.size() );
+    bool success( true );
+    for( Value *current( first ); ddl_nullptr != current; current = current->m_next ) {
+        if( current != first ) {
+            ::memcpy( out, separator.c_str(), separator.size() );
+            out += separator.size();
+        }
+        if( type == current->m_type ) {
+            out = formatNumber( current, type, out );
+        } else {
+            // mixed lists are not created by the parser, they take the slow path
+            statement.append( chunk, out );
+            out = chunk;
+            success = writeValue( current, statement ) && success;
+        }
+        if( out >= limit ) {
+            statement.append( chunk, out );
+            out = chunk;
+        }
+    }
+    statement.append( chunk, out );
+
+    return success;
+}
+
+bool OpenDDLExport::writeReference( Reference *ref, std::string &statement ) {
+    if( ddl_nullptr == ref ) {
+        return false;
+    }
+
+    for( size_t i = 0; i < ref->m_numRefs; i++ ) {
+        if( i > 0 ) {
+            writeSeparator( statement );
+        }
+        Name *name( ref->m_referencedName[ i ] );
+        if( ddl_nullptr == name || ddl_nullptr == name->m_id ) {
+            statement += "null";
+            continue;
+        }
+        statement += ( GlobalName == name->m_type ) ? "$" : "%";
+        statement += std::string( name->m_id->m_buffer, name->m_id->m_len );
+    }
+
+    return true;
+}
+
+void OpenDDLExport::writeIndent( size_t level, std::string &statement ) const {
+    if( CompactOutput != m_outputMode ) {
+        statement.append( level * m_indentWidth, m_indentChar );
+    }
+}
+
+void OpenDDLExport::writeLineEnd( std::string &statement ) const {
+    if( CompactOutput != m_outputMode ) {
+        statement += "\n";
+    }
+}
+
+void OpenDDLExport::writeSpace( std::string &statement ) const {
+    if( CompactOutput != m_outputMode ) {
+        statement += " ";
+    }
+}
+
+void OpenDDLExport::writeSeparator( std::string &statement ) const {
+    statement += ",";
+    writeSpace( statement );
+}
+
+void OpenDDLExport::writeOpenList( std::string &statement ) const {
+    writeSpace( statement );
+    statement += "{";
+    writeSpace( statement );
+}
+
+void OpenDDLExport::writeCloseList( std::string &statement ) const {
+    writeSpace( statement );
+    statement += "}";
+}
+
 END_ODDLPARSER_NS
 
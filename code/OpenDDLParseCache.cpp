@@ -0,0 +1,355 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <openddlparser/OpenDDLParseCache.h>
+#include <openddlparser/OpenDDLBinaryExport.h>
+#include <openddlparser/OpenDDLBinaryReader.h>
+#include <openddlparser/OpenDDLExport.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#   include <windows.h>
+#   include <process.h>
+#   include <sys/utime.h>
+#else
+#   include <dirent.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   include <utime.h>
+#endif // _WIN32
+
+BEGIN_ODDLPARSER_NS
+
+const uint64 OpenDDLParseCache::DefaultMaxSize = 256 * 1024 * 1024;
+
+static const char EntryExtension[] = ".oddb";
+static const size_t EntryNameLength = 16 + sizeof( EntryExtension ) - 1;
+
+static const uint64 Prime1 = 11400714785074694791ULL;
+static const uint64 Prime2 = 14029467366897019727ULL;
+static const uint64 Prime3 = 1609587929392839161ULL;
+static const uint64 Prime4 = 9650029242287828579ULL;
+static const uint64 Prime5 = 2870177450012600261ULL;
+
+static uint64 rotateLeft( uint64 value, int bits ) {
+    return ( value << bits ) | ( value >> ( 64 - bits ) );
+}
+
+static uint64 read64( const unsigned char *data ) {
+    uint64 value( 0 );
+    for( int i = 7; i >= 0; i-- ) {
+        value = ( value << 8 ) | data[ i ];
+    }
+    return value;
+}
+
+static uint32 read32( const unsigned char *data ) {
+    return static_cast<uint32>( data[ 0 ] ) | ( static_cast<uint32>( data[ 1 ] ) << 8 ) |
+        ( static_cast<uint32>( data[ 2 ] ) << 16 ) | ( static_cast<uint32>( data[ 3 ] ) << 24 );
+}
+
+static uint64 hashRound( uint64 acc, uint64 input ) {
+    acc += input * Prime2;
+    acc = rotateLeft( acc, 31 );
+    return acc * Prime1;
+}
+
+static uint64 hashMerge( uint64 acc, uint64 value ) {
+    acc ^= hashRound( 0, value );
+    return acc * Prime1 + Prime4;
+}
+
+struct CacheEntry {
+    std::string m_path;
+    uint64 m_size;
+    uint64 m_time;
+
+    bool operator < ( const CacheEntry &rhs ) const {
+        if( m_time != rhs.m_time ) {
+            return m_time < rhs.m_time;
+        }
+        return m_path < rhs.m_path;
+    }
+};
+
+static bool isEntryName( const char *name ) {
+    const size_t len( ::strlen( name ) );
+    return EntryNameLength == len && 0 == ::strcmp( name + 16, EntryExtension );
+}
+
+static void listEntries( const std::string &directory, std::vector<CacheEntry> &entries ) {
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE handle( ::FindFirstFileA( ( directory + "/*" + EntryExtension ).c_str(), &data ) );
+    if( INVALID_HANDLE_VALUE == handle ) {
+        return;
+    }
+    do {
+        if( isEntryName( data.cFileName ) ) {
+            CacheEntry entry;
+            entry.m_path = directory + "/" + data.cFileName;
+            entry.m_size = ( static_cast<uint64>( data.nFileSizeHigh ) << 32 ) | data.nFileSizeLow;
+            entry.m_time = ( static_cast<uint64>( data.ftLastWriteTime.dwHighDateTime ) << 32 ) | data.ftLastWriteTime.dwLowDateTime;
+            entries.push_back( entry );
+        }
+    } while( ::FindNextFileA( handle, &data ) );
+    ::FindClose( handle );
+#else
+    DIR *dir( ::opendir( directory.c_str() ) );
+    if( ddl_nullptr == dir ) {
+        return;
+    }
+    for( struct dirent *current( ::readdir( dir ) ); ddl_nullptr != current; current = ::readdir( dir ) ) {
+        if( !isEntryName( current->d_name ) ) {
+            continue;
+        }
+        CacheEntry entry;
+        entry.m_path = directory + "/" + current->d_name;
+        struct stat info;
+        if( 0 != ::stat( entry.m_path.c_str(), &info ) ) {
+            continue;
+        }
+        entry.m_size = static_cast<uint64>( info.st_size );
+#if defined( __APPLE__ )
+        entry.m_time = static_cast<uint64>( info.st_mtimespec.tv_sec ) * 1000000000ULL + info.st_mtimespec.tv_nsec;
+#elif defined( __linux__ )
+        entry.m_time = static_cast<uint64>( info.st_mtim.tv_sec ) * 1000000000ULL + info.st_mtim.tv_nsec;
+#else
+        entry.m_time = static_cast<uint64>( info.st_mtime );
+#endif
+        entries.push_back( entry );
+    }
+    ::closedir( dir );
+#endif // _WIN32
+}
+
+static void touchFile( const std::string &path ) {
+#ifdef _WIN32
+    ::_utime( path.c_str(), ddl_nullptr );
+#else
+    ::utime( path.c_str(), ddl_nullptr );
+#endif // _WIN32
+}
+
+static int getProcessId() {
+#ifdef _WIN32
+    return ::_getpid();
+#else
+    return static_cast<int>( ::getpid() );
+#endif // _WIN32
+}
+
+OpenDDLParseCache::OpenDDLParseCache( const std::string &directory, uint64 maxSize )
+: m_directory( directory )
+, m_maxSize( maxSize ) {
+    // empty
+}
+
+OpenDDLParseCache::~OpenDDLParseCache() {
+    // empty
+}
+
+const std::string &OpenDDLParseCache::getDirectory() const {
+    return m_directory;
+}
+
+void OpenDDLParseCache::setMaxSize( uint64 maxSize ) {
+    m_maxSize = maxSize;
+}
+
+uint64 OpenDDLParseCache::getMaxSize() const {
+    return m_maxSize;
+}
+
+uint64 OpenDDLParseCache::computeHash( const char *buffer, size_t len, uint64 seed ) {
+    const unsigned char *current( reinterpret_cast<const unsigned char*>( buffer ) );
+    const unsigned char *end( current + len );
+    uint64 hash( 0 );
+    if( len >= 32 ) {
+        uint64 v1( seed + Prime1 + Prime2 ), v2( seed + Prime2 ), v3( seed ), v4( seed - Prime1 );
+        const unsigned char *limit( end - 32 );
+        do {
+            v1 = hashRound( v1, read64( current ) );
+            v2 = hashRound( v2, read64( current + 8 ) );
+            v3 = hashRound( v3, read64( current + 16 ) );
+            v4 = hashRound( v4, read64( current + 24 ) );
+            current += 32;
+        } while( current <= limit );
+
+        hash = rotateLeft( v1, 1 ) + rotateLeft( v2, 7 ) + rotateLeft( v3, 12 ) + rotateLeft( v4, 18 );
+        hash = hashMerge( hash, v1 );
+        hash = hashMerge( hash, v2 );
+        hash = hashMerge( hash, v3 );
+        hash = hashMerge( hash, v4 );
+    } else {
+        hash = seed + Prime5;
+    }
+    hash += static_cast<uint64>( len );
+
+    for( ; current + 8 <= end; current += 8 ) {
+        hash ^= hashRound( 0, read64( current ) );
+        hash = rotateLeft( hash, 27 ) * Prime1 + Prime4;
+    }
+    if( current + 4 <= end ) {
+        hash ^= static_cast<uint64>( read32( current ) ) * Prime1;
+        hash = rotateLeft( hash, 23 ) * Prime2 + Prime3;
+        current += 4;
+    }
+    for( ; current < end; current++ ) {
+        hash ^= static_cast<uint64>( *current ) * Prime5;
+        hash = rotateLeft( hash, 11 ) * Prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+uint64 OpenDDLParseCache::computeKey( const char *buffer, size_t len ) {
+    return computeHash( buffer, len, BinaryVersion );
+}
+
+DDLNode *OpenDDLParseCache::load( uint64 key ) {
+    const std::string path( getEntryPath( key ) );
+    OpenDDLBinaryReader reader;
+    if( !reader.open( path ) ) {
+        // a broken or outdated entry is replaced by the next store
+        ::remove( path.c_str() );
+        return ddl_nullptr;
+    }
+
+    DDLNode *root( reader.createNodeTree() );
+    reader.close();
+    if( ddl_nullptr == root ) {
+        ::remove( path.c_str() );
+        return ddl_nullptr;
+    }
+    touchFile( path );
+
+    return root;
+}
+
+bool OpenDDLParseCache::store( uint64 key, DDLNode *root ) {
+    if( ddl_nullptr == root ) {
+        return false;
+    }
+
+    std::vector<char> buffer;
+    OpenDDLBinaryExport myExporter;
+    if( !myExporter.exportNode( root, buffer ) || buffer.size() > m_maxSize ) {
+        return false;
+    }
+
+    // write to a temporary file first, so other processes never see a partial entry
+    const std::string path( getEntryPath( key ) );
+    char suffix[ 32 ];
+    ::snprintf( suffix, sizeof( suffix ), ".%d.tmp", getProcessId() );
+    const std::string tempPath( path + suffix );
+    IOStreamBase stream;
+    if( !stream.open( tempPath ) ) {
+        return false;
+    }
+    const size_t written( stream.write( &buffer[ 0 ], buffer.size() ) );
+    if( !stream.close() || written != buffer.size() ) {
+        ::remove( tempPath.c_str() );
+        return false;
+    }
+#ifdef _WIN32
+    ::remove( path.c_str() );
+#endif // _WIN32
+    if( 0 != ::rename( tempPath.c_str(), path.c_str() ) ) {
+        ::remove( tempPath.c_str() );
+        return false;
+    }
+    trim();
+
+    return true;
+}
+
+bool OpenDDLParseCache::contains( uint64 key ) const {
+    FILE *file( ::fopen( getEntryPath( key ).c_str(), "rb" ) );
+    if( ddl_nullptr == file ) {
+        return false;
+    }
+    ::fclose( file );
+
+    return true;
+}
+
+bool OpenDDLParseCache::remove( uint64 key ) {
+    return 0 == ::remove( getEntryPath( key ).c_str() );
+}
+
+void OpenDDLParseCache::trim() {
+    std::vector<CacheEntry> entries;
+    listEntries( m_directory, entries );
+    uint64 size( 0 );
+    for( size_t i = 0; i < entries.size(); i++ ) {
+        size += entries[ i ].m_size;
+    }
+    if( size <= m_maxSize ) {
+        return;
+    }
+
+    std::sort( entries.begin(), entries.end() );
+    for( size_t i = 0; i < entries.size() && size > m_maxSize; i++ ) {
+        if( 0 == ::remove( entries[ i ].m_path.c_str() ) ) {
+            size -= entries[ i ].m_size;
+        }
+    }
+}
+
+void OpenDDLParseCache::clear() {
+    std::vector<CacheEntry> entries;
+    listEntries( m_directory, entries );
+    for( size_t i = 0; i < entries.size(); i++ ) {
+        ::remove( entries[ i ].m_path.c_str() );
+    }
+}
+
+uint64 OpenDDLParseCache::getSize() const {
+    std::vector<CacheEntry> entries;
+    listEntries( m_directory, entries );
+    uint64 size( 0 );
+    for( size_t i = 0; i < entries.size(); i++ ) {
+        size += entries[ i ].m_size;
+    }
+
+    return size;
+}
+
+std::string OpenDDLParseCache::getEntryPath( uint64 key ) const {
+    char name[ EntryNameLength + 1 ];
+    ::snprintf( name, sizeof( name ), "%08x%08x%s", static_cast<uint32>( key >> 32 ), static_cast<uint32>( key ), EntryExtension );
+
+    return m_directory + "/" + name;
+}
+
+END_ODDLPARSER_NS
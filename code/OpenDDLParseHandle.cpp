@@ -0,0 +1,136 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <openddlparser/OpenDDLParseHandle.h>
+
+#include <chrono>
+
+BEGIN_ODDLPARSER_NS
+
+ParseHandle::ParseHandle( const char *buffer, size_t len, OpenDDLParser::logCallback callback, LogSeverity severity, bool useIndex )
+: m_buffer( buffer, buffer + len )
+, m_logCallback( callback )
+, m_logSeverity( severity )
+, m_useIndex( useIndex )
+, m_cancel( false )
+, m_pos( 0 )
+, m_size( 0 )
+, m_context( ddl_nullptr )
+, m_arena()
+, m_result() {
+    m_result = std::async( std::launch::async, [this]() {
+        return run();
+    } ).share();
+}
+
+ParseHandle::~ParseHandle() {
+    cancel();
+    wait();
+    releaseNodes( m_context );
+    m_context = ddl_nullptr;
+}
+
+ParseHandle::State ParseHandle::getState() const {
+    return waitFor( 0 );
+}
+
+bool ParseHandle::isDone() const {
+    return Running != getState();
+}
+
+double ParseHandle::getProgress() const {
+    if( Succeeded == getState() ) {
+        return 1.0;
+    }
+
+    const size_t size( m_size );
+    if( 0 == size ) {
+        return 0.0;
+    }
+
+    return static_cast<double>( m_pos ) / static_cast<double>( size );
+}
+
+void ParseHandle::cancel() {
+    m_cancel = true;
+}
+
+ParseHandle::State ParseHandle::wait() const {
+    return m_result.get();
+}
+
+ParseHandle::State ParseHandle::waitFor( size_t milliseconds ) const {
+    if( std::future_status::ready != m_result.wait_for( std::chrono::milliseconds( milliseconds ) ) ) {
+        return Running;
+    }
+
+    return m_result.get();
+}
+
+Context *ParseHandle::getContext() const {
+    wait();
+    return m_context;
+}
+
+ParseHandle::State ParseHandle::run() {
+    OpenDDLParser parser;
+    parser.m_ownsNodes = false;
+    parser.setLogCallback( m_logCallback );
+    parser.setLogSeverity( m_logSeverity );
+    parser.setUseStructuralIndex( m_useIndex );
+    parser.m_buffer.swap( m_buffer );
+    parser.setProgressCallback( [this]( size_t pos, size_t size ) {
+        m_size = size;
+        m_pos = pos;
+        return !m_cancel;
+    } );
+
+    // the nodes are collected in the arena of the handle instead of the node registry
+    DDLNode::setThreadArena( &m_arena );
+    const bool success( !m_cancel && parser.parse() );
+    DDLNode::setThreadArena( ddl_nullptr );
+
+    Context *ctx( parser.m_context );
+    parser.m_context = ddl_nullptr;
+    if( success ) {
+        m_context = ctx;
+        return Succeeded;
+    }
+
+    releaseNodes( ctx );
+
+    return m_cancel ? Cancelled : Failed;
+}
+
+void ParseHandle::releaseNodes( Context *ctx ) {
+    if( ddl_nullptr != ctx ) {
+        // the root is released with the other nodes of the arena
+        ctx->m_root = ddl_nullptr;
+        delete ctx;
+    }
+    for( size_t i = 0; i < m_arena.size(); i++ ) {
+        delete m_arena[ i ];
+    }
+    m_arena.clear();
+}
+
+END_ODDLPARSER_NS
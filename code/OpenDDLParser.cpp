@@ -21,7 +21,12 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 -----------------------------------------------------------------------------------------------*/
 #include <openddlparser/OpenDDLParser.h>
+#include <openddlparser/OpenDDLBlockReader.h>
 #include <openddlparser/OpenDDLExport.h>
+#include <openddlparser/OpenDDLParseCache.h>
+#include <openddlparser/OpenDDLParseHandle.h>
+#include <openddlparser/OpenDDLReclaimer.h>
+#include <openddlparser/OpenDDLThreadPool.h>
 
 #include <cassert>
 #include <iostream>
@@ -71,13 +76,23 @@ const char *getTypeToken( Value::ValueType  type ) {
     return Grammar::PrimitiveTypeToken[ type ];
 }
 
-static void logInvalidTokenError( char *in, const std::string &exp, OpenDDLParser::logCallback callback ) {
-    std::stringstream stream;
-    stream << "Invalid token \"" << *in << "\"" << " expected \"" << exp << "\"" << std::endl;
-    std::string full(in);
-    std::string part(full.substr(0,50));
-    stream << part;
-    callback( ddl_error_msg, stream.str() );
+// only a short excerpt of the buffer is logged, so the costs do not depend on the buffer size
+static const size_t MaxErrorExcerpt = 50;
+
+static void logInvalidTokenError( const char *in, const char *end, const std::string &exp, const OpenDDLParser &parser ) {
+    if( !parser.isLogEnabled( ddl_error_msg ) ) {
+        return;
+    }
+
+    std::string msg( "Invalid token \"" );
+    if( in < end ) {
+        msg += *in;
+    }
+    msg += "\" expected \"" + exp + "\"\n";
+    if( in < end ) {
+        msg.append( in, std::min<size_t>( end - in, MaxErrorExcerpt ) );
+    }
+    parser.getLogCallback()( ddl_error_msg, msg );
 }
 
 static bool isIntegerType( Value::ValueType integerType ) {
@@ -127,18 +142,173 @@ static void logMessage( LogSeverity severity, const std::string &msg ) {
     std::cout << log;
 }
 
+OpenDDLEventHandler::~OpenDDLEventHandler() {
+    // empty
+}
+
+// splits the buffer after top-level structures into chunks of at least chunkSize bytes and
+// returns the end offsets of the chunks. Brackets in string literals are skipped, unbalanced
+// brackets give no chunks, the serial parser reports the error then.
+static void splitTopLevelStructures( const std::vector<char> &buffer, size_t chunkSize, std::vector<size_t> &chunks ) {
+    chunks.clear();
+    size_t depth( 0 ), chunkStart( 0 );
+    for( size_t i = 0; i < buffer.size(); i++ ) {
+        const char c( buffer[ i ] );
+        if( isStringLiteral( c ) ) {
+            const char *begin( &buffer[ 0 ] );
+            i = skipStringLiteral( begin + i, begin + buffer.size() ) - begin;
+        } else if( '{' == c ) {
+            depth++;
+        } else if( '}' == c ) {
+            if( 0 == depth ) {
+                chunks.clear();
+                return;
+            }
+            depth--;
+            if( 0 == depth && i + 1 - chunkStart >= chunkSize ) {
+                chunks.push_back( i + 1 );
+                chunkStart = i + 1;
+            }
+        }
+    }
+
+    if( 0 != depth ) {
+        chunks.clear();
+        return;
+    }
+
+    // the rest after the last full chunk belongs to the last chunk
+    if( chunks.empty() ) {
+        chunks.push_back( buffer.size() );
+    } else {
+        chunks.back() = buffer.size();
+    }
+}
+
+// finds the ends of the top-level structures in a buffer which grows block by block. The state
+// is kept between the calls, so each byte is only scanned once. Brackets in string literals and
+// line comments are skipped.
+class StructureScanner {
+public:
+    StructureScanner()
+    : m_state( Code )
+    , m_depth( 0 )
+    , m_pos( 0 ) {
+        // empty
+    }
+
+    // returns the offset behind the last complete top-level structure, 0 if there is none
+    size_t scan( const std::vector<char> &buffer ) {
+        size_t boundary( 0 );
+        for( ; m_pos < buffer.size(); m_pos++ ) {
+            const char c( buffer[ m_pos ] );
+            if( String == m_state ) {
+                if( '\\' == c ) {
+                    m_state = Escape;
+                } else if( isStringLiteral( c ) ) {
+                    m_state = Code;
+                }
+            } else if( Escape == m_state ) {
+                m_state = String;
+            } else if( Comment == m_state ) {
+                if( isNewLine( c ) ) {
+                    m_state = Code;
+                }
+            } else if( '/' == c ) {
+                // the next block decides whether this starts a comment
+                if( m_pos + 1 == buffer.size() ) {
+                    break;
+                }
+                if( '/' == buffer[ m_pos + 1 ] ) {
+                    m_state = Comment;
+                    m_pos++;
+                }
+            } else if( isStringLiteral( c ) ) {
+                m_state = String;
+            } else if( '{' == c ) {
+                m_depth++;
+            } else if( '}' == c ) {
+                // an unbalanced bracket ends the structure as well, the parser reports the error
+                if( m_depth > 0 ) {
+                    m_depth--;
+                }
+                if( 0 == m_depth ) {
+                    boundary = m_pos + 1;
+                }
+            }
+        }
+
+        return boundary;
+    }
+
+    // the first bytes of the buffer were removed
+    void consume( size_t numBytes ) {
+        m_pos -= numBytes;
+    }
+
+private:
+    enum State {
+        Code,
+        String,
+        Escape,
+        Comment
+    };
+
+    State m_state;
+    size_t m_depth;
+    size_t m_pos;
+};
+
+const size_t OpenDDLParser::DefaultParallelThreshold = 1024 * 1024;
+
 OpenDDLParser::OpenDDLParser()
 : m_logCallback( logMessage )
+, m_logSeverity( ddl_debug_msg )
 , m_buffer()
 , m_stack()
-, m_context( ddl_nullptr ) {
+, m_context( ddl_nullptr )
+, m_lazy( false )
+, m_lazyDepth( 1 )
+, m_levelOffset( 0 )
+, m_useIndex( false )
+, m_index()
+, m_treeGeneration( 0 )
+, m_treeCount( 0 )
+, m_eventHandler( ddl_nullptr )
+, m_streaming( false )
+, m_cache( ddl_nullptr )
+, m_parallel( false )
+, m_numThreads( 0 )
+, m_parallelThreshold( DefaultParallelThreshold )
+, m_pool( ddl_nullptr )
+, m_ownsNodes( true )
+, m_progressCallback()
+, m_reclaimer( ddl_nullptr ) {
     // empty
 }
 
 OpenDDLParser::OpenDDLParser( const char *buffer, size_t len )
 : m_logCallback( &logMessage )
+, m_logSeverity( ddl_debug_msg )
 , m_buffer()
-, m_context( ddl_nullptr ) {
+, m_context( ddl_nullptr )
+, m_lazy( false )
+, m_lazyDepth( 1 )
+, m_levelOffset( 0 )
+, m_useIndex( false )
+, m_index()
+, m_treeGeneration( 0 )
+, m_treeCount( 0 )
+, m_eventHandler( ddl_nullptr )
+, m_streaming( false )
+, m_cache( ddl_nullptr )
+, m_parallel( false )
+, m_numThreads( 0 )
+, m_parallelThreshold( DefaultParallelThreshold )
+, m_pool( ddl_nullptr )
+, m_ownsNodes( true )
+, m_progressCallback()
+, m_reclaimer( ddl_nullptr ) {
     if( 0 != len ) {
         setBuffer( buffer, len );
     }
@@ -146,6 +316,8 @@ OpenDDLParser::OpenDDLParser( const char *buffer, size_t len )
 
 OpenDDLParser::~OpenDDLParser() {
     clear();
+    delete m_pool;
+    m_pool = ddl_nullptr;
 }
 
 void OpenDDLParser::setLogCallback( logCallback callback ) {
@@ -162,6 +334,18 @@ OpenDDLParser::logCallback OpenDDLParser::getLogCallback() const {
     return m_logCallback;
 }
 
+void OpenDDLParser::setLogSeverity( LogSeverity severity ) {
+    m_logSeverity = severity;
+}
+
+LogSeverity OpenDDLParser::getLogSeverity() const {
+    return m_logSeverity;
+}
+
+bool OpenDDLParser::isLogEnabled( LogSeverity severity ) const {
+    return severity >= m_logSeverity && ddl_none_msg != severity;
+}
+
 void OpenDDLParser::setBuffer( const char *buffer, size_t len ) {
     clear();
     if( 0 == len ) {
@@ -192,11 +376,100 @@ size_t OpenDDLParser::getBufferSize() const {
 
 void OpenDDLParser::clear() {
     m_buffer.resize( 0 );
+    m_index.clear();
+    m_stack.clear();
     if( ddl_nullptr != m_context ) {
         m_context->m_root = ddl_nullptr;
     }
 
-    DDLNode::releaseNodes();
+    // the worker parsers of a parallel parse do not own their nodes
+    if( m_ownsNodes ) {
+        if( ddl_nullptr != m_reclaimer ) {
+            DDLNode::DllNodeList nodes;
+            DDLNode::takeNodes( nodes );
+            m_reclaimer->retireNodes( nodes );
+        } else {
+            DDLNode::releaseNodes();
+        }
+    }
+}
+
+void OpenDDLParser::setLazyParsing( bool enabled, size_t depth ) {
+    m_lazy = enabled;
+    m_lazyDepth = ( 0 == depth ) ? 1 : depth;
+}
+
+bool OpenDDLParser::isLazyParsingEnabled() const {
+    return m_lazy;
+}
+
+void OpenDDLParser::setUseStructuralIndex( bool enabled ) {
+    m_useIndex = enabled;
+}
+
+bool OpenDDLParser::isStructuralIndexEnabled() const {
+    return m_useIndex;
+}
+
+void OpenDDLParser::setEventHandler( OpenDDLEventHandler *handler ) {
+    m_eventHandler = handler;
+}
+
+OpenDDLEventHandler *OpenDDLParser::getEventHandler() const {
+    return m_eventHandler;
+}
+
+void OpenDDLParser::setStreaming( bool enabled ) {
+    m_streaming = enabled;
+}
+
+bool OpenDDLParser::isStreamingEnabled() const {
+    return m_streaming;
+}
+
+void OpenDDLParser::setParallelParsing( bool enabled, size_t numThreads ) {
+    m_parallel = enabled;
+    if( numThreads != m_numThreads ) {
+        delete m_pool;
+        m_pool = ddl_nullptr;
+        m_numThreads = numThreads;
+    }
+}
+
+bool OpenDDLParser::isParallelParsingEnabled() const {
+    return m_parallel;
+}
+
+void OpenDDLParser::setParallelThreshold( size_t size ) {
+    m_parallelThreshold = size;
+}
+
+size_t OpenDDLParser::getParallelThreshold() const {
+    return m_parallelThreshold;
+}
+
+void OpenDDLParser::setCache( OpenDDLParseCache *cache ) {
+    m_cache = cache;
+}
+
+OpenDDLParseCache *OpenDDLParser::getCache() const {
+    return m_cache;
+}
+
+void OpenDDLParser::setReclaimer( Reclaimer *reclaimer ) {
+    m_reclaimer = reclaimer;
+}
+
+Reclaimer *OpenDDLParser::getReclaimer() const {
+    return m_reclaimer;
+}
+
+void OpenDDLParser::setProgressCallback( const progressCallback &callback ) {
+    m_progressCallback = callback;
+}
+
+const OpenDDLParser::progressCallback &OpenDDLParser::getProgressCallback() const {
+    return m_progressCallback;
 }
 
 bool OpenDDLParser::parse() {
@@ -204,26 +477,222 @@ bool OpenDDLParser::parse() {
         return false;
     }
 
+    // known documents are loaded from the cache
+    const bool useCache( ddl_nullptr != m_cache && ddl_nullptr == m_eventHandler && !m_streaming );
+    uint64 cacheKey( 0 );
+    if( useCache ) {
+        cacheKey = OpenDDLParseCache::computeKey( &m_buffer[ 0 ], m_buffer.size() );
+        DDLNode *root( m_cache->load( cacheKey ) );
+        if( ddl_nullptr != root ) {
+            m_context = new Context;
+            m_context->m_root = root;
+            // the loaded tree gets the same numbering as a parsed one
+            m_context->m_root->updateTreeIndex();
+            return true;
+        }
+    }
+
     normalizeBuffer( m_buffer );
+    m_index.clear();
+
+    // big documents are split after their top-level structures and parsed by worker threads
+    std::vector<size_t> chunks;
+    if( isParallelParse() ) {
+        const size_t chunkSize( m_buffer.size() / ( getPool()->getNumThreads() * 4 ) );
+        splitTopLevelStructures( m_buffer, std::max<size_t>( chunkSize, 1 ), chunks );
+    }
+    const bool parallel( chunks.size() > 1 );
+    if( m_useIndex && !parallel ) {
+        m_index.build( &m_buffer[ 0 ], m_buffer.size() );
+    }
+
+    // all nodes created by the main parsing get their pre-order index, the nodes of a parallel
+    // parse are numbered after they were added to the root
+    m_treeGeneration = parallel ? 0 : DDLNode::nextTreeGeneration();
+    m_treeCount = 0;
 
     m_context = new Context;
     m_context->m_root = DDLNode::create( "root", "", ddl_nullptr );
     pushNode( m_context->m_root );
 
-    // do the main parsing
-    char *current( &m_buffer[ 0 ] );
-    char *end( &m_buffer[ m_buffer.size() - 1 ] + 1 );
-    size_t pos( current - &m_buffer[ 0 ] );
-    while( pos < m_buffer.size() ) {
-        current = parseNextNode( current, end );
-        if(current==ddl_nullptr) {
+    if( parallel ) {
+        if( !parseChunks( chunks ) ) {
             return false;
         }
-        pos = current - &m_buffer[ 0 ];
+    } else {
+        // do the main parsing
+        char *current( &m_buffer[ 0 ] );
+        char *end( &m_buffer[ m_buffer.size() - 1 ] + 1 );
+        size_t pos( current - &m_buffer[ 0 ] );
+        while( pos < m_buffer.size() ) {
+            current = parseNextNode( current, end );
+            if(current==ddl_nullptr) {
+                closeTreeIndex();
+                return false;
+            }
+            pos = current - &m_buffer[ 0 ];
+        }
+        closeTreeIndex();
     }
+
+    if( useCache ) {
+        m_cache->store( cacheKey, m_context->m_root );
+    }
+
     return true;
 }
 
+bool OpenDDLParser::parseFile( const std::string &filename, size_t blockSize ) {
+    clear();
+    BlockReader reader;
+    if( !reader.open( filename, blockSize ) ) {
+        log( ddl_error_msg, "Cannot open file " + filename + ".\n" );
+        return false;
+    }
+
+    m_treeGeneration = DDLNode::nextTreeGeneration();
+    m_treeCount = 0;
+    m_context = new Context;
+    m_context->m_root = DDLNode::create( "root", "", ddl_nullptr );
+    pushNode( m_context->m_root );
+
+    // complete top-level structures are parsed while the reader thread loads the next block
+    StructureScanner scanner;
+    std::vector<char> block, pending, segment;
+    bool eof( false ), success( true );
+    while( success && !eof ) {
+        eof = !reader.read( block );
+        pending.insert( pending.end(), block.begin(), block.end() );
+        size_t boundary( eof ? pending.size() : scanner.scan( pending ) );
+        if( 0 == boundary ) {
+            continue;
+        }
+
+        segment.assign( pending.begin(), pending.begin() + boundary );
+        pending.erase( pending.begin(), pending.begin() + boundary );
+        scanner.consume( boundary );
+
+        normalizeBuffer( segment );
+        if( segment.empty() ) {
+            continue;
+        }
+
+        // the nodes of lazy parsing keep offsets, so the buffer can grow. Streamed nodes are
+        // released after their events, so the parsed input is dropped.
+        if( m_streaming ) {
+            m_buffer.clear();
+        }
+        size_t pos( m_buffer.size() );
+        m_buffer.insert( m_buffer.end(), segment.begin(), segment.end() );
+        char *end( &m_buffer[ 0 ] + m_buffer.size() );
+        while( pos < m_buffer.size() ) {
+            // blanks behind the last structure of a segment are no structure
+            char *current( lookForNextToken( &m_buffer[ 0 ] + pos, end ) );
+            if( current == end ) {
+                break;
+            }
+            current = parseNextNode( current, end );
+            if( ddl_nullptr == current ) {
+                success = false;
+                break;
+            }
+            pos = current - &m_buffer[ 0 ];
+        }
+    }
+    closeTreeIndex();
+
+    if( success && reader.hasError() ) {
+        log( ddl_error_msg, "Cannot read file " + filename + ".\n" );
+        success = false;
+    }
+    reader.close();
+
+    return success;
+}
+
+ParseHandle *OpenDDLParser::parseAsync( const char *buffer, size_t len ) const {
+    return new ParseHandle( buffer, len, m_logCallback, m_logSeverity, m_useIndex );
+}
+
+bool OpenDDLParser::isParallelParse() const {
+    return m_parallel && !m_lazy && !m_streaming && ddl_nullptr == m_eventHandler && !m_progressCallback
+        && m_buffer.size() >= m_parallelThreshold;
+}
+
+bool OpenDDLParser::parseChunks( const std::vector<size_t> &chunks ) {
+    const size_t count( chunks.size() );
+    std::vector<DDLNode::DllNodeList> arenas( count );
+    std::vector<DDLNode*> roots( count, ddl_nullptr );
+    std::vector<char> results( count, 0 );
+    m_pool->parallelFor( count, [&]( size_t i ) {
+        const size_t begin( 0 == i ? 0 : chunks[ i - 1 ] );
+        DDLNode::setThreadArena( &arenas[ i ] );
+        roots[ i ] = DDLNode::create( "root", "", ddl_nullptr );
+        results[ i ] = parseChunk( &m_buffer[ 0 ] + begin, &m_buffer[ 0 ] + chunks[ i ], roots[ i ] ) ? 1 : 0;
+        DDLNode::setThreadArena( ddl_nullptr );
+    } );
+
+    // splice the structures in document order, also after an error so all nodes get released
+    DDLNode *root( m_context->m_root );
+    bool success( true );
+    for( size_t i = 0; i < count; i++ ) {
+        DDLNode::spliceArena( arenas[ i ] );
+        success = ( 0 != results[ i ] ) && success;
+        DDLNode *chunkRoot( roots[ i ] );
+        for( size_t j = 0; j < chunkRoot->m_children.size(); j++ ) {
+            chunkRoot->m_children[ j ]->m_parent = root;
+            root->m_children.push_back( chunkRoot->m_children[ j ] );
+        }
+        root->addSubtreeTypeMask( chunkRoot->m_typeMask );
+        chunkRoot->m_children.clear();
+        delete chunkRoot;
+    }
+    root->updateTreeIndex();
+
+    return success;
+}
+
+bool OpenDDLParser::parseChunk( const char *begin, const char *end, DDLNode *root ) const {
+    OpenDDLParser worker;
+    worker.m_ownsNodes = false;
+    worker.m_logCallback = m_logCallback;
+    worker.m_logSeverity = m_logSeverity;
+    worker.m_useIndex = m_useIndex;
+    worker.m_buffer.assign( begin, end );
+    if( worker.m_useIndex ) {
+        worker.m_index.build( &worker.m_buffer[ 0 ], worker.m_buffer.size() );
+    }
+    worker.pushNode( root );
+
+    char *current( &worker.m_buffer[ 0 ] );
+    char *last( current + worker.m_buffer.size() );
+    while( current < last ) {
+        current = worker.parseNextNode( current, last );
+        if( ddl_nullptr == current ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void OpenDDLParser::log( LogSeverity severity, const std::string &msg ) const {
+    if( isLogEnabled( severity ) ) {
+        m_logCallback( severity, msg );
+    }
+}
+
+void OpenDDLParser::closeTreeIndex() {
+    // the root and the nodes of an aborted parse are still on the stack
+    for( size_t i = 0; i < m_stack.size(); i++ ) {
+        DDLNode *node( m_stack[ i ] );
+        if( 0 != m_treeGeneration && m_treeGeneration == node->m_treeGeneration ) {
+            node->m_treeEnd = m_treeCount;
+        }
+    }
+    m_treeGeneration = 0;
+}
+
 bool OpenDDLParser::exportContext( Context *ctx, const std::string &filename ) {
     if( ddl_nullptr == ctx ) {
         return false;
@@ -234,6 +703,14 @@ bool OpenDDLParser::exportContext( Context *ctx, const std::string &filename ) {
 }
 
 char *OpenDDLParser::parseNextNode( char *in, char *end ) {
+    // the progress is reported before each structure, the callback can cancel the parsing
+    if( m_progressCallback && ddl_nullptr != in && !m_buffer.empty() && in >= &m_buffer[ 0 ] ) {
+        const size_t pos( in - &m_buffer[ 0 ] );
+        if( pos <= m_buffer.size() && !m_progressCallback( pos, m_buffer.size() ) ) {
+            return ddl_nullptr;
+        }
+    }
+
     in = parseHeader( in, end );
     in = parseStructure( in, end );
 
@@ -269,7 +746,7 @@ char *OpenDDLParser::parseHeader( char *in, char *end ) {
         if( ddl_nullptr != node ) {
             pushNode( node );
         } else {
-            std::cerr << "nullptr returned by creating DDLNode." << std::endl;
+            log( ddl_error_msg, "nullptr returned by creating DDLNode.\n" );
         }
 
 		Name *name(ddl_nullptr);
@@ -277,6 +754,7 @@ char *OpenDDLParser::parseHeader( char *in, char *end ) {
         if( ddl_nullptr != name && ddl_nullptr != node ) {
             const std::string nodeName( name->m_id->m_buffer );
             node->setName( nodeName );
+            node->setNameType( name->m_type );
         }
 
 		Property *first(ddl_nullptr);
@@ -289,7 +767,7 @@ char *OpenDDLParser::parseHeader( char *in, char *end ) {
 				in = lookForNextToken(in, end);
 
 				if (*in != Grammar::CommaSeparator[0] && *in != Grammar::ClosePropertyToken[0]) {
-					logInvalidTokenError(in, Grammar::ClosePropertyToken, m_logCallback);
+					logInvalidTokenError(in, end, Grammar::ClosePropertyToken, *this);
 					return ddl_nullptr;
 				}
 
@@ -310,6 +788,12 @@ char *OpenDDLParser::parseHeader( char *in, char *end ) {
 		if (ddl_nullptr != first && ddl_nullptr != node) {
 			node->setProperties(first);
 		}
+
+        if( ddl_nullptr != m_eventHandler && ddl_nullptr != node ) {
+            if( !m_eventHandler->onStructureBegin( node, getStructureLevel() ) ) {
+                return ddl_nullptr;
+            }
+        }
     }
 
     return in;
@@ -323,17 +807,33 @@ char *OpenDDLParser::parseStructure( char *in, char *end ) {
     bool error( false );
     in = lookForNextToken( in, end );
     if( *in == '{' ) {
-        // loop over all children ( data and nodes )
-        do {
-            in = parseStructureBody( in, end, error );
-            if(in == ddl_nullptr){
+        if( isLazyStructure( in ) ) {
+            // skip the body, it will be parsed on the first access
+            char *closing( findClosingBracket( in, end ) );
+            if( closing == end ) {
+                logInvalidTokenError( in, end, Grammar::CloseBracketToken, *this );
                 return ddl_nullptr;
             }
-        } while ( *in != '}' );
+            DDLNode *node( top() );
+            node->m_lazyParser = this;
+            node->m_lazyBegin = in - &m_buffer[ 0 ];
+            node->m_lazyEnd = ( closing + 1 ) - &m_buffer[ 0 ];
+            // the types of the skipped body are unknown
+            node->addSubtreeTypeMask( ~static_cast<uint64>( 0 ) );
+            in = closing;
+        } else {
+            // loop over all children ( data and nodes )
+            do {
+                in = parseStructureBody( in, end, error );
+                if(in == ddl_nullptr){
+                    return ddl_nullptr;
+                }
+            } while ( *in != '}' );
+        }
         in++;
     } else {
         in++;
-        logInvalidTokenError( in, std::string( Grammar::OpenBracketToken ), m_logCallback );
+        logInvalidTokenError( in, end, Grammar::OpenBracketToken, *this );
         error = true;
         return ddl_nullptr;
     }
@@ -341,7 +841,17 @@ char *OpenDDLParser::parseStructure( char *in, char *end ) {
 
     // pop node from stack after successful parsing
     if( !error ) {
-        popNode();
+        const size_t level( getStructureLevel() );
+        DDLNode *node( popNode() );
+        if( ddl_nullptr != m_eventHandler && ddl_nullptr != node ) {
+            if( !m_eventHandler->onStructureEnd( node, level ) ) {
+                return ddl_nullptr;
+            }
+        }
+        if( m_streaming && ddl_nullptr != node && getRoot() != node ) {
+            node->detachParent();
+            delete node;
+        }
     }
 
     return in;
@@ -387,23 +897,36 @@ char *OpenDDLParser::parseStructureBody( char *in, char *end, bool &error ) {
             Reference *refs( ddl_nullptr );
             DataArrayList *dtArrayList( ddl_nullptr );
             Value *values( ddl_nullptr );
+            const bool indexed( isIndexed( in, type ) );
             if( 1 == arrayLen ) {
                 size_t numRefs( 0 ), numValues( 0 );
-                in = parseDataList( in, end, type, &values, numValues, &refs, numRefs );
+                if( indexed ) {
+                    in = parseIndexedDataList( in, end, type, &values, numValues );
+                } else if( isParallelData( type ) ) {
+                    in = parseParallelDataList( in, end, type, &values, numValues );
+                } else {
+                    in = parseDataList( in, end, type, &values, numValues, &refs, numRefs );
+                }
                 setNodeValues( top(), values );
                 setNodeReferences( top(), refs );
             } else if( arrayLen > 1 ) {
-                in = parseDataArrayList( in, end, type, &dtArrayList );
+                if( indexed ) {
+                    in = parseIndexedDataArrayList( in, end, type, &dtArrayList );
+                } else if( isParallelData( type ) ) {
+                    in = parseParallelDataArrayList( in, end, type, &dtArrayList );
+                } else {
+                    in = parseDataArrayList( in, end, type, &dtArrayList );
+                }
                 setNodeDataArrayList( top(), dtArrayList );
             } else {
-                std::cerr << "0 for array is invalid." << std::endl;
+                log( ddl_error_msg, "0 for array is invalid.\n" );
                 error = true;
             }
         }
 
         in = lookForNextToken( in, end );
         if( *in != '}' ) {
-            logInvalidTokenError( in, std::string( Grammar::CloseBracketToken ), m_logCallback );
+            logInvalidTokenError( in, end, Grammar::CloseBracketToken, *this );
             return ddl_nullptr;
         } else {
             //in++;
@@ -416,11 +939,110 @@ char *OpenDDLParser::parseStructureBody( char *in, char *end, bool &error ) {
     return in;
 }
 
+bool OpenDDLParser::isLazyStructure( const char *in ) const {
+    if( !m_lazy || m_streaming || m_buffer.empty() || m_stack.size() < 2 ) {
+        return false;
+    }
+
+    // only structures of our own buffer can be parsed later on
+    if( in < &m_buffer[ 0 ] || in >= &m_buffer[ 0 ] + m_buffer.size() ) {
+        return false;
+    }
+
+    const size_t level( m_stack.size() - 1 + m_levelOffset );
+    return level >= m_lazyDepth;
+}
+
+bool OpenDDLParser::isIndexed( const char *in, Value::ValueType type ) const {
+    if( !m_useIndex || !m_index.contains( in ) ) {
+        return false;
+    }
+
+    return ( isIntegerType( type ) || isUnsignedIntegerType( type ) || Value::ddl_half == type ||
+             Value::ddl_float == type || Value::ddl_double == type );
+}
+
+char *OpenDDLParser::findClosingBracket( char *in, char *end ) const {
+    if( !m_index.contains( in ) ) {
+        return findMatchingBracket( in, end );
+    }
+
+    const size_t idx( m_index.find( in - m_index.getBuffer() ) );
+    if( StructuralIndex::InvalidIndex == idx || m_index.getPosition( idx ) != static_cast<size_t>( in - m_index.getBuffer() ) ) {
+        return findMatchingBracket( in, end );
+    }
+
+    const size_t match( m_index.getMatch( idx ) );
+    if( StructuralIndex::InvalidIndex == match ) {
+        return end;
+    }
+
+    return in + ( m_index.getPosition( match ) - m_index.getPosition( idx ) );
+}
+
+bool OpenDDLParser::materializeNode( DDLNode *node ) {
+    if( ddl_nullptr == node || this != node->m_lazyParser ) {
+        return false;
+    }
+
+    if( node->m_lazyEnd > m_buffer.size() ) {
+        node->m_lazyParser = ddl_nullptr;
+        return false;
+    }
+
+    size_t level( 0 );
+    for( DDLNode *parent( node->getParent() ); ddl_nullptr != parent; parent = parent->getParent() ) {
+        ++level;
+    }
+
+    // parse the body with an own stack, nested structures will be skipped again. The new children
+    // are not numbered, the indices of the tree are already closed.
+    DDLNodeStack stack;
+    m_stack.swap( stack );
+    const size_t treeGeneration( m_treeGeneration );
+    m_treeGeneration = 0;
+    OpenDDLEventHandler *eventHandler( m_eventHandler );
+    m_eventHandler = ddl_nullptr;
+    const size_t levelOffset( m_levelOffset );
+    m_levelOffset = level;
+    pushNode( node );
+
+    char *in( &m_buffer[ node->m_lazyBegin ] );
+    char *end( &m_buffer[ 0 ] + node->m_lazyEnd );
+    bool error( false );
+    do {
+        in = parseStructureBody( in, end, error );
+    } while( ddl_nullptr != in && in != end && '}' != *in );
+
+    m_stack.swap( stack );
+    m_levelOffset = levelOffset;
+    m_treeGeneration = treeGeneration;
+    m_eventHandler = eventHandler;
+
+    // other threads see the node as materialized when its body is complete
+    node->m_lazyParser = ddl_nullptr;
+
+    return ( ddl_nullptr != in && !error );
+}
+
+size_t OpenDDLParser::getStructureLevel() const {
+    // the root is the first node on the stack
+    if( m_stack.size() < 2 ) {
+        return m_levelOffset;
+    }
+
+    return m_stack.size() - 2 + m_levelOffset;
+}
+
 void OpenDDLParser::pushNode( DDLNode *node ) {
     if( ddl_nullptr == node ) {
         return;
     }
 
+    if( 0 != m_treeGeneration ) {
+        node->m_treeIdx = m_treeCount++;
+        node->m_treeGeneration = m_treeGeneration;
+    }
     m_stack.push_back( node );
 }
 
@@ -431,6 +1053,9 @@ DDLNode *OpenDDLParser::popNode() {
 
     DDLNode *topNode( top() );
     m_stack.pop_back();
+    if( 0 != m_treeGeneration && m_treeGeneration == topNode->m_treeGeneration ) {
+        topNode->m_treeEnd = m_treeCount;
+    }
 
     return topNode;
 }
@@ -473,7 +1098,7 @@ void OpenDDLParser::normalizeBuffer( std::vector<char> &buffer) {
             if( isComment<char>( c, end ) ) {
                 ++readIdx;
                 // skip the comment and the rest of the line
-                while( !isEndofLine( buffer[ readIdx ] ) ) {
+                while( readIdx < len && !isEndofLine( buffer[ readIdx ] ) ) {
                     ++readIdx;
                 }
             }
@@ -529,7 +1154,7 @@ char *OpenDDLParser::parseIdentifier( char *in, char *end, Text **id ) {
     // get size of id
     size_t idLen( 0 );
     char *start( in );
-    while( !isSeparator( *in ) && !isNewLine( *in ) && ( in != end ) && *in != Grammar::OpenPropertyToken[ 0 ] && *in != Grammar::ClosePropertyToken[ 0 ] && *in != '$' ) {
+    while( !isSeparator( *in ) && !isNewLine( *in ) && ( in != end ) && *in != Grammar::OpenPropertyToken[ 0 ] && *in != Grammar::ClosePropertyToken[ 0 ] && *in != '$' && *in != '=' ) {
         ++in;
         ++idLen;
     }
@@ -702,6 +1327,32 @@ char *OpenDDLParser::parseIntegerLiteral( char *in, char *end, Value **integer,
     return in;
 }
 
+// a hex literal in a floating point list holds the bits of the value, so nan and infinity
+// can be written
+static Value *createFloatFromBits( const char *start, Value::ValueType floatType ) {
+    const uint64 bits( ::strtoull( start + 2, ddl_nullptr, 16 ) );
+    Value *value( ddl_nullptr );
+    if( Value::ddl_double == floatType ) {
+        double d;
+        ::memcpy( &d, &bits, sizeof( double ) );
+        value = ValueAllocator::allocPrimData( Value::ddl_double );
+        value->setDouble( d );
+        return value;
+    }
+
+    float f;
+    if( Value::ddl_half == floatType ) {
+        f = halfToFloat( static_cast<uint16>( bits ) );
+    } else {
+        const uint32 floatBits( static_cast<uint32>( bits ) );
+        ::memcpy( &f, &floatBits, sizeof( float ) );
+    }
+    value = ValueAllocator::allocPrimData( Value::ddl_float );
+    value->setFloat( f );
+
+    return value;
+}
+
 char *OpenDDLParser::parseFloatingLiteral( char *in, char *end, Value **floating, Value::ValueType floatType) {
     *floating = ddl_nullptr;
     if( ddl_nullptr == in || in == end ) {
@@ -717,7 +1368,7 @@ char *OpenDDLParser::parseFloatingLiteral( char *in, char *end, Value **floating
     // parse the float value
     bool ok( false );
     if ( isHexLiteral( start, end ) ) {
-        parseHexaLiteral( start, end, floating );
+        *floating = createFloatFromBits( start, floatType );
         return in;
     }
 
@@ -842,7 +1493,7 @@ char *OpenDDLParser::parseProperty( char *in, char *end, Property **prop ) {
         in = lookForNextToken( in, end );
         if( *in == '=' ) {
             in++;
-            in = getNextToken( in, end );
+            in = lookForNextToken( in, end );
             Value *primData( ddl_nullptr );
             if( isInteger( in, end ) ) {
                 in = parseIntegerLiteral( in, end, &primData );
@@ -1001,6 +1652,337 @@ char *OpenDDLParser::parseDataArrayList( char *in, char *end,Value::ValueType ty
     return in;
 }
 
+static Value *parseIndexedNumber( char *start, char *stop, Value::ValueType type ) {
+    while( start != stop && isSpace( *start ) ) {
+        ++start;
+    }
+    if( start == stop ) {
+        return ddl_nullptr;
+    }
+
+    Value *value( ddl_nullptr );
+    char *numEnd( start );
+    const bool hex( isHexLiteral( start, stop ) );
+    if( Value::ddl_half == type || Value::ddl_float == type || Value::ddl_double == type ) {
+        if( hex ) {
+            return createFloatFromBits( start, type );
+        }
+        const double d( ::strtod( start, &numEnd ) );
+        if( numEnd == start ) {
+            return ddl_nullptr;
+        }
+        if( Value::ddl_double == type ) {
+            value = ValueAllocator::allocPrimData( Value::ddl_double );
+            value->setDouble( d );
+        } else {
+            value = ValueAllocator::allocPrimData( Value::ddl_float );
+            value->setFloat( static_cast<float>( d ) );
+        }
+        return value;
+    }
+
+    const int base( hex ? 16 : 10 );
+    if( hex ) {
+        start += 2;
+    }
+    if( isIntegerType( type ) ) {
+        const int64 i( static_cast<int64>( ::strtoll( start, &numEnd, base ) ) );
+        if( numEnd == start ) {
+            return ddl_nullptr;
+        }
+        value = ValueAllocator::allocPrimData( type );
+        switch( type ) {
+            case Value::ddl_int8:
+                value->setInt8( static_cast<int8>( i ) );
+                break;
+            case Value::ddl_int16:
+                value->setInt16( static_cast<int16>( i ) );
+                break;
+            case Value::ddl_int32:
+                value->setInt32( static_cast<int32>( i ) );
+                break;
+            default:
+                value->setInt64( i );
+                break;
+        }
+    } else {
+        const uint64 u( static_cast<uint64>( ::strtoull( start, &numEnd, base ) ) );
+        if( numEnd == start ) {
+            return ddl_nullptr;
+        }
+        value = ValueAllocator::allocPrimData( type );
+        switch( type ) {
+            case Value::ddl_unsigned_int8:
+                value->setUnsignedInt8( static_cast<uint8>( u ) );
+                break;
+            case Value::ddl_unsigned_int16:
+                value->setUnsignedInt16( static_cast<uint16>( u ) );
+                break;
+            case Value::ddl_unsigned_int32:
+                value->setUnsignedInt32( static_cast<uint32>( u ) );
+                break;
+            default:
+                value->setUnsignedInt64( u );
+                break;
+        }
+    }
+
+    return value;
+}
+
+// the minimum size of a chunk of a data list which is decoded by an own task
+static const size_t MinDataChunkSize = 64 * 1024;
+
+// splits [begin, end) into at most count ranges, each range but the last one ends with the
+// separator. Returns the bounds of the ranges.
+static void splitAtSeparators( char *begin, char *end, size_t count, char separator, std::vector<char*> &bounds ) {
+    bounds.clear();
+    bounds.push_back( begin );
+    const size_t len( end - begin );
+    for( size_t i = 1; i < count; i++ ) {
+        char *pos( std::max( begin + len * i / count, bounds.back() ) );
+        while( pos != end && separator != *pos ) {
+            ++pos;
+        }
+        if( pos == end ) {
+            break;
+        }
+        bounds.push_back( pos + 1 );
+    }
+    bounds.push_back( end );
+}
+
+// decodes the comma separated numbers of [begin, end) into consecutive slots, the slot of an
+// empty element stays empty
+static void decodeNumbers( char *begin, char *end, Value::ValueType type, Value **slots ) {
+    char *start( begin );
+    for( char *c = begin; ; ++c ) {
+        if( c == end || ',' == *c ) {
+            *slots++ = parseIndexedNumber( start, c, type );
+            start = c + 1;
+        }
+        if( c == end ) {
+            break;
+        }
+    }
+}
+
+// links the values of the slots in their order, empty slots are skipped
+static Value *linkValues( const std::vector<Value*> &slots, size_t &numValues ) {
+    numValues = 0;
+    Value *first( ddl_nullptr ), *prev( ddl_nullptr );
+    for( size_t i = 0; i < slots.size(); i++ ) {
+        Value *current( slots[ i ] );
+        if( ddl_nullptr == current ) {
+            continue;
+        }
+        if( ddl_nullptr == first ) {
+            first = current;
+        } else {
+            prev->setNext( current );
+        }
+        prev = current;
+        ++numValues;
+    }
+
+    return first;
+}
+
+Value *OpenDDLParser::parseIndexedValues( size_t open, size_t close, Value::ValueType type, size_t &numValues ) {
+    numValues = 0;
+    Value *first( ddl_nullptr ), *prev( ddl_nullptr );
+    char *base( &m_buffer[ 0 ] );
+    size_t start( m_index.getPosition( open ) + 1 );
+    for( size_t i = open + 1; i <= close; ++i ) {
+        // every separator ends the previous element
+        const size_t stop( m_index.getPosition( i ) );
+        Value *current( parseIndexedNumber( base + start, base + stop, type ) );
+        if( ddl_nullptr != current ) {
+            if( ddl_nullptr == first ) {
+                first = current;
+            } else {
+                prev->setNext( current );
+            }
+            prev = current;
+            ++numValues;
+        }
+        start = stop + 1;
+    }
+
+    return first;
+}
+
+char *OpenDDLParser::parseIndexedDataList( char *in, char *end, Value::ValueType type, Value **data, size_t &numValues ) {
+    *data = ddl_nullptr;
+    numValues = 0;
+    in = lookForNextToken( in, end );
+    const size_t open( m_index.find( in - &m_buffer[ 0 ] ) );
+    if( StructuralIndex::InvalidIndex == open || m_index.getPosition( open ) != static_cast<size_t>( in - &m_buffer[ 0 ] ) ||
+            StructuralIndex::InvalidIndex == m_index.getMatch( open ) ) {
+        Reference *refs( ddl_nullptr );
+        size_t numRefs( 0 );
+        return parseDataList( in, end, type, data, numValues, &refs, numRefs );
+    }
+
+    const size_t close( m_index.getMatch( open ) );
+    *data = parseIndexedValues( open, close, type, numValues );
+
+    return &m_buffer[ 0 ] + m_index.getPosition( close ) + 1;
+}
+
+char *OpenDDLParser::parseIndexedDataArrayList( char *in, char *end, Value::ValueType type, DataArrayList **dataArrayList ) {
+    *dataArrayList = ddl_nullptr;
+    in = lookForNextToken( in, end );
+    const size_t open( m_index.find( in - &m_buffer[ 0 ] ) );
+    if( StructuralIndex::InvalidIndex == open || m_index.getPosition( open ) != static_cast<size_t>( in - &m_buffer[ 0 ] ) ||
+            StructuralIndex::InvalidIndex == m_index.getMatch( open ) ) {
+        return parseDataArrayList( in, end, type, dataArrayList );
+    }
+
+    const size_t close( m_index.getMatch( open ) );
+    DataArrayList *prev( ddl_nullptr );
+    size_t i( open + 1 );
+    while( i < close ) {
+        const size_t subClose( m_index.getMatch( i ) );
+        if( '{' != m_index.getToken( i ) || StructuralIndex::InvalidIndex == subClose ) {
+            ++i;
+            continue;
+        }
+
+        size_t numValues( 0 );
+        Value *values( parseIndexedValues( i, subClose, type, numValues ) );
+        if( ddl_nullptr != values ) {
+            DataArrayList *current( createDataArrayList( values, numValues, ddl_nullptr, 0 ) );
+            if( ddl_nullptr == prev ) {
+                *dataArrayList = current;
+            } else {
+                prev->m_next = current;
+            }
+            prev = current;
+        }
+        i = subClose + 1;
+    }
+
+    return &m_buffer[ 0 ] + m_index.getPosition( close ) + 1;
+}
+
+ThreadPool *OpenDDLParser::getPool() {
+    if( ddl_nullptr == m_pool ) {
+        m_pool = new ThreadPool( m_numThreads );
+    }
+
+    return m_pool;
+}
+
+bool OpenDDLParser::isParallelData( Value::ValueType type ) const {
+    if( !m_parallel ) {
+        return false;
+    }
+
+    return ( isIntegerType( type ) || isUnsignedIntegerType( type ) || Value::ddl_half == type ||
+             Value::ddl_float == type || Value::ddl_double == type );
+}
+
+size_t OpenDDLParser::getNumDataChunks( size_t len ) {
+    if( len < m_parallelThreshold ) {
+        return 1;
+    }
+
+    return std::min( getPool()->getNumThreads() * 4, std::max<size_t>( len / MinDataChunkSize, 1 ) );
+}
+
+char *OpenDDLParser::parseParallelDataList( char *in, char *end, Value::ValueType type, Value **data, size_t &numValues ) {
+    *data = ddl_nullptr;
+    numValues = 0;
+    in = lookForNextToken( in, end );
+    char *closing( findClosingBracket( in, end ) );
+    const size_t numChunks( closing == end ? 1 : getNumDataChunks( closing - in ) );
+    if( 1 == numChunks ) {
+        Reference *refs( ddl_nullptr );
+        size_t numRefs( 0 );
+        return parseDataList( in, end, type, data, numValues, &refs, numRefs );
+    }
+
+    // the elements of a chunk start behind the commas of all former chunks
+    std::vector<char*> bounds;
+    splitAtSeparators( in + 1, closing, numChunks, ',', bounds );
+    const size_t count( bounds.size() - 1 );
+    std::vector<size_t> offsets( count + 1, 0 );
+    getPool()->parallelFor( count, [&]( size_t i ) {
+        offsets[ i + 1 ] = std::count( bounds[ i ], bounds[ i + 1 ], ',' );
+    } );
+    for( size_t i = 0; i < count; i++ ) {
+        offsets[ i + 1 ] += offsets[ i ];
+    }
+
+    std::vector<Value*> slots( offsets[ count ] + 1, ddl_nullptr );
+    getPool()->parallelFor( count, [&]( size_t i ) {
+        // the comma at the end of a chunk belongs to the next one
+        char *chunkEnd( i + 1 < count ? bounds[ i + 1 ] - 1 : bounds[ i + 1 ] );
+        decodeNumbers( bounds[ i ], chunkEnd, type, &slots[ offsets[ i ] ] );
+    } );
+    *data = linkValues( slots, numValues );
+
+    return closing + 1;
+}
+
+char *OpenDDLParser::parseParallelDataArrayList( char *in, char *end, Value::ValueType type, DataArrayList **dataArrayList ) {
+    *dataArrayList = ddl_nullptr;
+    in = lookForNextToken( in, end );
+    char *closing( findClosingBracket( in, end ) );
+    const size_t numChunks( closing == end ? 1 : getNumDataChunks( closing - in ) );
+    if( 1 == numChunks ) {
+        return parseDataArrayList( in, end, type, dataArrayList );
+    }
+
+    // the chunks end behind a sub-list, each one gets linked on its own
+    std::vector<char*> bounds;
+    splitAtSeparators( in + 1, closing, numChunks, '}', bounds );
+    const size_t count( bounds.size() - 1 );
+    std::vector<DataArrayList*> firsts( count, ddl_nullptr ), lasts( count, ddl_nullptr );
+    getPool()->parallelFor( count, [&]( size_t i ) {
+        std::vector<Value*> slots;
+        char *pos( bounds[ i ] );
+        for( ;; ) {
+            char *open( std::find( pos, bounds[ i + 1 ], '{' ) );
+            char *close( std::find( open, bounds[ i + 1 ], '}' ) );
+            if( close == bounds[ i + 1 ] ) {
+                break;
+            }
+
+            slots.assign( std::count( open + 1, close, ',' ) + 1, ddl_nullptr );
+            decodeNumbers( open + 1, close, type, &slots[ 0 ] );
+            size_t numValues( 0 );
+            Value *values( linkValues( slots, numValues ) );
+            if( ddl_nullptr != values ) {
+                DataArrayList *current( createDataArrayList( values, numValues, ddl_nullptr, 0 ) );
+                if( ddl_nullptr == lasts[ i ] ) {
+                    firsts[ i ] = current;
+                } else {
+                    lasts[ i ]->m_next = current;
+                }
+                lasts[ i ] = current;
+            }
+            pos = close + 1;
+        }
+    } );
+
+    DataArrayList *prev( ddl_nullptr );
+    for( size_t i = 0; i < count; i++ ) {
+        if( ddl_nullptr == firsts[ i ] ) {
+            continue;
+        }
+        if( ddl_nullptr == prev ) {
+            *dataArrayList = firsts[ i ];
+        } else {
+            prev->m_next = firsts[ i ];
+        }
+        prev = lasts[ i ];
+    }
+
+    return closing + 1;
+}
+
 const char *OpenDDLParser::getVersion() {
     return Version;
 }
@@ -0,0 +1,465 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <openddlparser/OpenDDLQuery.h>
+#include <openddlparser/OpenDDLParser.h>
+
+#include <set>
+#include <stdlib.h>
+
+BEGIN_ODDLPARSER_NS
+
+static const char *skipBlanks( const char *in, const char *end ) {
+    while( in != end && isSpace( *in ) ) {
+        in++;
+    }
+    return in;
+}
+
+static bool isQueryIdentifierChar( char c ) {
+    return isCharacter( c ) || isNumeric( c ) || '_' == c || '.' == c;
+}
+
+static Value::ValueType getPrimitiveType( const std::string &token ) {
+    for( int i = 0; i < Value::ddl_types_max; i++ ) {
+        if( token == getTypeToken( static_cast<Value::ValueType>( i ) ) ) {
+            return static_cast<Value::ValueType>( i );
+        }
+    }
+    return Value::ddl_none;
+}
+
+static bool getIntegerValue( const Value *val, int64 &result ) {
+    switch( val->m_type ) {
+        case Value::ddl_int8:
+            result = static_cast<int8>( *val->m_data );
+            return true;
+        case Value::ddl_int16: {
+                int16 i;
+                ::memcpy( &i, val->m_data, sizeof( int16 ) );
+                result = i;
+            }
+            return true;
+        case Value::ddl_int32: {
+                int32 i;
+                ::memcpy( &i, val->m_data, sizeof( int32 ) );
+                result = i;
+            }
+            return true;
+        case Value::ddl_int64:
+            ::memcpy( &result, val->m_data, sizeof( int64 ) );
+            return true;
+        case Value::ddl_unsigned_int8:
+            result = val->getUnsignedInt8();
+            return true;
+        case Value::ddl_unsigned_int16:
+            result = val->getUnsignedInt16();
+            return true;
+        case Value::ddl_unsigned_int32:
+            result = val->getUnsignedInt32();
+            return true;
+        case Value::ddl_unsigned_int64:
+            result = static_cast<int64>( val->getUnsignedInt64() );
+            return true;
+        default:
+            break;
+    }
+
+    return false;
+}
+
+static bool getFloatingValue( const Value *val, double &result ) {
+    int64 i( 0 );
+    if( getIntegerValue( val, i ) ) {
+        result = static_cast<double>( i );
+        return true;
+    }
+
+    if( Value::ddl_float == val->m_type ) {
+        result = val->getFloat();
+        return true;
+    } else if( Value::ddl_double == val->m_type ) {
+        result = val->getDouble();
+        return true;
+    }
+
+    return false;
+}
+
+static Value::ValueType getDataType( const DDLNode *node ) {
+    const Value *val( node->getValue() );
+    if( ddl_nullptr != val ) {
+        return val->m_type;
+    }
+
+    const DataArrayList *dtArrayList( node->getDataArrayList() );
+    if( ddl_nullptr != dtArrayList && ddl_nullptr != dtArrayList->m_dataList ) {
+        return dtArrayList->m_dataList->m_type;
+    }
+
+    if( ddl_nullptr != node->getReferences() ) {
+        return Value::ddl_ref;
+    }
+
+    return Value::ddl_none;
+}
+
+static bool parseLiteral( const char *&in, const char *end, std::string &literal, bool &quoted ) {
+    literal.clear();
+    quoted = false;
+    in = skipBlanks( in, end );
+    if( in == end ) {
+        return false;
+    }
+
+    if( '\"' == *in ) {
+        quoted = true;
+        in++;
+        const char *start( in );
+        while( in != end && '\"' != *in ) {
+            in++;
+        }
+        if( in == end ) {
+            return false;
+        }
+        literal.assign( start, in );
+        in++;
+        return true;
+    }
+
+    const char *start( in );
+    while( in != end && ']' != *in && !isSpace( *in ) ) {
+        in++;
+    }
+    literal.assign( start, in );
+
+    return !literal.empty();
+}
+
+OpenDDLQuery::Predicate::Predicate()
+: m_key()
+, m_hasValue( false )
+, m_type( Value::ddl_none )
+, m_string()
+, m_int( 0 )
+, m_float( 0.0 )
+, m_bool( false ) {
+    // empty
+}
+
+bool OpenDDLQuery::Predicate::matches( const DDLNode *node ) const {
+    const Property *prop( node->getProperties() );
+    while( ddl_nullptr != prop ) {
+        if( ddl_nullptr != prop->m_key && *prop->m_key == m_key ) {
+            break;
+        }
+        prop = prop->m_next;
+    }
+
+    if( ddl_nullptr == prop ) {
+        return false;
+    }
+
+    if( !m_hasValue ) {
+        return true;
+    }
+
+    if( Value::ddl_ref == m_type ) {
+        if( ddl_nullptr == prop->m_ref ) {
+            return false;
+        }
+        for( size_t i = 0; i < prop->m_ref->m_numRefs; i++ ) {
+            const Name *name( prop->m_ref->m_referencedName[ i ] );
+            if( ddl_nullptr != name && ddl_nullptr != name->m_id && *name->m_id == m_string ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const Value *val( prop->m_value );
+    if( ddl_nullptr == val ) {
+        return false;
+    }
+
+    switch( m_type ) {
+        case Value::ddl_string:
+            return Value::ddl_string == val->m_type && m_string == val->getString();
+        case Value::ddl_bool:
+            return Value::ddl_bool == val->m_type && m_bool == ( *val->m_data == 1 );
+        case Value::ddl_int64: {
+                int64 i( 0 );
+                if( getIntegerValue( val, i ) ) {
+                    return i == m_int;
+                }
+                double d( 0.0 );
+                if( getFloatingValue( val, d ) ) {
+                    return d == m_float;
+                }
+            }
+            break;
+        case Value::ddl_double: {
+                double d( 0.0 );
+                if( getFloatingValue( val, d ) ) {
+                    return d == m_float || static_cast<float>( d ) == static_cast<float>( m_float );
+                }
+            }
+            break;
+        default:
+            break;
+    }
+
+    return false;
+}
+
+OpenDDLQuery::Step::Step()
+: m_type()
+, m_typeMask( 0 )
+, m_anyType( false )
+, m_descendants( false )
+, m_dataType( Value::ddl_none )
+, m_predicates() {
+    // empty
+}
+
+bool OpenDDLQuery::Step::matches( const DDLNode *node ) const {
+    if( Value::ddl_none != m_dataType ) {
+        if( getDataType( node ) != m_dataType ) {
+            return false;
+        }
+    } else if( !m_anyType && node->getType() != m_type ) {
+        return false;
+    }
+
+    for( size_t i = 0; i < m_predicates.size(); i++ ) {
+        if( !m_predicates[ i ].matches( node ) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+OpenDDLQuery::OpenDDLQuery()
+: m_expression()
+, m_steps()
+, m_valid( false ) {
+    // empty
+}
+
+OpenDDLQuery::OpenDDLQuery( const std::string &expression )
+: m_expression()
+, m_steps()
+, m_valid( false ) {
+    compile( expression );
+}
+
+OpenDDLQuery::~OpenDDLQuery() {
+    // empty
+}
+
+bool OpenDDLQuery::compile( const std::string &expression ) {
+    m_expression = expression;
+    m_steps.clear();
+    m_valid = false;
+    if( expression.empty() ) {
+        return false;
+    }
+
+    const char *in( expression.c_str() );
+    const char *end( in + expression.size() );
+    while( in != end ) {
+        Step step;
+        in = skipBlanks( in, end );
+        if( in != end && '/' == *in ) {
+            in++;
+            if( in != end && '/' == *in ) {
+                step.m_descendants = true;
+                in++;
+            }
+        } else if( !m_steps.empty() ) {
+            return false;
+        }
+
+        // a primitive data type is only allowed as the last step
+        if( !m_steps.empty() && Value::ddl_none != m_steps.back().m_dataType ) {
+            return false;
+        }
+
+        in = skipBlanks( in, end );
+        if( in != end && '*' == *in ) {
+            step.m_anyType = true;
+            in++;
+        } else {
+            const char *start( in );
+            while( in != end && isQueryIdentifierChar( *in ) ) {
+                in++;
+            }
+            if( start == in ) {
+                return false;
+            }
+            step.m_type.assign( start, in );
+            step.m_typeMask = DDLNode::getTypeMask( step.m_type );
+            step.m_dataType = getPrimitiveType( step.m_type );
+        }
+
+        // parse the predicates
+        in = skipBlanks( in, end );
+        while( in != end && '[' == *in ) {
+            Predicate predicate;
+            in = skipBlanks( in + 1, end );
+            const char *start( in );
+            while( in != end && isQueryIdentifierChar( *in ) ) {
+                in++;
+            }
+            if( start == in ) {
+                return false;
+            }
+            predicate.m_key.assign( start, in );
+            in = skipBlanks( in, end );
+            if( in != end && '=' == *in ) {
+                std::string literal;
+                bool quoted( false );
+                in++;
+                if( !parseLiteral( in, end, literal, quoted ) ) {
+                    return false;
+                }
+                predicate.m_hasValue = true;
+                if( quoted ) {
+                    predicate.m_type = Value::ddl_string;
+                    predicate.m_string = literal;
+                } else if( '$' == literal[ 0 ] || '%' == literal[ 0 ] ) {
+                    predicate.m_type = Value::ddl_ref;
+                    predicate.m_string = literal.substr( 1 );
+                } else if( "true" == literal || "false" == literal ) {
+                    predicate.m_type = Value::ddl_bool;
+                    predicate.m_bool = ( "true" == literal );
+                } else {
+                    const char *literalEnd( literal.c_str() + literal.size() );
+                    if( isInteger( literal.c_str(), literalEnd ) ) {
+                        predicate.m_type = Value::ddl_int64;
+                        predicate.m_int = static_cast<int64>( ::strtoll( literal.c_str(), ddl_nullptr, 10 ) );
+                        predicate.m_float = static_cast<double>( predicate.m_int );
+                    } else if( isFloat( literal.c_str(), literalEnd ) ) {
+                        predicate.m_type = Value::ddl_double;
+                        predicate.m_float = ::atof( literal.c_str() );
+                    } else {
+                        return false;
+                    }
+                }
+                in = skipBlanks( in, end );
+            }
+            if( in == end || ']' != *in ) {
+                return false;
+            }
+            in = skipBlanks( in + 1, end );
+            step.m_predicates.push_back( predicate );
+        }
+
+        m_steps.push_back( step );
+    }
+
+    m_valid = !m_steps.empty();
+
+    return m_valid;
+}
+
+bool OpenDDLQuery::isValid() const {
+    return m_valid;
+}
+
+const std::string &OpenDDLQuery::getExpression() const {
+    return m_expression;
+}
+
+void OpenDDLQuery::collectStep( const Step &step, const DDLNode *node, DDLNode::DllNodeList &result ) const {
+    const DDLNode::DllNodeList &childs( node->getChildNodeList() );
+    for( size_t i = 0; i < childs.size(); i++ ) {
+        DDLNode *child( childs[ i ] );
+        if( ddl_nullptr == child ) {
+            continue;
+        }
+        // skip subtrees which cannot contain the wanted type
+        if( step.m_descendants && !step.m_anyType && Value::ddl_none == step.m_dataType
+                && ( child->getSubtreeTypeMask() & step.m_typeMask ) != step.m_typeMask ) {
+            continue;
+        }
+        if( step.matches( child ) ) {
+            result.push_back( child );
+        }
+        if( step.m_descendants ) {
+            collectStep( step, child, result );
+        }
+    }
+}
+
+size_t OpenDDLQuery::execute( const DDLNode *root, DDLNode::DllNodeList &result ) const {
+    if( !m_valid || ddl_nullptr == root ) {
+        return 0;
+    }
+
+    DDLNode::DllNodeList current, next;
+    current.push_back( const_cast<DDLNode*>( root ) );
+    for( size_t i = 0; i < m_steps.size() && !current.empty(); i++ ) {
+        const Step &step( m_steps[ i ] );
+        next.clear();
+        if( Value::ddl_none != step.m_dataType && !step.m_descendants ) {
+            // a data type step filters the nodes found so far
+            for( size_t j = 0; j < current.size(); j++ ) {
+                if( step.matches( current[ j ] ) ) {
+                    next.push_back( current[ j ] );
+                }
+            }
+        } else {
+            for( size_t j = 0; j < current.size(); j++ ) {
+                collectStep( step, current[ j ], next );
+            }
+            // nested contexts can reach the same descendant more than once
+            if( step.m_descendants && current.size() > 1 ) {
+                std::set<DDLNode*> visited;
+                DDLNode::DllNodeList unique;
+                for( size_t j = 0; j < next.size(); j++ ) {
+                    if( visited.insert( next[ j ] ).second ) {
+                        unique.push_back( next[ j ] );
+                    }
+                }
+                next.swap( unique );
+            }
+        }
+        current.swap( next );
+    }
+
+    result.insert( result.end(), current.begin(), current.end() );
+
+    return current.size();
+}
+
+DDLNode *OpenDDLQuery::executeFirst( const DDLNode *root ) const {
+    DDLNode::DllNodeList result;
+    if( 0 == execute( root, result ) ) {
+        return ddl_nullptr;
+    }
+
+    return result[ 0 ];
+}
+
+END_ODDLPARSER_NS
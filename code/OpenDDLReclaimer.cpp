@@ -0,0 +1,111 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <openddlparser/OpenDDLReclaimer.h>
+
+BEGIN_ODDLPARSER_NS
+
+Reclaimer::Reclaimer()
+: m_thread()
+, m_mutex()
+, m_changed()
+, m_queue()
+, m_numPending( 0 )
+, m_stop( false ) {
+    m_thread = std::thread( &Reclaimer::reclaimerMain, this );
+}
+
+Reclaimer::~Reclaimer() {
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_stop = true;
+    }
+    m_changed.notify_all();
+    m_thread.join();
+}
+
+void Reclaimer::retire( DDLNode *node ) {
+    DDLNode::DllNodeList nodes;
+    DDLNode::takeSubtree( node, nodes );
+    retireNodes( nodes );
+}
+
+void Reclaimer::retire( Context *context ) {
+    if( ddl_nullptr == context ) {
+        return;
+    }
+
+    retire( context->m_root );
+    context->m_root = ddl_nullptr;
+}
+
+void Reclaimer::wait() {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    while( 0 != m_numPending ) {
+        m_changed.wait( lock );
+    }
+}
+
+bool Reclaimer::hasPending() const {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    return 0 != m_numPending;
+}
+
+void Reclaimer::retireNodes( DDLNode::DllNodeList &nodes ) {
+    if( nodes.empty() ) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_numPending += nodes.size();
+        m_queue.push_back( DDLNode::DllNodeList() );
+        m_queue.back().swap( nodes );
+    }
+    m_changed.notify_all();
+}
+
+void Reclaimer::reclaimerMain() {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    for( ;; ) {
+        while( !m_stop && m_queue.empty() ) {
+            m_changed.wait( lock );
+        }
+
+        // pending nodes are deleted before the thread stops
+        if( m_queue.empty() ) {
+            return;
+        }
+
+        DDLNode::DllNodeList nodes;
+        nodes.swap( m_queue.front() );
+        m_queue.pop_front();
+        const size_t numNodes( nodes.size() );
+        lock.unlock();
+        DDLNode::deleteNodes( nodes );
+        lock.lock();
+        m_numPending -= numNodes;
+        m_changed.notify_all();
+    }
+}
+
+END_ODDLPARSER_NS
@@ -0,0 +1,314 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <openddlparser/OpenDDLSnapshot.h>
+#include <openddlparser/DDLNode.h>
+#include <openddlparser/Value.h>
+
+#include <atomic>
+
+BEGIN_ODDLPARSER_NS
+
+static std::atomic<size_t> s_snapshotVersion( 0 );
+
+namespace {
+
+Text *copyText( const Text *text ) {
+    if( ddl_nullptr == text ) {
+        return ddl_nullptr;
+    }
+
+    return new Text( text->m_buffer, text->m_len );
+}
+
+Reference *copyReference( const Reference *ref ) {
+    if( ddl_nullptr == ref ) {
+        return ddl_nullptr;
+    }
+
+    // the names of a reference are copied with their ids
+    Reference *copy( new Reference );
+    if( 0 != ref->m_numRefs ) {
+        copy->m_numRefs = ref->m_numRefs;
+        copy->m_referencedName = new Name *[ ref->m_numRefs ];
+        for( size_t i = 0; i < ref->m_numRefs; i++ ) {
+            const Name *name( ref->m_referencedName[ i ] );
+            copy->m_referencedName[ i ] = new Name( name->m_type, copyText( name->m_id ) );
+        }
+    }
+
+    return copy;
+}
+
+void releaseReference( Reference *ref ) {
+    if( ddl_nullptr == ref ) {
+        return;
+    }
+
+    Name **names( ref->m_referencedName );
+    delete ref;
+    delete [] names;
+}
+
+Value *copyValues( const Value *value ) {
+    Value *first( ddl_nullptr ), *prev( ddl_nullptr );
+    for( ; ddl_nullptr != value; value = value->getNext() ) {
+        Value *current( ddl_nullptr );
+        if( Value::ddl_ref == value->m_type ) {
+            // copyPrimData shares the ids of the names, the snapshot needs its own ones
+            current = new Value( Value::ddl_ref );
+            current->m_size = value->m_size;
+            current->m_data = reinterpret_cast<unsigned char*>( copyReference( reinterpret_cast<const Reference*>( value->m_data ) ) );
+        } else {
+            current = ValueAllocator::copyPrimData( value );
+        }
+        if( ddl_nullptr == first ) {
+            first = current;
+        } else {
+            prev->setNext( current );
+        }
+        prev = current;
+    }
+
+    return first;
+}
+
+void releaseValues( Value *value ) {
+    while( ddl_nullptr != value ) {
+        // a value does not own its payload, the copies are freed here
+        Value *next( value->getNext() );
+        if( Value::ddl_ref == value->m_type ) {
+            releaseReference( reinterpret_cast<Reference*>( value->m_data ) );
+        } else {
+            delete [] value->m_data;
+        }
+        value->m_data = ddl_nullptr;
+        ValueAllocator::releasePrimData( &value );
+        value = next;
+    }
+}
+
+Property *copyProperties( const Property *prop ) {
+    Property *first( ddl_nullptr ), *prev( ddl_nullptr );
+    for( ; ddl_nullptr != prop; prop = prop->m_next ) {
+        Property *current( new Property( copyText( prop->m_key ) ) );
+        current->m_value = copyValues( prop->m_value );
+        current->m_ref = copyReference( prop->m_ref );
+        if( ddl_nullptr == first ) {
+            first = current;
+        } else {
+            prev->m_next = current;
+        }
+        prev = current;
+    }
+
+    return first;
+}
+
+void releaseProperties( Property *prop ) {
+    while( ddl_nullptr != prop ) {
+        Property *next( prop->m_next );
+        delete prop->m_key;
+        releaseValues( prop->m_value );
+        releaseReference( prop->m_ref );
+        delete prop;
+        prop = next;
+    }
+}
+
+DataArrayList *copyDataArrayList( const DataArrayList *list ) {
+    DataArrayList *first( ddl_nullptr ), *prev( ddl_nullptr );
+    for( ; ddl_nullptr != list; list = list->m_next ) {
+        DataArrayList *current( new DataArrayList );
+        current->m_numItems = list->m_numItems;
+        current->m_dataList = copyValues( list->m_dataList );
+        current->m_refs = copyReference( list->m_refs );
+        current->m_numRefs = list->m_numRefs;
+        if( ddl_nullptr == first ) {
+            first = current;
+        } else {
+            prev->m_next = current;
+        }
+        prev = current;
+    }
+
+    return first;
+}
+
+void releaseDataArrayList( DataArrayList *list ) {
+    while( ddl_nullptr != list ) {
+        DataArrayList *next( list->m_next );
+        releaseValues( list->m_dataList );
+        releaseReference( list->m_refs );
+        delete list;
+        list = next;
+    }
+}
+
+} // Namespace
+
+// the copied data of a node, shared by the snapshot nodes of unchanged node data
+struct SnapshotNode::Data {
+    std::string m_type;
+    std::string m_name;
+    NameType m_nameType;
+    Property *m_properties;
+    Value *m_value;
+    DataArrayList *m_dtArrayList;
+    Reference *m_references;
+
+    explicit Data( const DDLNode *node )
+    : m_type( node->getType() )
+    , m_name( node->getName() )
+    , m_nameType( node->getNameType() )
+    , m_properties( copyProperties( node->getProperties() ) )
+    , m_value( copyValues( node->getValue() ) )
+    , m_dtArrayList( copyDataArrayList( node->getDataArrayList() ) )
+    , m_references( copyReference( node->getReferences() ) ) {
+        // empty
+    }
+
+    ~Data() {
+        releaseProperties( m_properties );
+        releaseValues( m_value );
+        releaseDataArrayList( m_dtArrayList );
+        releaseReference( m_references );
+    }
+
+private:
+    Data( const Data & ) ddl_no_copy;
+    Data &operator = ( const Data & ) ddl_no_copy;
+};
+
+SnapshotNode::SnapshotNode()
+: m_data()
+, m_children() {
+    // empty
+}
+
+SnapshotNode::~SnapshotNode() {
+    // empty
+}
+
+const std::string &SnapshotNode::getType() const {
+    return m_data->m_type;
+}
+
+const std::string &SnapshotNode::getName() const {
+    return m_data->m_name;
+}
+
+NameType SnapshotNode::getNameType() const {
+    return m_data->m_nameType;
+}
+
+const Property *SnapshotNode::getProperties() const {
+    return m_data->m_properties;
+}
+
+const Property *SnapshotNode::findPropertyByName( const std::string &name ) const {
+    for( const Property *prop = m_data->m_properties; ddl_nullptr != prop; prop = prop->m_next ) {
+        if( ddl_nullptr != prop->m_key && *prop->m_key == name ) {
+            return prop;
+        }
+    }
+
+    return ddl_nullptr;
+}
+
+const Value *SnapshotNode::getValue() const {
+    return m_data->m_value;
+}
+
+const DataArrayList *SnapshotNode::getDataArrayList() const {
+    return m_data->m_dtArrayList;
+}
+
+const Reference *SnapshotNode::getReferences() const {
+    return m_data->m_references;
+}
+
+const std::vector<SnapshotNodePtr> &SnapshotNode::getChildNodeList() const {
+    return m_children;
+}
+
+Snapshot::Snapshot( const SnapshotNodePtr &root, size_t version )
+: m_root( root )
+, m_version( version ) {
+    // empty
+}
+
+Snapshot::~Snapshot() {
+    // empty
+}
+
+SnapshotPtr Snapshot::take( Context *context ) {
+    if( ddl_nullptr == context ) {
+        return SnapshotPtr();
+    }
+
+    return take( context->m_root );
+}
+
+SnapshotPtr Snapshot::take( DDLNode *root ) {
+    if( ddl_nullptr == root ) {
+        return SnapshotPtr();
+    }
+
+    const SnapshotNodePtr rootNode( takeNode( root ) );
+    return SnapshotPtr( new Snapshot( rootNode, ++s_snapshotVersion ) );
+}
+
+const SnapshotNode *Snapshot::getRoot() const {
+    return m_root.get();
+}
+
+size_t Snapshot::getVersion() const {
+    return m_version;
+}
+
+SnapshotNodePtr Snapshot::takeNode( DDLNode *node ) {
+    // unchanged subtrees are shared with the former snapshot
+    if( !node->m_subtreeDirty && node->m_snapshot ) {
+        return node->m_snapshot;
+    }
+
+    std::shared_ptr<SnapshotNode> result( new SnapshotNode );
+    const DDLNode::DllNodeList &children( node->getChildNodeList() );
+    if( node->m_dirty || !node->m_snapshot ) {
+        result->m_data.reset( new SnapshotNode::Data( node ) );
+    } else {
+        result->m_data = node->m_snapshot->m_data;
+    }
+    result->m_children.reserve( children.size() );
+    for( size_t i = 0; i < children.size(); i++ ) {
+        result->m_children.push_back( takeNode( children[ i ] ) );
+    }
+
+    node->m_snapshot = result;
+    node->m_dirty = false;
+    node->m_subtreeDirty = false;
+
+    return result;
+}
+
+END_ODDLPARSER_NS
@@ -0,0 +1,299 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <openddlparser/OpenDDLStructuralIndex.h>
+#include <openddlparser/OpenDDLParserUtils.h>
+
+#include <algorithm>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#   define OPENDDL_USE_SSE2
+#   include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#   include <intrin.h>
+#endif
+
+BEGIN_ODDLPARSER_NS
+
+const size_t StructuralIndex::InvalidIndex = static_cast<size_t>( -1 );
+
+static const uint32 NoMatch = 0xffffffff;
+static const size_t BlockSize = 16;
+
+static inline bool isStructuralChar( char c ) {
+    switch( c ) {
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case '(':
+        case ')':
+        case ',':
+        case '=':
+            return true;
+        default:
+            break;
+    }
+
+    return false;
+}
+
+static inline char getOpenBracket( char closing ) {
+    switch( closing ) {
+        case '}':
+            return '{';
+        case ']':
+            return '[';
+        case ')':
+            return '(';
+        default:
+            break;
+    }
+
+    return '\0';
+}
+
+#ifdef OPENDDL_USE_SSE2
+static inline uint32 countTrailingZeros( uint32 mask ) {
+#   ifdef _MSC_VER
+    unsigned long idx( 0 );
+    _BitScanForward( &idx, mask );
+    return static_cast<uint32>( idx );
+#   else
+    return static_cast<uint32>( __builtin_ctz( mask ) );
+#   endif
+}
+#endif
+
+struct ClassifierState {
+    bool m_inString;
+    bool m_inComment;
+
+    ClassifierState()
+    : m_inString( false )
+    , m_inComment( false ) {
+        // empty
+    }
+};
+
+// Handles strings, escapes and comments byte per byte, returns the position to continue with.
+static size_t classifyScalar( const char *buffer, size_t start, size_t end, size_t len,
+                            ClassifierState &state, std::vector<uint32> &positions ) {
+    size_t i( start );
+    for( ; i < end; ++i ) {
+        const char c( buffer[ i ] );
+        if( state.m_inComment ) {
+            if( '\n' == c ) {
+                state.m_inComment = false;
+            }
+        } else if( state.m_inString ) {
+            if( '\\' == c ) {
+                ++i;
+            } else if( isStringLiteral( c ) ) {
+                state.m_inString = false;
+                positions.push_back( static_cast<uint32>( i ) );
+            }
+        } else if( isStringLiteral( c ) ) {
+            state.m_inString = true;
+            positions.push_back( static_cast<uint32>( i ) );
+        } else if( '/' == c && ( i + 1 ) < len && '/' == buffer[ i + 1 ] ) {
+            state.m_inComment = true;
+            ++i;
+        } else if( isStructuralChar( c ) ) {
+            positions.push_back( static_cast<uint32>( i ) );
+        }
+    }
+
+    return i;
+}
+
+#ifdef OPENDDL_USE_SSE2
+// Classifies one block of 16 bytes, returns false if the block needs the scalar path.
+static bool classifyBlock( const char *buffer, size_t start, ClassifierState &state,
+                           std::vector<uint32> &positions ) {
+    if( state.m_inComment ) {
+        return false;
+    }
+
+    const __m128i block( _mm_loadu_si128( reinterpret_cast<const __m128i*>( buffer + start ) ) );
+    const uint32 slashes( static_cast<uint32>( _mm_movemask_epi8( _mm_cmpeq_epi8( block, _mm_set1_epi8( '/' ) ) ) ) );
+    const uint32 escapes( static_cast<uint32>( _mm_movemask_epi8( _mm_cmpeq_epi8( block, _mm_set1_epi8( '\\' ) ) ) ) );
+    if( 0 != slashes || 0 != escapes ) {
+        return false;
+    }
+
+    __m128i structural( _mm_cmpeq_epi8( block, _mm_set1_epi8( '{' ) ) );
+    structural = _mm_or_si128( structural, _mm_cmpeq_epi8( block, _mm_set1_epi8( '}' ) ) );
+    structural = _mm_or_si128( structural, _mm_cmpeq_epi8( block, _mm_set1_epi8( '[' ) ) );
+    structural = _mm_or_si128( structural, _mm_cmpeq_epi8( block, _mm_set1_epi8( ']' ) ) );
+    structural = _mm_or_si128( structural, _mm_cmpeq_epi8( block, _mm_set1_epi8( '(' ) ) );
+    structural = _mm_or_si128( structural, _mm_cmpeq_epi8( block, _mm_set1_epi8( ')' ) ) );
+    structural = _mm_or_si128( structural, _mm_cmpeq_epi8( block, _mm_set1_epi8( ',' ) ) );
+    structural = _mm_or_si128( structural, _mm_cmpeq_epi8( block, _mm_set1_epi8( '=' ) ) );
+    uint32 mask( static_cast<uint32>( _mm_movemask_epi8( structural ) ) );
+    // the same quote as isStringLiteral
+    const uint32 quotes( static_cast<uint32>( _mm_movemask_epi8( _mm_cmpeq_epi8( block, _mm_set1_epi8( '\"' ) ) ) ) );
+
+    // prefix xor over the quote bits marks everything from an opening quote to the closing one
+    uint32 inString( quotes );
+    inString ^= inString << 1;
+    inString ^= inString << 2;
+    inString ^= inString << 4;
+    inString ^= inString << 8;
+    if( state.m_inString ) {
+        inString = ~inString;
+    }
+    inString &= 0xffff;
+
+    mask = ( mask & ~inString ) | quotes;
+    state.m_inString = ( 0 != ( inString & 0x8000 ) );
+    while( 0 != mask ) {
+        positions.push_back( static_cast<uint32>( start + countTrailingZeros( mask ) ) );
+        mask &= mask - 1;
+    }
+
+    return true;
+}
+#endif // OPENDDL_USE_SSE2
+
+StructuralIndex::StructuralIndex()
+: m_buffer( ddl_nullptr )
+, m_len( 0 )
+, m_positions()
+, m_matches()
+, m_balanced( true ) {
+    // empty
+}
+
+StructuralIndex::~StructuralIndex() {
+    // empty
+}
+
+bool StructuralIndex::build( const char *buffer, size_t len ) {
+    clear();
+    if( ddl_nullptr == buffer || 0 == len ) {
+        return true;
+    }
+
+    if( len >= static_cast<size_t>( NoMatch ) ) {
+        return false;
+    }
+
+    m_buffer = buffer;
+    m_len = len;
+
+    // stage 1: classify the buffer and store the structural positions
+    m_positions.reserve( len / 8 );
+    ClassifierState state;
+    size_t pos( 0 );
+#ifdef OPENDDL_USE_SSE2
+    while( ( pos + BlockSize ) <= len ) {
+        if( classifyBlock( buffer, pos, state, m_positions ) ) {
+            pos += BlockSize;
+        } else {
+            // an escape or a comment start can reach into the next block
+            pos = classifyScalar( buffer, pos, pos + BlockSize, len, state, m_positions );
+        }
+    }
+#endif // OPENDDL_USE_SSE2
+    classifyScalar( buffer, pos, len, len, state, m_positions );
+
+    // match the brackets
+    m_matches.resize( m_positions.size(), NoMatch );
+    std::vector<uint32> stack;
+    for( size_t i = 0; i < m_positions.size(); ++i ) {
+        const char c( buffer[ m_positions[ i ] ] );
+        if( '{' == c || '[' == c || '(' == c ) {
+            stack.push_back( static_cast<uint32>( i ) );
+        } else if( '}' == c || ']' == c || ')' == c ) {
+            if( stack.empty() || buffer[ m_positions[ stack.back() ] ] != getOpenBracket( c ) ) {
+                m_balanced = false;
+                continue;
+            }
+            m_matches[ i ] = stack.back();
+            m_matches[ stack.back() ] = static_cast<uint32>( i );
+            stack.pop_back();
+        }
+    }
+    if( !stack.empty() ) {
+        m_balanced = false;
+    }
+
+    return true;
+}
+
+void StructuralIndex::clear() {
+    m_buffer = ddl_nullptr;
+    m_len = 0;
+    m_positions.clear();
+    m_matches.clear();
+    m_balanced = true;
+}
+
+bool StructuralIndex::empty() const {
+    return m_positions.empty();
+}
+
+size_t StructuralIndex::size() const {
+    return m_positions.size();
+}
+
+bool StructuralIndex::isBalanced() const {
+    return m_balanced;
+}
+
+size_t StructuralIndex::getPosition( size_t idx ) const {
+    return m_positions[ idx ];
+}
+
+char StructuralIndex::getToken( size_t idx ) const {
+    return m_buffer[ m_positions[ idx ] ];
+}
+
+size_t StructuralIndex::getMatch( size_t idx ) const {
+    if( idx >= m_matches.size() || NoMatch == m_matches[ idx ] ) {
+        return InvalidIndex;
+    }
+
+    return m_matches[ idx ];
+}
+
+size_t StructuralIndex::find( size_t pos ) const {
+    std::vector<uint32>::const_iterator it( std::lower_bound( m_positions.begin(), m_positions.end(), static_cast<uint32>( pos ) ) );
+    if( m_positions.end() == it ) {
+        return InvalidIndex;
+    }
+
+    return static_cast<size_t>( it - m_positions.begin() );
+}
+
+bool StructuralIndex::contains( const char *ptr ) const {
+    return ( ddl_nullptr != m_buffer && ptr >= m_buffer && ptr < m_buffer + m_len );
+}
+
+const char *StructuralIndex::getBuffer() const {
+    return m_buffer;
+}
+
+END_ODDLPARSER_NS
@@ -0,0 +1,171 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <openddlparser/OpenDDLThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+BEGIN_ODDLPARSER_NS
+
+ThreadPool::ThreadPool( size_t numThreads )
+: m_workers()
+, m_tasks()
+, m_mutex()
+, m_taskAvailable()
+, m_tasksDone()
+, m_active( 0 )
+, m_stop( false ) {
+    if( 0 == numThreads ) {
+        numThreads = getHardwareThreads();
+    }
+
+    m_workers.reserve( numThreads );
+    for( size_t i = 0; i < numThreads; i++ ) {
+        m_workers.push_back( std::thread( &ThreadPool::workerMain, this ) );
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_stop = true;
+    }
+    m_taskAvailable.notify_all();
+    for( size_t i = 0; i < m_workers.size(); i++ ) {
+        m_workers[ i ].join();
+    }
+}
+
+size_t ThreadPool::getNumThreads() const {
+    return m_workers.size();
+}
+
+void ThreadPool::enqueue( const Task &task ) {
+    {
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_tasks.push_back( task );
+    }
+    m_taskAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock( m_mutex );
+    while( !m_tasks.empty() || 0 != m_active ) {
+        m_tasksDone.wait( lock );
+    }
+}
+
+namespace {
+
+// the shared state of one parallelFor call, it lives until the last task was finished
+struct ParallelForState {
+    std::atomic<size_t> m_next;
+    size_t m_count;
+    size_t m_finished;
+    std::mutex m_mutex;
+    std::condition_variable m_done;
+    std::function<void( size_t )> m_func;
+
+    void run() {
+        size_t numFinished( 0 );
+        for( size_t idx( m_next++ ); idx < m_count; idx = m_next++ ) {
+            m_func( idx );
+            ++numFinished;
+        }
+        if( 0 == numFinished ) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock( m_mutex );
+        m_finished += numFinished;
+        if( m_finished == m_count ) {
+            m_done.notify_all();
+        }
+    }
+};
+
+} // Namespace
+
+void ThreadPool::parallelFor( size_t count, const std::function<void( size_t )> &func ) {
+    if( 0 == count ) {
+        return;
+    }
+
+    std::shared_ptr<ParallelForState> state( new ParallelForState );
+    state->m_next = 0;
+    state->m_count = count;
+    state->m_finished = 0;
+    state->m_func = func;
+    const size_t numTasks( std::min( count - 1, m_workers.size() ) );
+    for( size_t i = 0; i < numTasks; i++ ) {
+        enqueue( [state]() {
+            state->run();
+        } );
+    }
+
+    // the calling thread works as well. The call returns when all indices are done, tasks which
+    // start later find no work left, so nested calls from a worker cannot block the pool.
+    state->run();
+    std::unique_lock<std::mutex> lock( state->m_mutex );
+    while( state->m_finished != count ) {
+        state->m_done.wait( lock );
+    }
+}
+
+size_t ThreadPool::getHardwareThreads() {
+    const size_t numThreads( std::thread::hardware_concurrency() );
+    if( 0 == numThreads ) {
+        return 1;
+    }
+
+    return numThreads;
+}
+
+void ThreadPool::workerMain() {
+    for( ;; ) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            while( !m_stop && m_tasks.empty() ) {
+                m_taskAvailable.wait( lock );
+            }
+            if( m_tasks.empty() ) {
+                return;
+            }
+            task = m_tasks.front();
+            m_tasks.pop_front();
+            ++m_active;
+        }
+
+        task();
+
+        std::unique_lock<std::mutex> lock( m_mutex );
+        --m_active;
+        if( m_tasks.empty() && 0 == m_active ) {
+            m_tasksDone.notify_all();
+        }
+    }
+}
+
+END_ODDLPARSER_NS
@@ -0,0 +1,109 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <openddlparser/OpenDDLTranscoder.h>
+#include <openddlparser/OpenDDLExport.h>
+#include <openddlparser/DDLNode.h>
+
+BEGIN_ODDLPARSER_NS
+
+static const size_t NoSkipLevel = static_cast<size_t>( -1 );
+
+OpenDDLTranscoder::OpenDDLTranscoder( OpenDDLExport *exporter )
+: m_exporter( exporter )
+, m_filter( ddl_nullptr )
+, m_skipLevel( NoSkipLevel )
+, m_success( true ) {
+    // empty
+}
+
+OpenDDLTranscoder::~OpenDDLTranscoder() {
+    // empty
+}
+
+void OpenDDLTranscoder::setFilter( nodeFilterCallback filter ) {
+    m_filter = filter;
+}
+
+bool OpenDDLTranscoder::transcode( OpenDDLParser &parser ) {
+    return run( parser, std::string(), 0 );
+}
+
+bool OpenDDLTranscoder::transcodeFile( OpenDDLParser &parser, const std::string &filename, size_t blockSize ) {
+    if( filename.empty() ) {
+        return false;
+    }
+
+    return run( parser, filename, blockSize );
+}
+
+bool OpenDDLTranscoder::run( OpenDDLParser &parser, const std::string &filename, size_t blockSize ) {
+    if( ddl_nullptr == m_exporter ) {
+        return false;
+    }
+
+    OpenDDLEventHandler *handler( parser.getEventHandler() );
+    const bool streaming( parser.isStreamingEnabled() );
+    parser.setEventHandler( this );
+    parser.setStreaming( true );
+    m_skipLevel = NoSkipLevel;
+    m_success = true;
+
+    const bool ok( filename.empty() ? parser.parse() : parser.parseFile( filename, blockSize ) );
+    parser.setEventHandler( handler );
+    parser.setStreaming( streaming );
+    m_success = m_exporter->flush() && m_success;
+
+    return ok && m_success;
+}
+
+bool OpenDDLTranscoder::onStructureBegin( DDLNode *node, size_t level ) {
+    if( NoSkipLevel != m_skipLevel ) {
+        return true;
+    }
+
+    if( ddl_nullptr != m_filter && !m_filter( node ) ) {
+        m_skipLevel = level;
+        return true;
+    }
+
+    m_success = m_exporter->handleNodeBegin( node, level ) && m_success;
+
+    // a failed write stops the parser
+    return m_success;
+}
+
+bool OpenDDLTranscoder::onStructureEnd( DDLNode *node, size_t level ) {
+    if( NoSkipLevel != m_skipLevel ) {
+        if( level == m_skipLevel ) {
+            m_skipLevel = NoSkipLevel;
+        }
+        return true;
+    }
+
+    m_success = m_exporter->handleNodeEnd( node, level ) && m_success;
+
+    // a failed write stops the parser
+    return m_success;
+}
+
+END_ODDLPARSER_NS
@@ -0,0 +1,283 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include <openddlparser/OpenDDLValidator.h>
+#include <openddlparser/DDLNode.h>
+#include <openddlparser/OpenDDLThreadPool.h>
+
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+BEGIN_ODDLPARSER_NS
+
+// the tree is split at most this many levels below the root
+static const size_t MaxSplitLevels = 4;
+
+namespace {
+
+// a part of the tree in document order, a shallow unit only contains its own node
+struct Unit {
+    const DDLNode *m_node;
+    bool m_deep;
+
+    Unit( const DDLNode *node, bool deep )
+    : m_node( node )
+    , m_deep( deep ) {
+        // empty
+    }
+};
+
+typedef std::unordered_map<std::string, const DDLNode*> GlobalNameMap;
+
+} // Namespace
+
+static void splitTree( const DDLNode *root, size_t minUnits, std::vector<Unit> &units ) {
+    units.push_back( Unit( root, true ) );
+
+    // the subtrees are split level by level until there is enough work for all threads
+    for( size_t level = 0; level < MaxSplitLevels && units.size() < minUnits; level++ ) {
+        std::vector<Unit> next;
+        bool split( false );
+        for( size_t i = 0; i < units.size(); i++ ) {
+            const Unit &unit( units[ i ] );
+            const DDLNode::DllNodeList &childs( unit.m_node->getChildNodeList() );
+            if( !unit.m_deep || childs.empty() ) {
+                next.push_back( unit );
+                continue;
+            }
+            next.push_back( Unit( unit.m_node, false ) );
+            for( size_t j = 0; j < childs.size(); j++ ) {
+                if( ddl_nullptr != childs[ j ] ) {
+                    next.push_back( Unit( childs[ j ], true ) );
+                }
+            }
+            split = true;
+        }
+        units.swap( next );
+        if( !split ) {
+            break;
+        }
+    }
+}
+
+static void collectNodes( const Unit &unit, std::vector<const DDLNode*> &nodes ) {
+    if( !unit.m_deep ) {
+        nodes.push_back( unit.m_node );
+        return;
+    }
+
+    // pre-order walk without recursion, deep documents must not overflow the stack
+    std::vector<const DDLNode*> stack( 1, unit.m_node );
+    while( !stack.empty() ) {
+        const DDLNode *node( stack.back() );
+        stack.pop_back();
+        nodes.push_back( node );
+        const DDLNode::DllNodeList &childs( node->getChildNodeList() );
+        for( size_t i = childs.size(); i > 0; i-- ) {
+            if( ddl_nullptr != childs[ i - 1 ] ) {
+                stack.push_back( childs[ i - 1 ] );
+            }
+        }
+    }
+}
+
+static std::string getText( const Text *text ) {
+    if( ddl_nullptr == text || ddl_nullptr == text->m_buffer ) {
+        return std::string();
+    }
+
+    return std::string( text->m_buffer, text->m_len );
+}
+
+static void addDiagnostic( LogSeverity severity, const DDLNode *node, const std::string &message, std::vector<Diagnostic> &diagnostics ) {
+    diagnostics.push_back( Diagnostic( severity, node, node->getType() + ": " + message ) );
+}
+
+static bool hasLocalName( const DDLNode *scope, const std::string &name ) {
+    // the children of the structure are searched first, then the children of its parents
+    for( ; ddl_nullptr != scope; scope = scope->getParent() ) {
+        const DDLNode::DllNodeList &childs( scope->getChildNodeList() );
+        for( size_t i = 0; i < childs.size(); i++ ) {
+            const DDLNode *child( childs[ i ] );
+            if( ddl_nullptr != child && LocalName == child->getNameType() && name == child->getName() ) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+static void checkReference( const DDLNode *node, const Reference *ref, const GlobalNameMap &globals, std::vector<Diagnostic> &diagnostics ) {
+    if( ddl_nullptr == ref ) {
+        return;
+    }
+
+    for( size_t i = 0; i < ref->m_numRefs; i++ ) {
+        const Name *name( ref->m_referencedName[ i ] );
+        if( ddl_nullptr == name ) {
+            continue;
+        }
+        const std::string id( getText( name->m_id ) );
+        const bool found( GlobalName == name->m_type ? globals.end() != globals.find( id ) : hasLocalName( node, id ) );
+        if( !found ) {
+            addDiagnostic( ddl_error_msg, node, std::string( "unresolved reference " ) + ( GlobalName == name->m_type ? "$" : "%" ) + id, diagnostics );
+        }
+    }
+}
+
+static void checkNode( const DDLNode *node, const GlobalNameMap &globals, std::vector<Diagnostic> &diagnostics ) {
+    const std::string &name( node->getName() );
+    if( !name.empty() && GlobalName == node->getNameType() ) {
+        GlobalNameMap::const_iterator it( globals.find( name ) );
+        if( globals.end() != it && node != it->second ) {
+            addDiagnostic( ddl_error_msg, node, "duplicate global name $" + name, diagnostics );
+        }
+    }
+
+    std::unordered_set<std::string> localNames;
+    const DDLNode::DllNodeList &childs( node->getChildNodeList() );
+    for( size_t i = 0; i < childs.size(); i++ ) {
+        const DDLNode *child( childs[ i ] );
+        if( ddl_nullptr != child && LocalName == child->getNameType() && !localNames.insert( child->getName() ).second ) {
+            addDiagnostic( ddl_error_msg, child, "duplicate local name %" + child->getName(), diagnostics );
+        }
+    }
+
+    std::unordered_set<std::string> keys;
+    for( const Property *prop( node->getProperties() ); ddl_nullptr != prop; prop = prop->m_next ) {
+        const std::string key( getText( prop->m_key ) );
+        if( !keys.insert( key ).second ) {
+            addDiagnostic( ddl_warn_msg, node, "duplicate property " + key, diagnostics );
+        }
+        checkReference( node, prop->m_ref, globals, diagnostics );
+    }
+
+    const DataArrayList *al( node->getDataArrayList() );
+    for( size_t i = 0; ddl_nullptr != al; al = al->m_next, i++ ) {
+        const size_t numItems( node->getDataArrayList()->m_numItems );
+        if( al->m_numItems != numItems ) {
+            std::stringstream stream;
+            stream << "subarray " << i << " has " << al->m_numItems << " items, expected " << numItems;
+            addDiagnostic( ddl_error_msg, node, stream.str(), diagnostics );
+        }
+        checkReference( node, al->m_refs, globals, diagnostics );
+    }
+
+    checkReference( node, node->getReferences(), globals, diagnostics );
+}
+
+Diagnostic::Diagnostic( LogSeverity severity, const DDLNode *node, const std::string &message )
+: m_severity( severity )
+, m_node( node )
+, m_message( message ) {
+    // empty
+}
+
+OpenDDLValidator::OpenDDLValidator( size_t numThreads )
+: m_numThreads( numThreads )
+, m_pool( ddl_nullptr )
+, m_diagnostics() {
+    // empty
+}
+
+OpenDDLValidator::~OpenDDLValidator() {
+    delete m_pool;
+    m_pool = ddl_nullptr;
+}
+
+bool OpenDDLValidator::validate( const DDLNode *root ) {
+    clear();
+    if( ddl_nullptr == root ) {
+        return true;
+    }
+
+    if( ddl_nullptr == m_pool ) {
+        m_pool = new ThreadPool( m_numThreads );
+    }
+    std::vector<Unit> units;
+    splitTree( root, ( m_pool->getNumThreads() + 1 ) * 4, units );
+
+    // collect the nodes and the global names of all units
+    std::vector<std::vector<const DDLNode*> > nodes( units.size() );
+    std::vector<std::vector<const DDLNode*> > globalNodes( units.size() );
+    m_pool->parallelFor( units.size(), [&]( size_t i ) {
+        collectNodes( units[ i ], nodes[ i ] );
+        for( size_t j = 0; j < nodes[ i ].size(); j++ ) {
+            const DDLNode *node( nodes[ i ][ j ] );
+            if( GlobalName == node->getNameType() && !node->getName().empty() ) {
+                globalNodes[ i ].push_back( node );
+            }
+        }
+    } );
+
+    // the first definition of a global name in document order wins
+    GlobalNameMap globals;
+    for( size_t i = 0; i < globalNodes.size(); i++ ) {
+        for( size_t j = 0; j < globalNodes[ i ].size(); j++ ) {
+            globals.insert( std::make_pair( globalNodes[ i ][ j ]->getName(), globalNodes[ i ][ j ] ) );
+        }
+    }
+
+    std::vector<std::vector<Diagnostic> > diagnostics( units.size() );
+    m_pool->parallelFor( units.size(), [&]( size_t i ) {
+        for( size_t j = 0; j < nodes[ i ].size(); j++ ) {
+            checkNode( nodes[ i ][ j ], globals, diagnostics[ i ] );
+        }
+    } );
+    for( size_t i = 0; i < diagnostics.size(); i++ ) {
+        m_diagnostics.insert( m_diagnostics.end(), diagnostics[ i ].begin(), diagnostics[ i ].end() );
+    }
+
+    return 0 == getNumErrors();
+}
+
+bool OpenDDLValidator::validate( const Context *ctx ) {
+    if( ddl_nullptr == ctx ) {
+        clear();
+        return true;
+    }
+
+    return validate( ctx->m_root );
+}
+
+const std::vector<Diagnostic> &OpenDDLValidator::getDiagnostics() const {
+    return m_diagnostics;
+}
+
+size_t OpenDDLValidator::getNumErrors() const {
+    size_t numErrors( 0 );
+    for( size_t i = 0; i < m_diagnostics.size(); i++ ) {
+        if( ddl_error_msg == m_diagnostics[ i ].m_severity ) {
+            ++numErrors;
+        }
+    }
+
+    return numErrors;
+}
+
+void OpenDDLValidator::clear() {
+    m_diagnostics.clear();
+}
+
+END_ODDLPARSER_NS
@@ -27,8 +27,6 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 BEGIN_ODDLPARSER_NS
 
-static Value::Iterator end( ddl_nullptr );
-
 Value::Iterator::Iterator()
 : m_start( ddl_nullptr )
 , m_current( ddl_nullptr ) {
@@ -70,23 +68,17 @@ Value *Value::Iterator::getNext() {
 }
 
 const Value::Iterator Value::Iterator::operator++( int ) {
-    if( ddl_nullptr == m_current ) {
-        return end;
-    }
-
-    m_current = m_current->getNext();
-    Iterator inst( m_current );
+    Iterator inst( *this );
+    ++( *this );
 
     return inst;
 }
 
 Value::Iterator &Value::Iterator::operator++( ) {
-    if( ddl_nullptr == m_current ) {
-        return end;
+    if( ddl_nullptr != m_current ) {
+        m_current = m_current->getNext();
     }
 
-    m_current = m_current->getNext();
-
     return *this;
 }
 
@@ -118,7 +110,7 @@ void Value::setBool( bool value ) {
     ::memcpy( m_data, &value, m_size );
 }
 
-bool Value::getBool() {
+bool Value::getBool() const {
     assert( ddl_bool == m_type );
     return ( *m_data == 1 );
 }
@@ -128,7 +120,7 @@ void Value::setInt8( int8 value ) {
     ::memcpy( m_data, &value, m_size );
 }
 
-int8 Value::getInt8() {
+int8 Value::getInt8() const {
     assert( ddl_int8 == m_type );
     return ( int8 ) ( *m_data );
 }
@@ -138,7 +130,7 @@ void Value::setInt16( int16 value ) {
     ::memcpy( m_data, &value, m_size );
 }
 
-int16 Value::getInt16() {
+int16 Value::getInt16() const {
     assert( ddl_int16 == m_type );
     int16 i;
     ::memcpy( &i, m_data, m_size );
@@ -150,7 +142,7 @@ void Value::setInt32( int32 value ) {
     ::memcpy( m_data, &value, m_size );
 }
 
-int32 Value::getInt32() {
+int32 Value::getInt32() const {
     assert( ddl_int32 == m_type );
     int32 i;
     ::memcpy( &i, m_data, m_size );
@@ -162,7 +154,7 @@ void Value::setInt64( int64 value ) {
     ::memcpy( m_data, &value, m_size );
 }
 
-int64 Value::getInt64() {
+int64 Value::getInt64() const {
     assert( ddl_int64 == m_type );
     int64 i;
     ::memcpy( &i, m_data, m_size );
@@ -243,7 +235,7 @@ double Value::getDouble() const {
     if ( m_type == ddl_double ) {
         double v;
         ::memcpy( &v, m_data, m_size );
-        return ( float ) v;
+        return v;
     }
     else {
         double tmp;
@@ -290,7 +282,7 @@ Reference *Value::getRef() const {
     return (Reference*) m_data;
 }
 
-void Value::dump() {
+void Value::dump() const {
     switch( m_type ) {
         case ddl_none:
             std::cout << "None" << std::endl;
@@ -350,7 +342,7 @@ Value *Value::getNext() const {
     return m_next;
 }
 
-size_t Value::size(){
+size_t Value::size() const {
     size_t result=1;
     Value *n=m_next;
     while( n!=ddl_nullptr) {
@@ -428,6 +420,29 @@ Value *ValueAllocator::allocPrimData( Value::ValueType type, size_t len ) {
     return data;
 }
 
+Value *ValueAllocator::copyPrimData( const Value *value ) {
+    if( ddl_nullptr == value ) {
+        return ddl_nullptr;
+    }
+
+    Value *data = new Value( value->m_type );
+    if( Value::ddl_ref == value->m_type ) {
+        if( ddl_nullptr != value->m_data ) {
+            data->setRef( reinterpret_cast<Reference*>( value->m_data ) );
+        }
+        data->m_size = value->m_size;
+        return data;
+    }
+
+    data->m_size = value->m_size;
+    if( data->m_size ) {
+        data->m_data = new unsigned char[ data->m_size ];
+        ::memcpy( data->m_data, value->m_data, data->m_size );
+    }
+
+    return data;
+}
+
 void ValueAllocator::releasePrimData( Value **data ) {
     if( !data ) {
         return;
@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <openddlparser/OpenDDLCommon.h>
 
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -36,6 +38,7 @@ struct Identifier;
 struct Reference;
 struct Property;
 struct DataArrayList;
+class SnapshotNode;
 
 ///
 /// @ingroup    OpenDDLParser
@@ -49,10 +52,17 @@ struct DataArrayList;
 class DLL_ODDLPARSER_EXPORT DDLNode {
 public:
     friend class OpenDDLParser;
+    friend class OpenDDLBatchLoader;
+    friend class ParseHandle;
+    friend class Snapshot;
+    friend class Reclaimer;
 
     /// @brief  The child-node-list type.
     typedef std::vector<DDLNode*> DllNodeList;
 
+    /// @brief  Marks a node without a valid tree index.
+    static const size_t InvalidTreeIndex;
+
 public:
     ///	@brief  The class destructor.
     ~DDLNode();
@@ -70,8 +80,21 @@ public:
 
     ///	@brief  Returns the child node list.
     /// @return The list of child nodes.
+    /// @remark A lazily parsed node will be materialized by this call.
     const DllNodeList &getChildNodeList() const;
 
+    ///	@brief  Returns false, if the body of the node was skipped by a lazy parse and was not accessed so far.
+    /// @return true if the children and the data of the node are available.
+    bool isMaterialized() const;
+
+    ///	@brief  Parses the skipped body of a lazily parsed node, does nothing for materialized nodes.
+    ///
+    /// Bodies are parsed one at a time, a thread which accesses a node while its body is parsed
+    /// waits for the end. So a parsed tree can be read by many threads at once, as long as the
+    /// parser is neither cleared nor used for a new parse.
+    /// @return true in case of success, false in case of a parse error.
+    bool materialize() const;
+
     /// Set the type of the DDLNode instance.
     /// @param  type    [in] The type.
     void setType( const std::string &type );
@@ -88,6 +111,14 @@ public:
     /// @return The name of the DDLNode instance.
     const std::string &getName() const;
 
+    /// @brief  Sets the type of the name, global ( $ ) or local ( % ).
+    /// @param  type    [in] The name type.
+    void setNameType( NameType type );
+
+    /// @brief  Returns the type of the name, GlobalName for nodes created without a type.
+    /// @return The name type.
+    NameType getNameType() const;
+
     /// @brief  Set a new property set.
     ///	@param  prop    [in] The first element of the property set.
     void setProperties( Property *prop );
@@ -99,7 +130,7 @@ public:
     ///	@brief  Looks for a given property.
     /// @param  name    [in] The name for the property to look for.
     /// @return true, if a corresponding property is assigned to the node, false if not.
-    bool hasProperty( const std::string &name );
+    bool hasProperty( const std::string &name ) const;
 
     ///	@brief  Will return true, if any properties are assigned to the node instance.
     ///	@return True, if properties are assigned.
@@ -108,7 +139,7 @@ public:
     ///	@brief  Search for a given property and returns it. Will return ddl_nullptr if no property was found.
     /// @param  name    [in] The name for the property to look for.
     /// @return The property or ddl_nullptr if no property was found.
-    Property *findPropertyByName( const std::string &name );
+    Property *findPropertyByName( const std::string &name ) const;
     
     /// @brief  Set a new value set.
     /// @param  val     [in] The first value instance of the value set.
@@ -134,6 +165,69 @@ public:
     ///	@return The first property of the assigned Reference set.
     Reference *getReferences() const;
 
+    ///	@brief  Marks the data of the node as changed for the next snapshot.
+    ///
+    /// The setters of the node call it, it is only needed after values or properties were changed
+    /// in place.
+    void touch();
+
+    ///	@brief  Returns true, if the node or its subtree changed since the last snapshot.
+    /// @return true if the next snapshot has to copy a part of the subtree.
+    bool isDirty() const;
+
+    ///	@brief  Returns the pre-order index of the node inside of its tree.
+    ///
+    /// The parser numbers all nodes in document order, the root gets the index 0. Nodes created or
+    /// moved afterwards have no valid index until updateTreeIndex was called for their root.
+    /// @return The pre-order index or InvalidTreeIndex.
+    size_t getTreeIndex() const;
+
+    ///	@brief  Returns the number of nodes in the subtree of the node, including the node itself.
+    /// @return The subtree size or 0 if the node has no valid tree index.
+    size_t getSubtreeSize() const;
+
+    ///	@brief  Returns true, if the node is a direct or indirect parent of the given node.
+    /// @param  node    [in] The node to check.
+    /// @return true if the node is an ancestor.
+    /// @remark The check is a comparison of the tree indices, parents are only walked for nodes without a valid index.
+    bool isAncestorOf( const DDLNode *node ) const;
+
+    ///	@brief  Returns true, if the node is a direct or indirect child of the given node.
+    /// @param  node    [in] The node to check.
+    /// @return true if the node is a descendant.
+    bool isDescendantOf( const DDLNode *node ) const;
+
+    ///	@brief  Numbers the already materialized subtree of the node in pre-order, starting with 0.
+    void updateTreeIndex();
+
+    ///	@brief  Returns the Bloom mask of a type name, two of the 64 bits are set for each type.
+    /// @param  type    [in] The type name.
+    /// @return The mask.
+    static uint64 getTypeMask( const std::string &type );
+
+    ///	@brief  Returns the summary of all types in the subtree of the node, including its own type.
+    ///
+    /// The summary is a Bloom mask: a type which is missing in the mask does not occur in the subtree,
+    /// a set type may be a false positive. Not materialized nodes report all bits.
+    /// @return The subtree type mask.
+    uint64 getSubtreeTypeMask() const;
+
+    ///	@brief  Returns false, if no node of the given type can occur in the subtree of the node.
+    /// @param  type    [in] The type name.
+    /// @return false if the subtree does not contain the type, true if it may contain it.
+    bool mayContainType( const std::string &type ) const;
+
+    ///	@brief  Collects all descendants of the given type, subtrees without the type are skipped.
+    /// @param  type    [in] The type name.
+    /// @param  result  [out] The found nodes in document order will be appended.
+    /// @return The number of found nodes.
+    size_t findNodesByType( const std::string &type, DllNodeList &result ) const;
+
+    ///	@brief  Returns the first descendant of the given type in document order.
+    /// @param  type    [in] The type name.
+    /// @return The found node or ddl_nullptr.
+    DDLNode *findFirstNodeByType( const std::string &type ) const;
+
     ///	@brief  The creation method.
     /// @param  type    [in] The DDLNode type.
     ///	@param  name    [in] The name for the new DDLNode instance.
@@ -147,10 +241,21 @@ private:
     DDLNode( const DDLNode & ) ddl_no_copy;
     DDLNode &operator = ( const DDLNode & ) ddl_no_copy;
     static void releaseNodes();
+    static void takeNodes( DllNodeList &nodes );
+    static void takeSubtree( DDLNode *node, DllNodeList &nodes );
+    static void deleteNodes( DllNodeList &nodes );
+    static void setThreadArena( DllNodeList *arena );
+    static void spliceArena( DllNodeList &arena );
+    static size_t nextTreeGeneration();
+    void invalidateTreeIndex();
+    void markSubtreeDirty();
+    void addSubtreeTypeMask( uint64 mask );
+    void collectNodesByType( const std::string &type, uint64 mask, DllNodeList &result, bool firstOnly ) const;
 
 private:
     std::string m_type;
     std::string m_name;
+    NameType m_nameType;
     DDLNode *m_parent;
     std::vector<DDLNode*> m_children;
     Property *m_properties;
@@ -158,6 +263,16 @@ private:
     DataArrayList *m_dtArrayList;
     Reference *m_references;
     size_t m_idx;
+    std::atomic<OpenDDLParser*> m_lazyParser;
+    size_t m_lazyBegin;
+    size_t m_lazyEnd;
+    size_t m_treeIdx;
+    size_t m_treeEnd;
+    size_t m_treeGeneration;
+    uint64 m_typeMask;
+    bool m_dirty;
+    bool m_subtreeDirty;
+    std::shared_ptr<const SnapshotNode> m_snapshot;
     static DllNodeList s_allocatedNodes;
 };
 
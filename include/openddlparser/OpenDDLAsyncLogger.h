@@ -0,0 +1,79 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <openddlparser/OpenDDLParser.h>
+
+#include <string>
+
+BEGIN_ODDLPARSER_NS
+
+//-------------------------------------------------------------------------------------------------
+///	@class		AsyncLogger
+///	@ingroup	OpenDDLParser
+///
+///	@brief  Passes log messages to a target callback on a background thread.
+///
+/// AsyncLogger::log can be installed as log callback of any number of parsers. It stores the
+/// message in a lock-free ring buffer and returns, a background thread drains the ring and calls
+/// the target callback, so slow log targets do not stall the parsing. Messages are dropped when
+/// the ring is full. The logger must not be stopped while parsers are still logging into it.
+/// A logger which is still running at the exit of the program is stopped then, but the target
+/// may already be gone at that time, so call stop before the exit.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT AsyncLogger {
+public:
+    ///	@brief  The default number of messages in the ring buffer.
+    static const size_t DefaultCapacity;
+
+    ///	@brief  Starts the background thread.
+    /// @param  target      [in] The callback which receives the messages on the background thread.
+    /// @param  capacity    [in] The number of messages in the ring, rounded up to a power of two.
+    /// @return true in case of success, false if the logger is already running.
+    static bool start( OpenDDLParser::logCallback target, size_t capacity = DefaultCapacity );
+
+    ///	@brief  Passes all pending messages to the target and stops the background thread.
+    static void stop();
+
+    ///	@brief  Returns true, if the background thread is running.
+    /// @return true if the logger is running.
+    static bool isRunning();
+
+    ///	@brief  The log callback, stores the message for the background thread.
+    /// @param  severity    [in] The severity of the message.
+    /// @param  msg         [in] The message.
+    static void log( LogSeverity severity, const std::string &msg );
+
+    ///	@brief  Waits until all messages logged so far were passed to the target.
+    /// The calling thread blocks until the background thread signals the drained messages.
+    static void flush();
+
+    ///	@brief  Returns the number of dropped messages since the start.
+    /// @return The number of dropped messages.
+    static size_t getNumDropped();
+
+private:
+    AsyncLogger() ddl_no_copy;
+};
+
+END_ODDLPARSER_NS
@@ -0,0 +1,106 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <openddlparser/OpenDDLCommon.h>
+#include <openddlparser/DDLNode.h>
+
+#include <string>
+#include <vector>
+
+BEGIN_ODDLPARSER_NS
+
+class ThreadPool;
+
+///	@brief  The result of loading one file of a batch.
+struct DLL_ODDLPARSER_EXPORT BatchResult {
+    std::string m_path;     ///< The path of the file.
+    Context *m_context;     ///< The parsed context, ddl_nullptr in case of an error.
+    std::string m_error;    ///< The error messages of the file, empty in case of success.
+    size_t m_size;          ///< The size of the file in bytes.
+    double m_readTime;      ///< The time to read the file in seconds.
+    double m_parseTime;     ///< The time to parse the file in seconds.
+
+    ///	@brief  The default class constructor.
+    BatchResult();
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@class		OpenDDLBatchLoader
+///	@ingroup	OpenDDLParser
+///
+///	@brief  Reads and parses a list of files concurrently.
+///
+/// The files are sorted by their size and dealt out to one work queue per thread, so every thread
+/// starts with its biggest files. A thread which runs out of work steals the smallest files from
+/// the other queues, so a single big file does not delay the rest of the batch. The nodes of each
+/// file are owned by the loader and not by the node registry of the parsers, they stay valid until
+/// the loader is cleared or destroyed, independent of other parsers.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT OpenDDLBatchLoader {
+public:
+    ///	@brief  The class constructor.
+    /// @param  numThreads  [in] The number of worker threads, 0 uses one thread per hardware thread.
+    OpenDDLBatchLoader( size_t numThreads = 0 );
+
+    ///	@brief  The class destructor, releases all results.
+    ~OpenDDLBatchLoader();
+
+    ///	@brief  Enables or disables the indexed parse mode of the parsers.
+    /// @param  enabled     [in] true to enable the indexed mode.
+    void setUseStructuralIndex( bool enabled );
+
+    ///	@brief  Returns true, if the indexed parse mode is enabled.
+    bool isStructuralIndexEnabled() const;
+
+    ///	@brief  Loads the files, the results of a former call are released.
+    /// @param  paths       [in] The paths of the files.
+    /// @return true if all files were loaded, false if at least one file failed.
+    bool load( const std::vector<std::string> &paths );
+
+    ///	@brief  Returns the number of results, one per path in the order of the paths.
+    size_t getNumResults() const;
+
+    ///	@brief  Returns a result.
+    /// @param  idx         [in] The index of the path.
+    /// @return The result of the file.
+    const BatchResult &getResult( size_t idx ) const;
+
+    ///	@brief  Releases all results and their nodes.
+    void clear();
+
+private:
+    void loadFile( size_t idx );
+
+    OpenDDLBatchLoader( const OpenDDLBatchLoader & ) ddl_no_copy;
+    OpenDDLBatchLoader &operator = ( const OpenDDLBatchLoader & ) ddl_no_copy;
+
+private:
+    size_t m_numThreads;
+    ThreadPool *m_pool;
+    bool m_useIndex;
+    std::vector<BatchResult> m_results;
+    std::vector<DDLNode::DllNodeList> m_arenas;
+};
+
+END_ODDLPARSER_NS
@@ -0,0 +1,93 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <openddlparser/OpenDDLCommon.h>
+#include <openddlparser/OpenDDLBinaryFormat.h>
+#include <openddlparser/Value.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+BEGIN_ODDLPARSER_NS
+
+//-------------------------------------------------------------------------------------------------
+///	@class		OpenDDLBinaryExport
+///	@ingroup	OpenDDLParser
+///
+///	@brief  Writes a node tree to the binary OpenDDL encoding ( @see OpenDDLBinaryFormat.h ).
+///
+/// The whole file is built in memory and written in one block. Data lists are stored as raw
+/// arrays, so a reader can use them without parsing.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT OpenDDLBinaryExport {
+public:
+    ///	@brief  The class constructor.
+    OpenDDLBinaryExport();
+
+    ///	@brief  The class destructor.
+    ~OpenDDLBinaryExport();
+
+    ///	@brief  Writes the node tree of the context to a file.
+    /// @param  ctx         [in] The context to export.
+    /// @param  filename    [in] The name of the file to write.
+    /// @return true in case of success, false in case of an error.
+    bool exportContext( Context *ctx, const std::string &filename );
+
+    ///	@brief  Writes the node tree of the context to a buffer.
+    /// @param  ctx         [in] The context to export.
+    /// @param  buffer      [out] Receives the encoded data.
+    /// @return true in case of success, false in case of an error.
+    bool exportContext( Context *ctx, std::vector<char> &buffer );
+
+    ///	@brief  Writes a subtree to a buffer, the node becomes the root of the encoded tree.
+    /// @param  node        [in] The root node of the subtree.
+    /// @param  buffer      [out] Receives the encoded data.
+    /// @return true in case of success, false in case of an error.
+    bool exportNode( DDLNode *node, std::vector<char> &buffer );
+
+private:
+    uint32 internString( const std::string &str );
+    uint32 internName( const Name *name );
+    bool writeStructure( DDLNode *node );
+    bool writeProperty( Property *prop, size_t pos );
+    bool writeData( Value::ValueType type, uint32 arraySize, const std::vector<Value*> &values );
+    bool writeReferences( Reference *ref );
+    void writeStringTable();
+    size_t append( size_t len );
+    void align();
+    void put32( size_t pos, uint32 value );
+    void put64( size_t pos, uint64 value );
+    void putRaw( size_t pos, const unsigned char *data, size_t len );
+
+    OpenDDLBinaryExport( const OpenDDLBinaryExport & ) ddl_no_copy;
+    OpenDDLBinaryExport &operator = ( const OpenDDLBinaryExport & ) ddl_no_copy;
+
+private:
+    std::vector<char> *m_buffer;
+    std::map<std::string, uint32> m_stringIds;
+    std::vector<std::string> m_strings;
+};
+
+END_ODDLPARSER_NS
@@ -0,0 +1,106 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <openddlparser/OpenDDLCommon.h>
+
+BEGIN_ODDLPARSER_NS
+
+//-------------------------------------------------------------------------------------------------
+/// The binary OpenDDL encoding, written by OpenDDLBinaryExport.
+///
+/// All numbers are stored little-endian, all records start at an 8 byte boundary. A file starts
+/// with a BinaryHeader, followed by the root structure record and the string table. Structures,
+/// type names, keys and reference names are stored as indices into the string table, so every
+/// identifier is stored once.
+///
+/// A structure record is laid out as:
+///     BinaryStructure                         the header, m_size covers the whole subtree
+///     uint32 childOffsets[ m_numChildren ]    relative to the start of the record, padded to 8
+///     BinaryProperty properties[ m_numProperties ]
+///     BinaryData blocks[ m_numData ]          each block is followed by its payload, padded to 8
+///     child records
+///
+/// The payload of a data block is the raw array of its values: bool is stored as one byte, half
+/// as uint16, strings and references as uint32 string indices. Reference names keep their $ or
+/// % prefix. The string table is an array of BinaryString entries followed by the characters of
+/// all strings, each one terminated by a zero.
+//-------------------------------------------------------------------------------------------------
+
+///	@brief  The magic bytes at the start of a binary file.
+static const char BinaryMagic[ 4 ] = { 'O', 'D', 'D', 'B' };
+
+///	@brief  The version of the binary format, readers reject other versions.
+static const uint32 BinaryVersion = 2;
+
+///	@brief  The string index for no string, used for unnamed structures and null references.
+static const uint32 BinaryNoString = 0xffffffff;
+
+///	@brief  The alignment of all records in bytes.
+static const size_t BinaryAlignment = 8;
+
+///	@brief  The file header.
+struct BinaryHeader {
+    char   m_magic[ 4 ];            ///< The magic bytes ( @see BinaryMagic ).
+    uint32 m_version;               ///< The format version ( @see BinaryVersion ).
+    uint32 m_rootOffset;            ///< The offset of the root structure record.
+    uint32 m_stringTableOffset;     ///< The offset of the string table.
+    uint32 m_numStrings;            ///< The number of strings in the string table.
+    uint32 m_reserved;              ///< Reserved, always 0.
+    uint64 m_fileSize;              ///< The size of the whole file in bytes.
+};
+
+///	@brief  The header of a structure record.
+struct BinaryStructure {
+    uint32 m_size;                  ///< The size of the record including all children.
+    uint32 m_type;                  ///< The string index of the type.
+    uint32 m_name;                  ///< The string index of the name.
+    uint32 m_numProperties;         ///< The number of properties.
+    uint32 m_numData;               ///< The number of data blocks.
+    uint32 m_numChildren;           ///< The number of child structures.
+    uint32 m_nameType;              ///< The type of the name ( @see NameType ).
+    uint32 m_reserved;              ///< Reserved, always 0.
+};
+
+///	@brief  A property of a structure.
+struct BinaryProperty {
+    uint32 m_key;                   ///< The string index of the key.
+    uint32 m_type;                  ///< The value type ( @see Value::ValueType ).
+    uint64 m_value;                 ///< The raw value bits, the string index for strings and references.
+};
+
+///	@brief  The header of a data block.
+struct BinaryData {
+    uint32 m_type;                  ///< The value type ( @see Value::ValueType ).
+    uint32 m_arraySize;             ///< The number of values per sub-array, 0 for a plain list.
+    uint32 m_numValues;             ///< The number of values in the payload.
+    uint32 m_payloadSize;           ///< The size of the payload in bytes including the padding.
+};
+
+///	@brief  An entry of the string table.
+struct BinaryString {
+    uint32 m_offset;                ///< The offset of the characters, relative to the string table.
+    uint32 m_length;                ///< The length without the terminating zero.
+};
+
+END_ODDLPARSER_NS
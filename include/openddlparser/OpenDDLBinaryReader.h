@@ -0,0 +1,288 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <openddlparser/OpenDDLCommon.h>
+#include <openddlparser/OpenDDLBinaryFormat.h>
+#include <openddlparser/Value.h>
+
+#include <string>
+
+BEGIN_ODDLPARSER_NS
+
+class OpenDDLBinaryReader;
+
+//-------------------------------------------------------------------------------------------------
+///	@brief  A read-only view of a typed array inside of a binary file.
+//-------------------------------------------------------------------------------------------------
+template<class T>
+class BinarySpan {
+public:
+    BinarySpan()
+    : m_data( ddl_nullptr )
+    , m_size( 0 ) {
+        // empty
+    }
+
+    BinarySpan( const T *data, size_t size )
+    : m_data( data )
+    , m_size( size ) {
+        // empty
+    }
+
+    const T *data() const {
+        return m_data;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+    bool empty() const {
+        return 0 == m_size;
+    }
+
+    const T *begin() const {
+        return m_data;
+    }
+
+    const T *end() const {
+        return m_data + m_size;
+    }
+
+    const T &operator [] ( size_t index ) const {
+        return m_data[ index ];
+    }
+
+private:
+    const T *m_data;
+    size_t m_size;
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@brief  A view of a property of a binary structure.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT BinaryPropertyView {
+public:
+    BinaryPropertyView();
+    BinaryPropertyView( const OpenDDLBinaryReader *reader, const BinaryProperty *prop );
+
+    ///	@brief  Returns true if the view points to a property.
+    bool isValid() const;
+
+    ///	@brief  Returns the key of the property.
+    const char *getKey() const;
+
+    ///	@brief  Returns the value type of the property.
+    Value::ValueType getType() const;
+
+    ///	@brief  Returns the raw value bits.
+    uint64 getRawValue() const;
+
+    ///	@brief  Returns the value as a bool.
+    bool getBool() const;
+
+    ///	@brief  Returns an integer value, unsigned values are converted.
+    int64 getInt() const;
+
+    ///	@brief  Returns a floating point value, half and float values are converted.
+    double getDouble() const;
+
+    ///	@brief  Returns the string or the reference name, an empty string for other types.
+    const char *getString() const;
+
+private:
+    const OpenDDLBinaryReader *m_reader;
+    const BinaryProperty *m_prop;
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@brief  A view of a data block of a binary structure.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT BinaryDataView {
+public:
+    BinaryDataView();
+    BinaryDataView( const OpenDDLBinaryReader *reader, const BinaryData *data );
+
+    ///	@brief  Returns true if the view points to a data block.
+    bool isValid() const;
+
+    ///	@brief  Returns the value type of the data.
+    Value::ValueType getType() const;
+
+    ///	@brief  Returns the number of values per sub-array, 0 for a plain list.
+    size_t getArraySize() const;
+
+    ///	@brief  Returns the number of values.
+    size_t getNumValues() const;
+
+    ///	@brief  Returns the values as span, the span is empty if T does not match the stored type.
+    /// Strings and references are returned as uint32 string indices, bool values as uint8.
+    template<class T>
+    BinarySpan<T> getValues() const {
+        if( !isValid() || getValueSize() != sizeof( T ) ) {
+            return BinarySpan<T>();
+        }
+
+        return BinarySpan<T>( reinterpret_cast<const T*>( m_data + 1 ), m_data->m_numValues );
+    }
+
+    ///	@brief  Returns the raw payload, ddl_nullptr for an invalid view.
+    const void *getPayload() const;
+
+    ///	@brief  Returns a string or reference name of the data, an empty string if not available.
+    /// @param  index   [in] The index of the value.
+    const char *getString( size_t index ) const;
+
+private:
+    size_t getValueSize() const;
+
+private:
+    const OpenDDLBinaryReader *m_reader;
+    const BinaryData *m_data;
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@brief  A view of a structure of a binary file.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT BinaryNodeView {
+public:
+    BinaryNodeView();
+    BinaryNodeView( const OpenDDLBinaryReader *reader, const BinaryStructure *node );
+
+    ///	@brief  Returns true if the view points to a structure.
+    bool isValid() const;
+
+    ///	@brief  Returns the type of the structure.
+    const char *getType() const;
+
+    ///	@brief  Returns the name of the structure, an empty string if the structure is unnamed.
+    const char *getName() const;
+
+    ///	@brief  Returns the type of the name, GlobalName for an unnamed structure.
+    NameType getNameType() const;
+
+    ///	@brief  Returns the number of children.
+    size_t getNumChildren() const;
+
+    ///	@brief  Returns a child, an invalid view if the index is out of range.
+    BinaryNodeView getChild( size_t index ) const;
+
+    ///	@brief  Returns the first child with the given type, an invalid view if there is none.
+    BinaryNodeView findChild( const char *type ) const;
+
+    ///	@brief  Returns the number of properties.
+    size_t getNumProperties() const;
+
+    ///	@brief  Returns a property, an invalid view if the index is out of range.
+    BinaryPropertyView getProperty( size_t index ) const;
+
+    ///	@brief  Returns the property with the given key, an invalid view if there is none.
+    BinaryPropertyView findProperty( const char *key ) const;
+
+    ///	@brief  Returns the number of data blocks.
+    size_t getNumData() const;
+
+    ///	@brief  Returns a data block, an invalid view if the index is out of range.
+    BinaryDataView getData( size_t index ) const;
+
+private:
+    const char *getBody() const;
+    size_t getChildrenOffset() const;
+
+private:
+    const OpenDDLBinaryReader *m_reader;
+    const BinaryStructure *m_node;
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@class		OpenDDLBinaryReader
+///	@ingroup	OpenDDLParser
+///
+///	@brief  Reads the binary OpenDDL encoding without parsing or copying.
+///
+/// The file is mapped into memory, opening it only checks the header and the string table. All
+/// views point into the mapping and stay valid until the reader is closed. Records are checked
+/// against the bounds of the mapping when they are accessed. The values are used in place, so
+/// big-endian hosts are not supported.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT OpenDDLBinaryReader {
+public:
+    ///	@brief  The class constructor.
+    OpenDDLBinaryReader();
+
+    ///	@brief  The class destructor, closes the reader.
+    ~OpenDDLBinaryReader();
+
+    ///	@brief  Maps a binary file into memory.
+    /// @param  filename    [in] The name of the file.
+    /// @return true in case of success, false if the file could not be mapped or is invalid.
+    bool open( const std::string &filename );
+
+    ///	@brief  Uses an encoded buffer, the buffer must stay valid and 8 byte aligned.
+    /// @param  buffer      [in] The buffer.
+    /// @param  len         [in] The size of the buffer in bytes.
+    /// @return true in case of success, false if the buffer is invalid.
+    bool setBuffer( const char *buffer, size_t len );
+
+    ///	@brief  Unmaps the file, all views become invalid.
+    void close();
+
+    ///	@brief  Returns true if a file or buffer is in use.
+    bool isOpen() const;
+
+    ///	@brief  Returns the root structure.
+    BinaryNodeView getRoot() const;
+
+    ///	@brief  Creates a node tree with a copy of the binary data.
+    /// @return The new root node, ddl_nullptr in case of invalid data.
+    DDLNode *createNodeTree() const;
+
+    ///	@brief  Returns the number of strings.
+    size_t getNumStrings() const;
+
+    ///	@brief  Returns a string of the string table, an empty string for an invalid index.
+    const char *getString( uint32 id ) const;
+
+    ///	@brief  Returns the size of the mapped data.
+    size_t getSize() const;
+
+    ///	@brief  Returns true if the range is inside of the mapped data.
+    bool isInside( const void *ptr, size_t len ) const;
+
+private:
+    bool validate();
+
+    OpenDDLBinaryReader( const OpenDDLBinaryReader & ) ddl_no_copy;
+    OpenDDLBinaryReader &operator = ( const OpenDDLBinaryReader & ) ddl_no_copy;
+
+private:
+    const char *m_data;
+    size_t m_size;
+    bool m_mapped;
+    void *m_mapping;
+    const BinaryString *m_strings;
+    uint32 m_numStrings;
+};
+
+END_ODDLPARSER_NS
@@ -0,0 +1,103 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <openddlparser/OpenDDLCommon.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+BEGIN_ODDLPARSER_NS
+
+//-------------------------------------------------------------------------------------------------
+///	@class		BlockReader
+///	@ingroup	OpenDDLParser
+///
+///	@brief  Reads a file in blocks on an own thread.
+///
+/// Two block buffers are passed between the reader thread and the consumer: while the consumer
+/// works on one block, the next one is read into the other buffer. The reader waits when both
+/// buffers are filled, so the memory is bounded by two blocks.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT BlockReader {
+public:
+    ///	@brief  The default block size in bytes.
+    static const size_t DefaultBlockSize;
+
+    ///	@brief  The default class constructor.
+    BlockReader();
+
+    ///	@brief  The class destructor, stops the reader thread.
+    ~BlockReader();
+
+    ///	@brief  Opens a file and starts to read it.
+    /// @param  filename    [in] The name of the file.
+    /// @param  blockSize   [in] The block size in bytes, 0 uses the default block size.
+    /// @return true in case of success, false if the file cannot be opened.
+    bool open( const std::string &filename, size_t blockSize = DefaultBlockSize );
+
+    ///	@brief  Returns true, if a file is open.
+    bool isOpen() const;
+
+    ///	@brief  Waits for the next block.
+    ///
+    /// The former content of block is handed back to the reader as buffer for the next read.
+    /// @param  block       [inout] Receives the next block.
+    /// @return true if a block was read, false at the end of the file or in case of an error.
+    bool read( std::vector<char> &block );
+
+    ///	@brief  Returns true, if reading the file failed.
+    bool hasError() const;
+
+    ///	@brief  Stops the reader thread and closes the file.
+    void close();
+
+    ///	@brief  Returns the block size of the open file.
+    size_t getBlockSize() const;
+
+private:
+    void readerMain();
+
+    BlockReader( const BlockReader & ) ddl_no_copy;
+    BlockReader &operator = ( const BlockReader & ) ddl_no_copy;
+
+private:
+    FILE *m_file;
+    size_t m_blockSize;
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::deque<std::vector<char> > m_filled;
+    std::deque<std::vector<char> > m_free;
+    bool m_lent;
+    bool m_done;
+    bool m_stop;
+    bool m_error;
+};
+
+END_ODDLPARSER_NS
@@ -175,7 +175,7 @@ struct DLL_ODDLPARSER_EXPORT Reference {
 
     /// @brief  Returns the size in bytes to store one deep reference copy.
     /// @return The size on bytes.
-    size_t sizeInBytes();
+    size_t sizeInBytes() const;
 
 private:
     Reference( const Reference & ) ddl_no_copy;
@@ -219,7 +219,7 @@ struct DLL_ODDLPARSER_EXPORT DataArrayList {
     ~DataArrayList();
 
     /// @brief  Gets the length of the array
-    size_t size();
+    size_t size() const;
 
 private:
     DataArrayList( const DataArrayList & ) ddl_no_copy;
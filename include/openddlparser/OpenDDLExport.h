@@ -24,9 +24,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <openddlparser/OpenDDLCommon.h>
 #include <openddlparser/Value.h>
+#include <openddlparser/DDLNode.h>
+
+#include <functional>
+#include <vector>
 
 BEGIN_ODDLPARSER_NS
 
+class ThreadPool;
+
 //-------------------------------------------------------------------------------------------------
 /// @ingroup    IOStreamBase
 ///	@brief      This class represents the stream to write out.
@@ -41,18 +47,144 @@ public:
 //-------------------------------------------------------------------------------------------------
 /// @ingroup    IOStreamBase
 ///	@brief      This class represents the stream to write out.
+///
+/// The stream collects all statements in an internal write buffer and hands them over to the
+/// backend in large blocks. The default backend writes to a file descriptor, derived streams
+/// override writeData to use another target. A formatter is only called if one was set.
 //-------------------------------------------------------------------------------------------------
 class DLL_ODDLPARSER_EXPORT IOStreamBase {
 public:
+    ///	@brief  The default size of the write buffer in bytes.
+    static const size_t DefaultBufferSize;
+
     IOStreamBase( StreamFormatterBase *formatter = ddl_nullptr );
     virtual ~IOStreamBase();
     virtual bool open( const std::string &anme );
     virtual bool close();
+    virtual bool isOpen() const;
+
+    ///	@brief  Returns true if the backend stopped the output, pending statements cannot be written.
+    /// A stream which was never opened is not aborted, it drops the statements.
+    /// @return true if the stream was aborted.
+    virtual bool isAborted() const;
+
+    ///	@brief  Formats a statement and writes it to the stream.
+    /// @param  statement   [in] The statement to write.
+    /// @return The size of the statement before formatting if it was written completely, else 0.
     virtual size_t write( const std::string &statement );
 
+    ///	@brief  Writes a block of data to the stream.
+    /// @param  data    [in] The data to write.
+    /// @param  len     [in] The size of the data in bytes.
+    /// @return The number of written bytes.
+    size_t write( const char *data, size_t len );
+
+    ///	@brief  Writes all buffered data to the backend.
+    /// @return true in case of success, false in case of an error.
+    bool flush();
+
+    ///	@brief  Sets the size of the write buffer, 0 disables buffering.
+    /// @param  size    [in] The new buffer size in bytes.
+    void setBufferSize( size_t size );
+
+    ///	@brief  Returns the size of the write buffer.
+    /// @return The buffer size in bytes.
+    size_t getBufferSize() const;
+
+protected:
+    ///	@brief  Writes a block to the backend, the default backend is the opened file.
+    /// @param  data    [in] The data to write.
+    /// @param  len     [in] The size of the data in bytes.
+    /// @return The number of written bytes.
+    virtual size_t writeData( const char *data, size_t len );
+
+private:
+    IOStreamBase( const IOStreamBase & ) ddl_no_copy;
+    IOStreamBase &operator = ( const IOStreamBase & ) ddl_no_copy;
+
 private:
     StreamFormatterBase *m_formatter;
-    FILE *m_file;
+    int m_fd;
+    std::vector<char> m_buffer;
+    size_t m_bufferSize;
+};
+
+//-------------------------------------------------------------------------------------------------
+/// @ingroup    IOStreamBase
+///	@brief      This stream appends all statements to a std::string.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT StringStream : public IOStreamBase {
+public:
+    StringStream( std::string &target, StreamFormatterBase *formatter = ddl_nullptr );
+    virtual ~StringStream();
+    virtual bool open( const std::string &name );
+    virtual bool close();
+    virtual bool isOpen() const;
+
+protected:
+    virtual size_t writeData( const char *data, size_t len );
+
+private:
+    std::string &m_target;
+};
+
+//-------------------------------------------------------------------------------------------------
+/// @ingroup    IOStreamBase
+///	@brief      This stream passes the output to a callback in chunks of a fixed size.
+///
+/// All chunks have the chunk size, only the last one written by close or flush may be shorter.
+/// The callback controls the flow: ChunkRetry offers the same chunk again, so a full pipe or a
+/// busy compressor blocks the export instead of buffering the output. The writing thread sleeps
+/// before each new offer, the wait starts at 50 microseconds and doubles per retry up to 10
+/// milliseconds, an accepted chunk resets it. ChunkAbort stops the export, all following writes
+/// fail.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT CallbackStream : public IOStreamBase {
+public:
+    ///	@brief  The result of the chunk callback.
+    enum ChunkResult {
+        ChunkAccepted = 0,  ///< The chunk was consumed.
+        ChunkRetry,         ///< The receiver is busy, the chunk will be offered again after a wait.
+        ChunkAbort          ///< The receiver failed, the export is stopped.
+    };
+
+    ///	@brief  The chunk callback, receives the data of one chunk.
+    typedef std::function<ChunkResult( const char *data, size_t len )> chunkCallback;
+
+    CallbackStream( chunkCallback callback, size_t chunkSize = DefaultBufferSize, StreamFormatterBase *formatter = ddl_nullptr );
+    virtual ~CallbackStream();
+    virtual bool open( const std::string &name );
+    virtual bool close();
+    virtual bool isOpen() const;
+
+    ///	@brief  Returns true if the callback aborted the output.
+    virtual bool isAborted() const;
+
+protected:
+    virtual size_t writeData( const char *data, size_t len );
+
+private:
+    chunkCallback m_callback;
+    bool m_aborted;
+};
+
+//-------------------------------------------------------------------------------------------------
+/// @ingroup    IOStreamBase
+///	@brief      This stream appends all statements to a std::vector<char>.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT VectorStream : public IOStreamBase {
+public:
+    VectorStream( std::vector<char> &target, StreamFormatterBase *formatter = ddl_nullptr );
+    virtual ~VectorStream();
+    virtual bool open( const std::string &name );
+    virtual bool close();
+    virtual bool isOpen() const;
+
+protected:
+    virtual size_t writeData( const char *data, size_t len );
+
+private:
+    std::vector<char> &m_target;
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -63,7 +195,14 @@ private:
 //-------------------------------------------------------------------------------------------------
 class DLL_ODDLPARSER_EXPORT OpenDDLExport {
 public:
+    ///	@brief  The layout of the written text.
+    enum OutputMode {
+        PrettyOutput = 0,   ///< One statement per line, nested structures are indented.
+        CompactOutput       ///< No optional whitespace and no line ends, lists are packed densely.
+    };
+
     ///	@brief  The class constructor
+    /// @param  stream      [in] The stream to write to, the exporter takes the ownership. A file stream is used by default.
     OpenDDLExport( IOStreamBase *stream = ddl_nullptr );
 
     ///	@brief  The class destructor.
@@ -71,34 +210,97 @@ public:
 
     ///	@brief  Export the data of a parser context.
     /// @param  ctx         [in] Pointer to the context.
-    /// @param  filename    [in] The filename for the export.
+    /// @param  filename    [in] The filename for the export, an empty name writes to the already opened stream.
     /// @return True in case of success, false in case of an error.
     bool exportContext( Context *ctx, const std::string &filename );
 
+    ///	@brief  Sets the layout of the written text, the default is PrettyOutput.
+    /// @param  mode        [in] The new output mode.
+    void setOutputMode( OutputMode mode );
+
+    ///	@brief  Returns the layout of the written text.
+    /// @return The output mode.
+    OutputMode getOutputMode() const;
+
+    ///	@brief  Sets the indentation of nested structures in the pretty output mode.
+    /// @param  width       [in] The number of indentation characters per level, the default is 4.
+    /// @param  indentChar  [in] The indentation character, for instance a space or a tab.
+    void setIndentation( size_t width, char indentChar = ' ' );
+
+    ///	@brief  Returns the number of indentation characters per level.
+    /// @return The indentation width.
+    size_t getIndentationWidth() const;
+
+    ///	@brief  Sets the number of threads used to format the top-level structures.
+    ///
+    /// With more than one thread the top-level structures are formatted on a thread pool into
+    /// separate buffers, which are written in document order. Lazy bodies are parsed before the
+    /// formatting starts.
+    /// @param  numThreads  [in] The number of threads, 1 disables the parallel export, 0 uses all hardware threads.
+    void setNumThreads( size_t numThreads );
+
+    ///	@brief  Returns the number of threads used to format the top-level structures.
+    /// @return The number of threads.
+    size_t getNumThreads() const;
+
     ///	@brief  Handles a node export.
     /// @param  node        [in] The node to handle with.
     /// @return True in case of success, false in case of an error.
     bool handleNode( DDLNode *node );
 
+    ///	@brief  Writes the header of a node and opens its body, used to export a document while it is parsed.
+    /// @param  node        [in] The node.
+    /// @param  level       [in] The nesting level of the node.
+    /// @return True in case of success, false in case of an error.
+    bool handleNodeBegin( DDLNode *node, size_t level );
+
+    ///	@brief  Writes the data of a node and closes its body.
+    /// @param  node        [in] The node.
+    /// @param  level       [in] The nesting level of the node.
+    /// @return True in case of success, false in case of an error.
+    bool handleNodeEnd( DDLNode *node, size_t level );
+
+    ///	@brief  Writes all buffered statements to the target of the stream.
+    /// @return True in case of success, false in case of an error.
+    bool flush();
+
     ///	@brief  Writes the statement to the stream.
     /// @param  statement   [in]  The content to write.
     /// @return True in case of success, false in case of an error.
     bool writeToStream( const std::string &statement );
 
 protected:
-    bool writeNode( DDLNode *node, std::string &statement );
+    bool writeNode( DDLNode *node, size_t level, std::string &statement );
+    bool writeNodeBegin( DDLNode *node, size_t level, std::string &statement );
+    bool writeNodeData( DDLNode *node, size_t level, std::string &statement );
+    bool writeNodeEnd( size_t level, std::string &statement );
     bool writeNodeHeader( DDLNode *node, std::string &statement );
     bool writeProperties( DDLNode *node, std::string &statement );
     bool writeValueType( Value::ValueType type, size_t numItems, std::string &statement );
     bool writeValue( Value *val, std::string &statement );
     bool writeValueArray( DataArrayList *al, std::string &statement );
+    bool writeValueList( Value *first, std::string &statement );
+    bool writeReference( Reference *ref, std::string &statement );
 
 private:
+    bool handleNodesParallel( const DDLNode::DllNodeList &childs );
+    void writeIndent( size_t level, std::string &statement ) const;
+    void writeLineEnd( std::string &statement ) const;
+    void writeSpace( std::string &statement ) const;
+    void writeSeparator( std::string &statement ) const;
+    void writeOpenList( std::string &statement ) const;
+    void writeCloseList( std::string &statement ) const;
     OpenDDLExport( const OpenDDLExport & ) ddl_no_copy;
     OpenDDLExport &operator = ( const OpenDDLExport  & ) ddl_no_copy;
 
 private:
     IOStreamBase *m_stream;
+    OutputMode m_outputMode;
+    size_t m_indentWidth;
+    char m_indentChar;
+    size_t m_numThreads;
+    ThreadPool *m_pool;
+    bool m_parallel;
 };
 
 END_ODDLPARSER_NS
@@ -0,0 +1,118 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <openddlparser/OpenDDLCommon.h>
+
+#include <string>
+
+BEGIN_ODDLPARSER_NS
+
+//-------------------------------------------------------------------------------------------------
+///	@class		OpenDDLParseCache
+///	@ingroup	OpenDDLParser
+///
+///	@brief  Stores parsed documents in a directory, addressed by the hash of their content.
+///
+/// Each entry is one file in the binary format ( @see OpenDDLBinaryFormat.h ), named after the
+/// 64 bit hash of the source buffer. The format version is part of the hash, so entries of other
+/// versions are never loaded, files the reader rejects are removed. The cache is bounded by its
+/// maximum size, the least recently used entries are removed first. The time of the last use is
+/// the modification time of the file, so the order is shared between all processes using the
+/// same directory.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT OpenDDLParseCache {
+public:
+    ///	@brief  The default maximum size of the cache in bytes.
+    static const uint64 DefaultMaxSize;
+
+    ///	@brief  The class constructor.
+    /// @param  directory   [in] The cache directory, must exist.
+    /// @param  maxSize     [in] The maximum size of all entries in bytes.
+    OpenDDLParseCache( const std::string &directory, uint64 maxSize = DefaultMaxSize );
+
+    ///	@brief  The class destructor.
+    ~OpenDDLParseCache();
+
+    ///	@brief  Returns the cache directory.
+    const std::string &getDirectory() const;
+
+    ///	@brief  Sets the maximum size of all entries, the cache is trimmed with the next store.
+    /// @param  maxSize     [in] The maximum size in bytes.
+    void setMaxSize( uint64 maxSize );
+
+    ///	@brief  Returns the maximum size of all entries.
+    uint64 getMaxSize() const;
+
+    ///	@brief  Computes the 64 bit hash of a buffer ( XXH64 ).
+    /// @param  buffer      [in] The buffer.
+    /// @param  len         [in] The size of the buffer in bytes.
+    /// @param  seed        [in] The seed.
+    /// @return The hash value.
+    static uint64 computeHash( const char *buffer, size_t len, uint64 seed = 0 );
+
+    ///	@brief  Computes the key of a source buffer, the hash seeded with the format version.
+    /// @param  buffer      [in] The source buffer.
+    /// @param  len         [in] The size of the buffer in bytes.
+    /// @return The key of the entry.
+    static uint64 computeKey( const char *buffer, size_t len );
+
+    ///	@brief  Creates the node tree of an entry and marks the entry as used.
+    /// @param  key         [in] The key of the entry.
+    /// @return The new root node, ddl_nullptr if there is no valid entry.
+    DDLNode *load( uint64 key );
+
+    ///	@brief  Stores a node tree and removes old entries if the cache gets too big.
+    /// @param  key         [in] The key of the entry.
+    /// @param  root        [in] The root node to store.
+    /// @return true in case of success, false in case of an error.
+    bool store( uint64 key, DDLNode *root );
+
+    ///	@brief  Returns true if there is an entry for the key.
+    bool contains( uint64 key ) const;
+
+    ///	@brief  Removes an entry.
+    /// @return true if an entry was removed.
+    bool remove( uint64 key );
+
+    ///	@brief  Removes the least recently used entries until the size limit is met.
+    void trim();
+
+    ///	@brief  Removes all entries.
+    void clear();
+
+    ///	@brief  Returns the size of all entries in bytes.
+    uint64 getSize() const;
+
+private:
+    std::string getEntryPath( uint64 key ) const;
+
+    OpenDDLParseCache( const OpenDDLParseCache & ) ddl_no_copy;
+    OpenDDLParseCache &operator = ( const OpenDDLParseCache & ) ddl_no_copy;
+
+private:
+    std::string m_directory;
+    uint64 m_maxSize;
+};
+
+END_ODDLPARSER_NS
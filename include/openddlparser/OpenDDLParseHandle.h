@@ -0,0 +1,108 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <openddlparser/OpenDDLCommon.h>
+#include <openddlparser/DDLNode.h>
+#include <openddlparser/OpenDDLParser.h>
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+BEGIN_ODDLPARSER_NS
+
+//-------------------------------------------------------------------------------------------------
+///	@class		ParseHandle
+///	@ingroup	OpenDDLParser
+///
+///	@brief  The handle of a parsing running on a background thread ( @see OpenDDLParser::parseAsync ).
+///
+/// The parsing checks for a cancel request before each structure, so a cancelled parsing stops
+/// quickly. The nodes of the parsing are owned by the handle and not by the node registry of the
+/// parsers, they stay valid until the handle is destroyed. The destructor cancels a running
+/// parsing and waits for its end.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT ParseHandle {
+public:
+    ///	@brief  The state of the parsing.
+    enum State {
+        Running = 0,    ///< The parsing is still running.
+        Succeeded,      ///< The context is available.
+        Failed,         ///< The parsing failed, check the log.
+        Cancelled       ///< The parsing was cancelled.
+    };
+
+    ///	@brief  The class destructor, cancels the parsing and releases the nodes.
+    ~ParseHandle();
+
+    ///	@brief  Returns the current state without waiting.
+    /// @return The state of the parsing.
+    State getState() const;
+
+    ///	@brief  Returns true if the parsing has ended.
+    bool isDone() const;
+
+    ///	@brief  Returns the progress of the parsing.
+    /// @return The progress between 0 and 1.
+    double getProgress() const;
+
+    ///	@brief  Requests the cancellation, the parsing stops before the next structure.
+    void cancel();
+
+    ///	@brief  Waits for the end of the parsing.
+    /// @return The final state.
+    State wait() const;
+
+    ///	@brief  Waits for the end of the parsing for a limited time.
+    /// @param  milliseconds    [in] The maximum time to wait.
+    /// @return The state of the parsing, Running if the time has passed.
+    State waitFor( size_t milliseconds ) const;
+
+    ///	@brief  Waits for the end of the parsing and returns the context.
+    /// @return The parsed context, ddl_nullptr if the parsing failed or was cancelled.
+    Context *getContext() const;
+
+private:
+    friend class OpenDDLParser;
+
+    ParseHandle( const char *buffer, size_t len, OpenDDLParser::logCallback callback, LogSeverity severity, bool useIndex );
+    State run();
+    void releaseNodes( Context *ctx );
+    ParseHandle( const ParseHandle & ) ddl_no_copy;
+    ParseHandle &operator = ( const ParseHandle & ) ddl_no_copy;
+
+private:
+    std::vector<char> m_buffer;
+    OpenDDLParser::logCallback m_logCallback;
+    LogSeverity m_logSeverity;
+    bool m_useIndex;
+    std::atomic<bool> m_cancel;
+    std::atomic<size_t> m_pos;
+    std::atomic<size_t> m_size;
+    Context *m_context;
+    DDLNode::DllNodeList m_arena;
+    std::shared_future<State> m_result;
+};
+
+END_ODDLPARSER_NS
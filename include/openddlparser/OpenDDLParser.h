@@ -25,8 +25,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <openddlparser/OpenDDLCommon.h>
 #include <openddlparser/DDLNode.h>
 #include <openddlparser/OpenDDLParserUtils.h>
+#include <openddlparser/OpenDDLStructuralIndex.h>
 #include <openddlparser/Value.h>
 
+#include <functional>
 #include <vector>
 #include <string>
 
@@ -34,6 +36,10 @@ BEGIN_ODDLPARSER_NS
 
 class DDLNode;
 class Value;
+class OpenDDLParseCache;
+class ParseHandle;
+class Reclaimer;
+class ThreadPool;
 
 struct Identifier;
 struct Reference;
@@ -47,7 +53,7 @@ struct Property;
 template<class T>
 inline
 T *lookForNextToken( T *in, T *end ) {
-    while( ( isSpace( *in ) || isNewLine( *in ) || ',' == *in ) && ( in != end ) ) {
+    while( ( in != end ) && ( isSpace( *in ) || isNewLine( *in ) || ',' == *in ) ) {
         in++;
     }
     return in;
@@ -74,11 +80,40 @@ enum LogSeverity {
     ddl_debug_msg = 0,  ///< Debug message, for debugging
     ddl_info_msg,       ///< Info messages, normal mode
     ddl_warn_msg,       ///< Parser warnings
-    ddl_error_msg       ///< Parser errors
+    ddl_error_msg,      ///< Parser errors
+    ddl_none_msg        ///< No messages, only used as severity threshold
 };
 
 DLL_ODDLPARSER_EXPORT const char *getTypeToken( Value::ValueType  type );
 
+//-------------------------------------------------------------------------------------------------
+///	@class		OpenDDLEventHandler
+///	@ingroup	OpenDDLParser
+///
+///	@brief  Receives the structures of a document while it is parsed.
+///
+/// The begin event is sent as soon as the header of a structure ( type, name and properties ) was
+/// parsed, the end event when its body was parsed completely. The data of a structure is only
+/// available in the end event. The level of a top-level structure is 0.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT OpenDDLEventHandler {
+public:
+    ///	@brief  The class destructor.
+    virtual ~OpenDDLEventHandler();
+
+    ///	@brief  Will be called when the header of a structure was parsed.
+    /// @param  node    [in] The new node.
+    /// @param  level   [in] The nesting level of the node.
+    /// @return false to abort the parsing.
+    virtual bool onStructureBegin( DDLNode *node, size_t level ) = 0;
+
+    ///	@brief  Will be called when the body of a structure was parsed.
+    /// @param  node    [in] The complete node.
+    /// @param  level   [in] The nesting level of the node.
+    /// @return false to abort the parsing.
+    virtual bool onStructureEnd( DDLNode *node, size_t level ) = 0;
+};
+
 //-------------------------------------------------------------------------------------------------
 ///	@class		OpenDDLParser
 ///	@ingroup	OpenDDLParser
@@ -90,10 +125,20 @@ DLL_ODDLPARSER_EXPORT const char *getTypeToken( Value::ValueType  type );
 //-------------------------------------------------------------------------------------------------
 class DLL_ODDLPARSER_EXPORT OpenDDLParser {
 public:
+    friend class OpenDDLBatchLoader;
+    friend class ParseHandle;
+
     ///	@brief  The log callback function pointer.
     typedef void( *logCallback )( LogSeverity severity, const std::string &msg );
 
+    ///	@brief  The progress callback, gets the parse position and the size of the buffer in bytes.
+    /// Returns false to cancel the parsing.
+    typedef std::function<bool( size_t pos, size_t size )> progressCallback;
+
 public:
+    ///	@brief  The default minimum buffer size for the parallel parse mode in bytes.
+    static const size_t DefaultParallelThreshold;
+
     ///	@brief  The default class constructor.
     OpenDDLParser();
 
@@ -113,6 +158,21 @@ public:
     /// @return The current log callback.
     logCallback getLogCallback() const;
 
+    ///	@brief  Sets the lowest severity which is logged, ddl_none_msg disables the logging.
+    ///
+    /// The severity is checked before a message is formatted, so filtered messages cost nothing.
+    /// @param  severity    [in] The lowest logged severity, the default is ddl_debug_msg.
+    void setLogSeverity( LogSeverity severity );
+
+    ///	@brief  Returns the lowest severity which is logged.
+    /// @return The lowest logged severity.
+    LogSeverity getLogSeverity() const;
+
+    ///	@brief  Returns true, if messages of the given severity are logged.
+    /// @param  severity    [in] The severity to check.
+    /// @return true if the messages are passed to the log callback.
+    bool isLogEnabled( LogSeverity severity ) const;
+
     ///	@brief  Assigns a new buffer to parse.
     ///	@param  buffer      [in] The buffer
     ///	@param  len         [in] Size of the buffer
@@ -133,11 +193,143 @@ public:
     ///	@brief  Clears all parser data, including buffer and active context.
     void clear();
 
+    ///	@brief  Enables or disables the lazy parsing mode.
+    ///
+    /// In lazy mode the structures on the given level below the root only get their header parsed,
+    /// their body is skipped and will be parsed on the first access to the children or the data of
+    /// the node. Structures nested in such a body are skipped again until they are accessed. The
+    /// buffer of the parser is used for this, so the parser must not be cleared before all needed
+    /// nodes were accessed.
+    /// @param  enabled     [in] true to enable the lazy mode.
+    /// @param  depth       [in] The number of structure levels below the root which will be created.
+    void setLazyParsing( bool enabled, size_t depth = 1 );
+
+    ///	@brief  Returns true, if the lazy parsing mode is enabled.
+    /// @return true if the lazy parsing mode is enabled.
+    bool isLazyParsingEnabled() const;
+
+    ///	@brief  Enables or disables the indexed parse mode.
+    ///
+    /// In indexed mode a structural index of the whole buffer is built before the parsing starts
+    /// ( @see StructuralIndex ). Numeric data lists and data array lists are decoded by walking the
+    /// index instead of scanning for the next token and separator, skipped lazy bodies are found
+    /// by their matching bracket.
+    /// @param  enabled     [in] true to enable the indexed mode.
+    void setUseStructuralIndex( bool enabled );
+
+    ///	@brief  Returns true, if the indexed parse mode is enabled.
+    /// @return true if the indexed parse mode is enabled.
+    bool isStructuralIndexEnabled() const;
+
+    ///	@brief  Sets the handler which receives the structure events, ddl_nullptr disables the events.
+    /// @param  handler     [in] The event handler, the parser does not take the ownership.
+    void setEventHandler( OpenDDLEventHandler *handler );
+
+    ///	@brief  Returns the event handler.
+    /// @return The event handler or ddl_nullptr.
+    OpenDDLEventHandler *getEventHandler() const;
+
+    ///	@brief  Enables or disables the streaming mode.
+    ///
+    /// In streaming mode each node is released directly after its end event was sent, so only the
+    /// nodes of the currently open structures are alive and the memory of the tree is bounded by
+    /// the nesting depth. The root stays empty, the lazy parsing mode is not used.
+    /// @param  enabled     [in] true to enable the streaming mode.
+    void setStreaming( bool enabled );
+
+    ///	@brief  Returns true, if the streaming mode is enabled.
+    /// @return true if the streaming mode is enabled.
+    bool isStreamingEnabled() const;
+
+    ///	@brief  Enables or disables the parallel parse mode.
+    ///
+    /// In parallel mode the buffer is split after its top-level structures by a scan for brackets,
+    /// which skips string literals. The parts are parsed by worker threads, each one collects its
+    /// nodes in an own arena. The arenas are added to the node registry and the structures are
+    /// added to the root in document order afterwards. Buffers below the threshold are parsed
+    /// serially, as well as all buffers in lazy or streaming mode or with an event handler.
+    /// Numeric data lists above the threshold are split at their commas and decoded by the
+    /// worker threads, the offset of each part is the sum of the commas before it.
+    /// The log callback may be called by the worker threads.
+    /// @param  enabled     [in] true to enable the parallel mode.
+    /// @param  numThreads  [in] The number of worker threads, 0 uses one thread per hardware thread.
+    void setParallelParsing( bool enabled, size_t numThreads = 0 );
+
+    ///	@brief  Returns true, if the parallel parse mode is enabled.
+    /// @return true if the parallel parse mode is enabled.
+    bool isParallelParsingEnabled() const;
+
+    ///	@brief  Sets the minimum buffer and data list size for the parallel parse mode.
+    /// @param  size        [in] The minimum size in bytes.
+    void setParallelThreshold( size_t size );
+
+    ///	@brief  Returns the minimum buffer size for the parallel parse mode.
+    /// @return The minimum size in bytes.
+    size_t getParallelThreshold() const;
+
+    ///	@brief  Sets the cache for parsed documents, ddl_nullptr disables the caching.
+    ///
+    /// A buffer whose content is already stored in the cache is not parsed again, the node tree is
+    /// created from the cache entry. The node tree of a new buffer is stored after the parsing,
+    /// lazy structures get materialized for this. The cache is not used while an event handler is
+    /// set or in streaming mode.
+    /// @param  cache       [in] The cache, the parser does not take the ownership.
+    void setCache( OpenDDLParseCache *cache );
+
+    ///	@brief  Returns the cache for parsed documents.
+    /// @return The cache or ddl_nullptr.
+    OpenDDLParseCache *getCache() const;
+
+    ///	@brief  Sets the reclaimer for the nodes, ddl_nullptr releases them on the calling thread.
+    ///
+    /// With a reclaimer clear hands all nodes of the node registry to it and returns at once, the
+    /// nodes are deleted by the thread of the reclaimer. The reclaimer must outlive the parser.
+    /// @param  reclaimer   [in] The reclaimer, the parser does not take the ownership.
+    void setReclaimer( Reclaimer *reclaimer );
+
+    ///	@brief  Returns the reclaimer for the nodes.
+    /// @return The reclaimer or ddl_nullptr.
+    Reclaimer *getReclaimer() const;
+
+    ///	@brief  Sets the progress callback, an empty callback disables the progress reports.
+    ///
+    /// The callback is called before each structure with its position in the normalized buffer.
+    /// When it returns false the parsing stops and parse returns false. The parallel parse mode
+    /// is not used while a progress callback is set.
+    /// @param  callback    [in] The progress callback.
+    void setProgressCallback( const progressCallback &callback );
+
+    ///	@brief  Returns the progress callback.
+    /// @return The progress callback.
+    const progressCallback &getProgressCallback() const;
+
+    ///	@brief  Starts the parsing of a buffer on a background thread.
+    ///
+    /// The buffer is copied, the log callback, the log severity and the indexed parse mode of this
+    /// parser are used.
+    /// The nodes are owned by the returned handle and not by the parser.
+    ///	@param  buffer      [in] The buffer
+    ///	@param  len         [in] Size of the buffer
+    /// @return The handle of the parsing, the caller takes the ownership.
+    ParseHandle *parseAsync( const char *buffer, size_t len ) const;
+
     ///	@brief  Starts the parsing of the OpenDDL-file.
     /// @return True in case of success, false in case of an error.
     /// @remark In case of errors check log.
     bool parse();
 
+    ///	@brief  Reads and parses a file block by block.
+    ///
+    /// The file is read by a background thread while the complete top-level structures of the
+    /// former block are parsed, so reading and parsing overlap. The cache, the parallel parse mode
+    /// and the structural index are not used. A single top-level structure is only parsed after it
+    /// was read completely. In streaming mode the parsed input is dropped, so the memory use is
+    /// bounded by the block size and the biggest top-level structure.
+    /// @param  filename    [in] The name of the file.
+    /// @param  blockSize   [in] The block size in bytes, 0 uses the default block size.
+    /// @return True in case of success, false in case of an error.
+    bool parseFile( const std::string &filename, size_t blockSize = 0 );
+
     bool exportContext( Context *ctx, const std::string &filename );
 
     ///	@brief  Returns the root node.
@@ -153,6 +345,9 @@ public: // parser helpers
     char *parseHeader( char *in, char *end );
     char *parseStructure( char *in, char *end );
     char *parseStructureBody( char *in, char *end, bool &error );
+    bool materializeNode( DDLNode *node );
+    char *parseIndexedDataList( char *in, char *end, Value::ValueType type, Value **data, size_t &numValues );
+    char *parseIndexedDataArrayList( char *in, char *end, Value::ValueType type, DataArrayList **dataList );
     void pushNode( DDLNode *node );
     DDLNode *popNode();
     DDLNode *top();
@@ -172,16 +367,49 @@ public: // parser helpers
     static const char *getVersion();
 
 private:
+    bool isLazyStructure( const char *in ) const;
+    bool isIndexed( const char *in, Value::ValueType type ) const;
+    char *findClosingBracket( char *in, char *end ) const;
+    Value *parseIndexedValues( size_t open, size_t close, Value::ValueType type, size_t &numValues );
+    ThreadPool *getPool();
+    bool isParallelData( Value::ValueType type ) const;
+    size_t getNumDataChunks( size_t len );
+    char *parseParallelDataList( char *in, char *end, Value::ValueType type, Value **data, size_t &numValues );
+    char *parseParallelDataArrayList( char *in, char *end, Value::ValueType type, DataArrayList **dataList );
+    void log( LogSeverity severity, const std::string &msg ) const;
+    void closeTreeIndex();
+    size_t getStructureLevel() const;
+    bool isParallelParse() const;
+    bool parseChunks( const std::vector<size_t> &chunks );
+    bool parseChunk( const char *begin, const char *end, DDLNode *root ) const;
     OpenDDLParser( const OpenDDLParser & ) ddl_no_copy;
     OpenDDLParser &operator = ( const OpenDDLParser & ) ddl_no_copy;
 
 private:
     logCallback m_logCallback;
+    LogSeverity m_logSeverity;
     std::vector<char> m_buffer;
 
     typedef std::vector<DDLNode*> DDLNodeStack;
     DDLNodeStack m_stack;
     Context *m_context;
+    bool m_lazy;
+    size_t m_lazyDepth;
+    size_t m_levelOffset;
+    bool m_useIndex;
+    StructuralIndex m_index;
+    size_t m_treeGeneration;
+    size_t m_treeCount;
+    OpenDDLEventHandler *m_eventHandler;
+    bool m_streaming;
+    OpenDDLParseCache *m_cache;
+    bool m_parallel;
+    size_t m_numThreads;
+    size_t m_parallelThreshold;
+    ThreadPool *m_pool;
+    bool m_ownsNodes;
+    progressCallback m_progressCallback;
+    Reclaimer *m_reclaimer;
 };
 
 END_ODDLPARSER_NS
@@ -24,6 +24,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <openddlparser/OpenDDLCommon.h>
 
+#include <string.h>
+
 BEGIN_ODDLPARSER_NS
 
 template<class T>
@@ -162,12 +164,32 @@ bool isCharacter( const T in ) {
     return ( ( in >= 'a' && in <= 'z' ) || ( in >= 'A' && in <= 'Z' ) );
 }
 
+///	@brief  Returns true for the quote which starts and ends a string literal. All bracket
+/// scanners use this rule, a backslash in a literal escapes the next character.
 template<class T>
 inline
 bool isStringLiteral( const T in ) {
     return ( in == '\"' );
 }
 
+///	@brief  Skips a string literal.
+/// @param  in      [in] Pointer showing to the opening quote.
+/// @param  end     [in] The end position in the buffer.
+/// @return Pointer showing to the closing quote or end if the literal is not closed.
+template<class T>
+inline
+T *skipStringLiteral( T *in, T *end ) {
+    ++in;
+    while( in != end && !isStringLiteral( *in ) ) {
+        if( '\\' == *in && ( in + 1 ) != end ) {
+            ++in;
+        }
+        ++in;
+    }
+
+    return in;
+}
+
 template<class T>
 inline
 bool isHexLiteral( T *in, T *end ) {
@@ -213,6 +235,33 @@ static T *getNextSeparator( T *in, T *end ) {
     return in;
 }
 
+///	@brief  Looks for the bracket which closes the bracket at the given position, string literals are skipped.
+/// @param  in      [in] Pointer showing to the open bracket.
+/// @param  end     [in] The end position in the buffer.
+/// @return Pointer showing to the closing bracket or end if the bracket is not closed.
+template<class T>
+inline
+T *findMatchingBracket( T *in, T *end ) {
+    size_t depth( 0 );
+    while( in != end ) {
+        if( '{' == *in ) {
+            ++depth;
+        } else if( '}' == *in ) {
+            if( 0 == --depth ) {
+                return in;
+            }
+        } else if( isStringLiteral( *in ) ) {
+            in = skipStringLiteral( in, end );
+            if( in == end ) {
+                return end;
+            }
+        }
+        ++in;
+    }
+
+    return end;
+}
+
 static const int ErrorHex2Decimal = 9999999;
 
 inline
@@ -231,6 +280,31 @@ int hex2Decimal( char in ) {
     return ErrorHex2Decimal;
 }
 
+inline
+float halfToFloat( uint16 bits ) {
+    const uint32 sign( static_cast<uint32>( bits & 0x8000 ) << 16 );
+    uint32 exponent( ( bits >> 10 ) & 0x1F );
+    uint32 mantissa( bits & 0x3FF );
+    uint32 result( sign );
+    if( 0x1F == exponent ) {
+        result |= 0x7F800000 | ( mantissa << 13 );
+    } else if( 0 != exponent ) {
+        result |= ( ( exponent + 112 ) << 23 ) | ( mantissa << 13 );
+    } else if( 0 != mantissa ) {
+        // subnormal half, normalize the mantissa
+        exponent = 113;
+        while( 0 == ( mantissa & 0x400 ) ) {
+            mantissa <<= 1;
+            exponent--;
+        }
+        result |= ( exponent << 23 ) | ( ( mantissa & 0x3FF ) << 13 );
+    }
+
+    float value;
+    ::memcpy( &value, &result, sizeof( float ) );
+    return value;
+}
+
 template<class T>
 inline
 bool isComment( T *in, T *end ) {
@@ -0,0 +1,126 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <openddlparser/OpenDDLCommon.h>
+#include <openddlparser/DDLNode.h>
+#include <openddlparser/Value.h>
+
+#include <vector>
+#include <string>
+
+BEGIN_ODDLPARSER_NS
+
+//-------------------------------------------------------------------------------------------------
+///	@class		OpenDDLQuery
+///	@ingroup	OpenDDLParser
+///
+///	@brief  A compiled path query over the DDLNode tree.
+///
+/// A query is compiled once from an expression and can be executed many times on different trees.
+/// The expression is a list of steps separated by '/', each step matches the structure type of
+/// the child nodes. A '//' in front of a step matches all descendants instead of the direct
+/// children, a '*' matches any type. Steps can be filtered by property predicates:
+///	@code
+/// OpenDDLQuery query( "GeometryObject/Mesh[lod=0]/VertexArray[attrib=\"position\"]/float" );
+/// DDLNode::DllNodeList result;
+/// query.execute( parser.getRoot(), result );
+/// @endcode
+/// A predicate is either [key] to test for an existing property or [key=literal] to compare the
+/// property value with an integer, float, string or boolean literal. A last step naming a
+/// primitive data type ( for instance float ) keeps only the nodes storing data of this type.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT OpenDDLQuery {
+public:
+    ///	@brief  The default class constructor, the query is invalid until compiled.
+    OpenDDLQuery();
+
+    ///	@brief  The class constructor, compiles the given expression.
+    /// @param  expression  [in] The query expression.
+    OpenDDLQuery( const std::string &expression );
+
+    ///	@brief  The class destructor.
+    ~OpenDDLQuery();
+
+    ///	@brief  Compiles a new query expression.
+    /// @param  expression  [in] The query expression.
+    /// @return true if the expression is valid, false in case of a syntax error.
+    bool compile( const std::string &expression );
+
+    ///	@brief  Returns true, if a valid expression was compiled.
+    /// @return true if the query can be executed.
+    bool isValid() const;
+
+    ///	@brief  Returns the compiled expression.
+    /// @return The expression.
+    const std::string &getExpression() const;
+
+    ///	@brief  Executes the query, the search starts at the children of the given node.
+    /// @param  root    [in] The node to start the search from.
+    /// @param  result  [out] The matching nodes will be appended.
+    /// @return The number of matching nodes.
+    size_t execute( const DDLNode *root, DDLNode::DllNodeList &result ) const;
+
+    ///	@brief  Executes the query and returns the first match.
+    /// @param  root    [in] The node to start the search from.
+    /// @return The first matching node or ddl_nullptr if nothing matches.
+    DDLNode *executeFirst( const DDLNode *root ) const;
+
+private:
+    struct Predicate {
+        std::string      m_key;
+        bool             m_hasValue;
+        Value::ValueType m_type;
+        std::string      m_string;
+        int64            m_int;
+        double           m_float;
+        bool             m_bool;
+
+        Predicate();
+        bool matches( const DDLNode *node ) const;
+    };
+
+    struct Step {
+        std::string            m_type;
+        uint64                 m_typeMask;
+        bool                   m_anyType;
+        bool                   m_descendants;
+        Value::ValueType       m_dataType;
+        std::vector<Predicate> m_predicates;
+
+        Step();
+        bool matches( const DDLNode *node ) const;
+    };
+
+    void collectStep( const Step &step, const DDLNode *node, DDLNode::DllNodeList &result ) const;
+
+    OpenDDLQuery( const OpenDDLQuery & ) ddl_no_copy;
+    OpenDDLQuery &operator = ( const OpenDDLQuery & ) ddl_no_copy;
+
+private:
+    std::string m_expression;
+    std::vector<Step> m_steps;
+    bool m_valid;
+};
+
+END_ODDLPARSER_NS
@@ -0,0 +1,87 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <openddlparser/OpenDDLCommon.h>
+#include <openddlparser/DDLNode.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+BEGIN_ODDLPARSER_NS
+
+//-------------------------------------------------------------------------------------------------
+///	@class		Reclaimer
+///	@ingroup	OpenDDLParser
+///
+///	@brief  Deletes retired nodes on a background thread.
+///
+/// Releasing a big tree frees every node with its properties and values, which can take seconds.
+/// A parser with a reclaimer hands all its nodes to the reclaimer on clear instead, retired
+/// subtrees are only unlinked by the calling thread. The nodes must not be accessed after they
+/// were retired.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT Reclaimer {
+public:
+    friend class OpenDDLParser;
+
+    ///	@brief  The class constructor, starts the background thread.
+    Reclaimer();
+
+    ///	@brief  The class destructor, deletes all pending nodes and stops the background thread.
+    ~Reclaimer();
+
+    ///	@brief  Detaches a node from its parent and deletes it with its subtree in the background.
+    /// @param  node        [in] The root of the retired subtree.
+    void retire( DDLNode *node );
+
+    ///	@brief  Takes the tree of a context and deletes it in the background.
+    /// @param  context     [in] The context, its root is ddl_nullptr afterwards.
+    void retire( Context *context );
+
+    ///	@brief  Waits until all retired nodes were deleted.
+    void wait();
+
+    ///	@brief  Returns true, if retired nodes were not deleted so far.
+    /// @return true if nodes are pending.
+    bool hasPending() const;
+
+private:
+    void retireNodes( DDLNode::DllNodeList &nodes );
+    void reclaimerMain();
+
+    Reclaimer( const Reclaimer & ) ddl_no_copy;
+    Reclaimer &operator = ( const Reclaimer & ) ddl_no_copy;
+
+private:
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::deque<DDLNode::DllNodeList> m_queue;
+    size_t m_numPending;
+    bool m_stop;
+};
+
+END_ODDLPARSER_NS
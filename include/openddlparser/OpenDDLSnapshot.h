@@ -0,0 +1,159 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <openddlparser/OpenDDLCommon.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+BEGIN_ODDLPARSER_NS
+
+class DDLNode;
+class Value;
+
+class SnapshotNode;
+
+///	@brief  A shared, immutable snapshot node.
+typedef std::shared_ptr<const SnapshotNode> SnapshotNodePtr;
+
+//-------------------------------------------------------------------------------------------------
+///	@class		SnapshotNode
+///	@ingroup	OpenDDLParser
+///
+///	@brief  The immutable copy of a DDLNode inside of a snapshot.
+///
+/// The node owns copies of the type, the name and the data of its DDLNode. Subtrees which did not
+/// change between two snapshots are shared by them, and so is the data of a node whose children
+/// changed but not the node itself.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT SnapshotNode {
+public:
+    friend class Snapshot;
+
+    ///	@brief  The class destructor.
+    ~SnapshotNode();
+
+    ///	@brief  Returns the type of the node.
+    /// @return The type.
+    const std::string &getType() const;
+
+    ///	@brief  Returns the name of the node.
+    /// @return The name.
+    const std::string &getName() const;
+
+    ///	@brief  Returns the type of the name.
+    /// @return The name type.
+    NameType getNameType() const;
+
+    ///	@brief  Returns the first property of the node.
+    /// @return The first property or ddl_nullptr.
+    const Property *getProperties() const;
+
+    ///	@brief  Searches a property by its key.
+    /// @param  name    [in] The key of the property.
+    /// @return The property or ddl_nullptr if no property was found.
+    const Property *findPropertyByName( const std::string &name ) const;
+
+    ///	@brief  Returns the first value of the node.
+    /// @return The first value or ddl_nullptr.
+    const Value *getValue() const;
+
+    ///	@brief  Returns the data array list of the node.
+    /// @return The data array list or ddl_nullptr.
+    const DataArrayList *getDataArrayList() const;
+
+    ///	@brief  Returns the references of the node.
+    /// @return The references or ddl_nullptr.
+    const Reference *getReferences() const;
+
+    ///	@brief  Returns the child nodes.
+    /// @return The child nodes in document order.
+    const std::vector<SnapshotNodePtr> &getChildNodeList() const;
+
+private:
+    struct Data;
+
+    SnapshotNode();
+    SnapshotNode( const SnapshotNode & ) ddl_no_copy;
+    SnapshotNode &operator = ( const SnapshotNode & ) ddl_no_copy;
+
+private:
+    std::shared_ptr<const Data> m_data;
+    std::vector<SnapshotNodePtr> m_children;
+};
+
+class Snapshot;
+
+///	@brief  A shared, immutable snapshot.
+typedef std::shared_ptr<const Snapshot> SnapshotPtr;
+
+//-------------------------------------------------------------------------------------------------
+///	@class		Snapshot
+///	@ingroup	OpenDDLParser
+///
+///	@brief  An immutable copy of a node tree, which stays valid while the tree is changed.
+///
+/// A snapshot is taken by the thread which changes the tree, the snapshot itself can be read by
+/// any number of threads. Each DDLNode keeps its last snapshot node and tracks its changes, so a
+/// new snapshot only copies the changed nodes and the paths from them to the root, all other
+/// subtrees are shared with the former snapshot. Changes must be done by the setters of the
+/// nodes, in-place changes of values or properties need a DDLNode::touch.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT Snapshot {
+public:
+    ///	@brief  The class destructor.
+    ~Snapshot();
+
+    ///	@brief  Takes a snapshot of the tree of a context.
+    /// @param  context     [in] The context.
+    /// @return The snapshot or an empty pointer if the context has no tree.
+    static SnapshotPtr take( Context *context );
+
+    ///	@brief  Takes a snapshot of a subtree.
+    /// @param  root        [in] The root of the subtree.
+    /// @return The snapshot or an empty pointer if root is ddl_nullptr.
+    static SnapshotPtr take( DDLNode *root );
+
+    ///	@brief  Returns the root node.
+    /// @return The root node.
+    const SnapshotNode *getRoot() const;
+
+    ///	@brief  Returns the version, later snapshots have higher versions.
+    /// @return The version.
+    size_t getVersion() const;
+
+private:
+    Snapshot( const SnapshotNodePtr &root, size_t version );
+    Snapshot( const Snapshot & ) ddl_no_copy;
+    Snapshot &operator = ( const Snapshot & ) ddl_no_copy;
+
+    static SnapshotNodePtr takeNode( DDLNode *node );
+
+private:
+    SnapshotNodePtr m_root;
+    size_t m_version;
+};
+
+END_ODDLPARSER_NS
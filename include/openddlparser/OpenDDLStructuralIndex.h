@@ -0,0 +1,116 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <openddlparser/OpenDDLCommon.h>
+
+#include <vector>
+
+BEGIN_ODDLPARSER_NS
+
+//-------------------------------------------------------------------------------------------------
+///	@class		StructuralIndex
+///	@ingroup	OpenDDLParser
+///
+///	@brief  Stores the positions of all structural characters of an OpenDDL buffer.
+///
+/// The index is the first stage of the indexed parse mode. The buffer is classified in blocks of
+/// 16 bytes ( SSE2 is used when available ) and the positions of the characters {}[](),= and of
+/// the quotes are stored in document order. Characters inside of string literals and comments
+/// are masked out. Each bracket knows the index of its partner, so the parser can jump over
+/// bodies and data lists without scanning the bytes again.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT StructuralIndex {
+public:
+    ///	@brief  Marks an invalid index.
+    static const size_t InvalidIndex;
+
+    ///	@brief  The class constructor.
+    StructuralIndex();
+
+    ///	@brief  The class destructor.
+    ~StructuralIndex();
+
+    ///	@brief  Builds the index for a new buffer, the buffer must stay valid while the index is used.
+    /// @param  buffer      [in] The buffer.
+    /// @param  len         [in] The size of the buffer, must be lower than 4 GB.
+    /// @return true in case of success, false if the buffer is too big.
+    bool build( const char *buffer, size_t len );
+
+    ///	@brief  Clears the index.
+    void clear();
+
+    ///	@brief  Returns true, if no index is stored.
+    /// @return true if the index is empty.
+    bool empty() const;
+
+    ///	@brief  Returns the number of indexed characters.
+    /// @return The number of indexed characters.
+    size_t size() const;
+
+    ///	@brief  Returns true, if all brackets of the indexed buffer are balanced.
+    /// @return true if the brackets are balanced.
+    bool isBalanced() const;
+
+    ///	@brief  Returns the buffer position of an indexed character.
+    /// @param  idx     [in] The index.
+    /// @return The position in the buffer.
+    size_t getPosition( size_t idx ) const;
+
+    ///	@brief  Returns the indexed character.
+    /// @param  idx     [in] The index.
+    /// @return The character.
+    char getToken( size_t idx ) const;
+
+    ///	@brief  Returns the index of the partner bracket.
+    /// @param  idx     [in] The index of a bracket.
+    /// @return The index of the partner or InvalidIndex if the character is no bracket or unbalanced.
+    size_t getMatch( size_t idx ) const;
+
+    ///	@brief  Looks for the first indexed character at or behind a buffer position.
+    /// @param  pos     [in] The buffer position.
+    /// @return The index or InvalidIndex if there is no indexed character behind the position.
+    size_t find( size_t pos ) const;
+
+    ///	@brief  Returns true, if the buffer position is covered by the index.
+    /// @param  ptr     [in] The pointer to check.
+    /// @return true if the pointer is part of the indexed buffer.
+    bool contains( const char *ptr ) const;
+
+    ///	@brief  Returns the indexed buffer.
+    /// @return The buffer.
+    const char *getBuffer() const;
+
+private:
+    StructuralIndex( const StructuralIndex & ) ddl_no_copy;
+    StructuralIndex &operator = ( const StructuralIndex & ) ddl_no_copy;
+
+private:
+    const char *m_buffer;
+    size_t m_len;
+    std::vector<uint32> m_positions;
+    std::vector<uint32> m_matches;
+    bool m_balanced;
+};
+
+END_ODDLPARSER_NS
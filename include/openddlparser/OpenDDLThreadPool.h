@@ -0,0 +1,93 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <openddlparser/OpenDDLCommon.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+BEGIN_ODDLPARSER_NS
+
+//-------------------------------------------------------------------------------------------------
+///	@class		ThreadPool
+///	@ingroup	OpenDDLParser
+///
+///	@brief  A simple pool of worker threads.
+///
+/// Tasks are executed in the order they were enqueued. parallelFor distributes the indices of a
+/// range over the workers and the calling thread and returns when all indices were handled.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT ThreadPool {
+public:
+    ///	@brief  The task type.
+    typedef std::function<void()> Task;
+
+    ///	@brief  The class constructor.
+    /// @param  numThreads  [in] The number of worker threads, 0 uses one thread per hardware thread.
+    ThreadPool( size_t numThreads = 0 );
+
+    ///	@brief  The class destructor, waits for all enqueued tasks.
+    ~ThreadPool();
+
+    ///	@brief  Returns the number of worker threads.
+    /// @return The number of worker threads.
+    size_t getNumThreads() const;
+
+    ///	@brief  Enqueues a new task.
+    /// @param  task        [in] The task to execute.
+    void enqueue( const Task &task );
+
+    ///	@brief  Waits until all enqueued tasks were executed.
+    void wait();
+
+    ///	@brief  Calls the function for all indices of [0, count) and waits for the result.
+    /// @param  count       [in] The number of indices.
+    /// @param  func        [in] The function to call with each index.
+    void parallelFor( size_t count, const std::function<void( size_t )> &func );
+
+    ///	@brief  Returns the number of hardware threads, at least 1.
+    /// @return The number of hardware threads.
+    static size_t getHardwareThreads();
+
+private:
+    void workerMain();
+
+    ThreadPool( const ThreadPool & ) ddl_no_copy;
+    ThreadPool &operator = ( const ThreadPool & ) ddl_no_copy;
+
+private:
+    std::vector<std::thread> m_workers;
+    std::deque<Task> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_taskAvailable;
+    std::condition_variable m_tasksDone;
+    size_t m_active;
+    bool m_stop;
+};
+
+END_ODDLPARSER_NS
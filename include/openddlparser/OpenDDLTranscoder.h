@@ -0,0 +1,88 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <openddlparser/OpenDDLParser.h>
+
+BEGIN_ODDLPARSER_NS
+
+class OpenDDLExport;
+
+//-------------------------------------------------------------------------------------------------
+///	@class		OpenDDLTranscoder
+///	@ingroup	OpenDDLParser
+///
+///	@brief  Writes a document to an exporter while it is parsed.
+///
+/// The transcoder receives the structure events of the parser and passes them to the exporter,
+/// the parser runs in streaming mode. So a document can be re-serialized or filtered without
+/// building the node tree, only the nodes of the open structures are alive. transcode uses the
+/// parser buffer, which holds the whole input. transcodeFile reads the file block by block and
+/// drops each top-level structure after it was written, so big files need bounded memory.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT OpenDDLTranscoder : public OpenDDLEventHandler {
+public:
+    ///	@brief  The filter callback, returns false to drop a structure including its children.
+    /// Only the header of the node ( type, name and properties ) is available.
+    typedef bool( *nodeFilterCallback )( const DDLNode *node );
+
+public:
+    ///	@brief  The class constructor.
+    /// @param  exporter    [in] The exporter to write to, the transcoder does not take the ownership.
+    OpenDDLTranscoder( OpenDDLExport *exporter );
+
+    ///	@brief  The class destructor.
+    virtual ~OpenDDLTranscoder();
+
+    ///	@brief  Sets the filter callback, ddl_nullptr writes all structures.
+    /// @param  filter      [in] The filter callback.
+    void setFilter( nodeFilterCallback filter );
+
+    ///	@brief  Parses the buffer of the parser and writes all structures to the exporter.
+    /// @param  parser      [in] The parser with the buffer to transcode.
+    /// @return true in case of success, false in case of a parse or write error.
+    bool transcode( OpenDDLParser &parser );
+
+    ///	@brief  Reads a file block by block and writes all structures to the exporter.
+    /// @param  parser      [in] The parser, its buffer is replaced by the parsed blocks.
+    /// @param  filename    [in] The name of the file.
+    /// @param  blockSize   [in] The read block size in bytes, 0 uses the default block size.
+    /// @return true in case of success, false in case of a read, parse or write error.
+    bool transcodeFile( OpenDDLParser &parser, const std::string &filename, size_t blockSize = 0 );
+
+    virtual bool onStructureBegin( DDLNode *node, size_t level );
+    virtual bool onStructureEnd( DDLNode *node, size_t level );
+
+private:
+    OpenDDLTranscoder( const OpenDDLTranscoder & ) ddl_no_copy;
+    OpenDDLTranscoder &operator = ( const OpenDDLTranscoder & ) ddl_no_copy;
+    bool run( OpenDDLParser &parser, const std::string &filename, size_t blockSize );
+
+private:
+    OpenDDLExport *m_exporter;
+    nodeFilterCallback m_filter;
+    size_t m_skipLevel;
+    bool m_success;
+};
+
+END_ODDLPARSER_NS
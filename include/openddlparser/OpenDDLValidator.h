@@ -0,0 +1,105 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#pragma once
+
+#include <openddlparser/OpenDDLCommon.h>
+#include <openddlparser/OpenDDLParser.h>
+
+#include <string>
+#include <vector>
+
+BEGIN_ODDLPARSER_NS
+
+class DDLNode;
+class ThreadPool;
+
+///	@brief  One finding of the validation.
+struct DLL_ODDLPARSER_EXPORT Diagnostic {
+    LogSeverity     m_severity; ///< The severity, ddl_error_msg or ddl_warn_msg.
+    const DDLNode  *m_node;     ///< The node the finding belongs to.
+    std::string     m_message;  ///< The description.
+
+    ///	@brief  The class constructor.
+    Diagnostic( LogSeverity severity, const DDLNode *node, const std::string &message );
+};
+
+//-------------------------------------------------------------------------------------------------
+///	@class		OpenDDLValidator
+///	@ingroup	OpenDDLParser
+///
+///	@brief  Checks the structural rules and the references of a node tree in parallel.
+///
+/// The following rules are checked:
+/// - Global names are unique in the whole tree.
+/// - Local names are unique between the children of a structure.
+/// - The property keys of a structure are unique.
+/// - All subarrays of a data array list have the same size.
+/// - Every referenced name exists. A global name is searched in the whole tree, a local one in
+///   the children of the referencing structure and then outwards in the children of its parents.
+///
+/// The tree is split into subtrees in document order. The global names are collected from all
+/// subtrees in parallel and merged in document order, the first definition of a name wins. Then
+/// the subtrees are checked in parallel, each one into an own list. The lists are appended in
+/// document order, so the diagnostics do not depend on the number of threads.
+//-------------------------------------------------------------------------------------------------
+class DLL_ODDLPARSER_EXPORT OpenDDLValidator {
+public:
+    ///	@brief  The class constructor.
+    /// @param  numThreads  [in] The number of worker threads, 0 uses one thread per hardware thread.
+    OpenDDLValidator( size_t numThreads = 0 );
+
+    ///	@brief  The class destructor.
+    ~OpenDDLValidator();
+
+    ///	@brief  Validates a node tree, the diagnostics of a former call are cleared.
+    /// @param  root        [in] The root node.
+    /// @return true if no error was found.
+    bool validate( const DDLNode *root );
+
+    ///	@brief  Validates the tree of a context.
+    /// @param  ctx         [in] The context.
+    /// @return true if no error was found.
+    bool validate( const Context *ctx );
+
+    ///	@brief  Returns the diagnostics of the last validation in document order.
+    /// @return The diagnostics.
+    const std::vector<Diagnostic> &getDiagnostics() const;
+
+    ///	@brief  Returns the number of errors of the last validation.
+    /// @return The number of errors.
+    size_t getNumErrors() const;
+
+    ///	@brief  Removes all diagnostics.
+    void clear();
+
+private:
+    OpenDDLValidator( const OpenDDLValidator & ) ddl_no_copy;
+    OpenDDLValidator &operator = ( const OpenDDLValidator & ) ddl_no_copy;
+
+private:
+    size_t m_numThreads;
+    ThreadPool *m_pool;
+    std::vector<Diagnostic> m_diagnostics;
+};
+
+END_ODDLPARSER_NS
@@ -75,9 +75,11 @@ public:
         Value *getNext();
 
         ///	@brief  The post-increment operator.
+        /// @return A copy of the iterator before the increment.
         const Iterator operator++( int );
 
-        ///	@brief  The pre-increment operator.
+        ///	@brief  The pre-increment operator, does nothing at the end of the list.
+        /// @return The iterator itself.
         Iterator &operator++( );
 
         ///	@brief  The compare operator.
@@ -130,7 +132,7 @@ public:
 
     ///	@brief  Returns the boolean value.
     /// @return The boolean value.
-    bool getBool();
+    bool getBool() const;
 
     ///	@brief  Assigns a int8 to the value.
     /// @param  value       [in] The value.
@@ -138,7 +140,7 @@ public:
 
     ///	@brief  Returns the int8 value.
     /// @return The int8 value.
-    int8 getInt8();
+    int8 getInt8() const;
 
     ///	@brief  Assigns a int16 to the value.
     /// @param  value       [in] The value.
@@ -146,7 +148,7 @@ public:
 
     ///	@brief  Returns the int16 value.
     /// @return The int16 value.
-    int16 getInt16();
+    int16 getInt16() const;
 
     ///	@brief  Assigns a int32 to the value.
     /// @param  value       [in] The value.
@@ -154,7 +156,7 @@ public:
 
     ///	@brief  Returns the int16 value.
     /// @return The int32 value.
-    int32 getInt32();
+    int32 getInt32() const;
 
     ///	@brief  Assigns a int64 to the value.
     /// @param  value       [in] The value.
@@ -162,7 +164,7 @@ public:
 
     ///	@brief  Returns the int16 value.
     /// @return The int64 value.
-    int64 getInt64();
+    int64 getInt64() const;
 
     ///	@brief  Assigns a unsigned int8 to the value.
     /// @param  value       [in] The value.
@@ -229,7 +231,7 @@ public:
     Reference *getRef() const;
 
     ///	@brief  Dumps the value.
-    void dump();
+    void dump() const;
 
     ///	@brief  Assigns the next value.
     ///	@param  next        [n] The next value.
@@ -241,7 +243,7 @@ public:
 
     /// @brief  Gets the length of the array.
     /// @return The number of items in the array.
-    size_t size();
+    size_t size() const;
 
     ValueType m_type;
     size_t m_size;
@@ -260,6 +262,11 @@ struct DLL_ODDLPARSER_EXPORT ValueAllocator {
     static Value *allocPrimData( Value::ValueType type, size_t len = 1 );
     static void releasePrimData( Value **data );
 
+    ///	@brief  Copies a single value, the next value is not copied.
+    /// @param  value   [in] The value to copy.
+    /// @return The copy or ddl_nullptr.
+    static Value *copyPrimData( const Value *value );
+
 private:
     ValueAllocator() ddl_no_copy;
     ValueAllocator( const ValueAllocator  & ) ddl_no_copy;
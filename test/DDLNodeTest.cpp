@@ -142,6 +142,19 @@ TEST_F( DDLNodeTest, findPropertyByNameTest ) {
     EXPECT_EQ( first, prop );
 }
 
+TEST_F( DDLNodeTest, constPropertyAccessTest ) {
+    DDLNode *node = DDLNode::create( "test", "testName" );
+    ASSERT_FALSE( ddl_nullptr == node );
+    Text *id = new Text( "test", 4 );
+    Property *first = new Property( id );
+    node->setProperties( first );
+
+    const DDLNode *constNode( node );
+    EXPECT_TRUE( constNode->hasProperty( "test" ) );
+    EXPECT_EQ( first, constNode->findPropertyByName( "test" ) );
+    EXPECT_FALSE( constNode->hasProperty( "other" ) );
+}
+
 TEST_F( DDLNodeTest, accessValueTest ) {
     DDLNode *myNode = DDLNode::create( "test", "name" );
     ASSERT_FALSE( ddl_nullptr == myNode );
@@ -172,4 +185,72 @@ TEST_F( DDLNodeTest, accessReferencesTest ) {
     EXPECT_EQ( ref, myNode->getReferences() );
 }
 
+TEST_F( DDLNodeTest, treeIndexTest ) {
+    DDLNode *root = DDLNode::create( "root", "" );
+    DDLNode *a = DDLNode::create( "a", "", root );
+    DDLNode *b = DDLNode::create( "b", "", a );
+    DDLNode *c = DDLNode::create( "c", "", root );
+    EXPECT_EQ( DDLNode::InvalidTreeIndex, root->getTreeIndex() );
+    EXPECT_EQ( 0U, root->getSubtreeSize() );
+
+    // unnumbered nodes are checked by walking the parents
+    EXPECT_TRUE( root->isAncestorOf( b ) );
+    EXPECT_FALSE( c->isAncestorOf( b ) );
+
+    root->updateTreeIndex();
+    EXPECT_EQ( 0U, root->getTreeIndex() );
+    EXPECT_EQ( 1U, a->getTreeIndex() );
+    EXPECT_EQ( 2U, b->getTreeIndex() );
+    EXPECT_EQ( 3U, c->getTreeIndex() );
+    EXPECT_EQ( 4U, root->getSubtreeSize() );
+    EXPECT_EQ( 2U, a->getSubtreeSize() );
+    EXPECT_TRUE( root->isAncestorOf( b ) );
+    EXPECT_TRUE( a->isAncestorOf( b ) );
+    EXPECT_TRUE( b->isDescendantOf( root ) );
+    EXPECT_FALSE( c->isAncestorOf( b ) );
+    EXPECT_FALSE( b->isAncestorOf( b ) );
+    EXPECT_FALSE( b->isAncestorOf( a ) );
+
+    // moved subtrees lose their index, the check stays correct
+    b->attachParent( c );
+    EXPECT_EQ( DDLNode::InvalidTreeIndex, b->getTreeIndex() );
+    EXPECT_TRUE( c->isAncestorOf( b ) );
+    EXPECT_FALSE( a->isAncestorOf( b ) );
+    EXPECT_TRUE( root->isAncestorOf( b ) );
+
+    // nodes of another tree are never related
+    DDLNode *other = DDLNode::create( "other", "" );
+    DDLNode *otherChild = DDLNode::create( "otherChild", "", other );
+    other->updateTreeIndex();
+    EXPECT_FALSE( root->isAncestorOf( otherChild ) );
+    EXPECT_TRUE( other->isAncestorOf( otherChild ) );
+}
+
+TEST_F( DDLNodeTest, subtreeTypeMaskTest ) {
+    DDLNode *root = DDLNode::create( "root", "" );
+    DDLNode *geometry = DDLNode::create( "GeometryNode", "", root );
+    DDLNode *mesh = DDLNode::create( "Mesh", "", geometry );
+    DDLNode *metric = DDLNode::create( "Metric", "", root );
+    DDLNode *animation = DDLNode::create( "Animation", "", mesh );
+
+    EXPECT_TRUE( root->mayContainType( "Animation" ) );
+    EXPECT_TRUE( geometry->mayContainType( "Animation" ) );
+    EXPECT_EQ( DDLNode::getTypeMask( "Metric" ), metric->getSubtreeTypeMask() );
+    EXPECT_FALSE( metric->mayContainType( "Animation" ) );
+
+    DDLNode::DllNodeList result;
+    EXPECT_EQ( 1U, root->findNodesByType( "Animation", result ) );
+    ASSERT_EQ( 1U, result.size() );
+    EXPECT_EQ( animation, result[ 0 ] );
+    EXPECT_EQ( animation, root->findFirstNodeByType( "Animation" ) );
+    EXPECT_EQ( ddl_nullptr, root->findFirstNodeByType( "Skin" ) );
+
+    // changed types and moved nodes are added to the summary of the new parents
+    metric->setType( "Skin" );
+    EXPECT_TRUE( root->mayContainType( "Skin" ) );
+    animation->attachParent( metric );
+    EXPECT_TRUE( metric->mayContainType( "Animation" ) );
+    EXPECT_EQ( animation, metric->findFirstNodeByType( "Animation" ) );
+}
+
 END_ODDLPARSER_NS
@@ -0,0 +1,128 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "gtest/gtest.h"
+
+#include <openddlparser/OpenDDLAsyncLogger.h>
+#include <openddlparser/OpenDDLThreadPool.h>
+
+#include <cstring>
+
+BEGIN_ODDLPARSER_NS
+
+class AsyncLoggerTest : public testing::Test {
+protected:
+    // only written by the drain thread, read after a flush
+    static std::vector<std::string> s_messages;
+    static size_t s_numErrors;
+
+    static void collectMessage( LogSeverity severity, const std::string &msg ) {
+        s_messages.push_back( msg );
+        if( ddl_error_msg == severity ) {
+            s_numErrors++;
+        }
+    }
+
+    virtual void SetUp() {
+        s_messages.clear();
+        s_numErrors = 0;
+    }
+
+    virtual void TearDown() {
+        AsyncLogger::stop();
+    }
+};
+
+std::vector<std::string> AsyncLoggerTest::s_messages;
+size_t AsyncLoggerTest::s_numErrors = 0;
+
+TEST_F( AsyncLoggerTest, logTest ) {
+    EXPECT_FALSE( AsyncLogger::isRunning() );
+    EXPECT_FALSE( AsyncLogger::start( ddl_nullptr ) );
+    ASSERT_TRUE( AsyncLogger::start( &AsyncLoggerTest::collectMessage, 1 << 14 ) );
+    EXPECT_TRUE( AsyncLogger::isRunning() );
+    EXPECT_FALSE( AsyncLogger::start( &AsyncLoggerTest::collectMessage ) );
+
+    ThreadPool pool( 4 );
+    pool.parallelFor( 8, []( size_t ) {
+        for( size_t j = 0; j < 1000; j++ ) {
+            AsyncLogger::log( 0 == j % 2 ? ddl_error_msg : ddl_info_msg, "message" );
+        }
+    } );
+    AsyncLogger::flush();
+    EXPECT_EQ( 0U, AsyncLogger::getNumDropped() );
+    EXPECT_EQ( 8000U, s_messages.size() );
+    EXPECT_EQ( 4000U, s_numErrors );
+
+    AsyncLogger::stop();
+    EXPECT_FALSE( AsyncLogger::isRunning() );
+
+    // messages after the stop are dropped
+    AsyncLogger::log( ddl_error_msg, "dropped" );
+    EXPECT_EQ( 1U, AsyncLogger::getNumDropped() );
+}
+
+TEST_F( AsyncLoggerTest, fullRingTest ) {
+    ASSERT_TRUE( AsyncLogger::start( &AsyncLoggerTest::collectMessage, 4 ) );
+    for( size_t i = 0; i < 10000; i++ ) {
+        AsyncLogger::log( ddl_warn_msg, "message" );
+    }
+
+    // the stop passes all stored messages, every message is either passed or dropped
+    AsyncLogger::stop();
+    EXPECT_EQ( 10000U, s_messages.size() + AsyncLogger::getNumDropped() );
+}
+
+TEST_F( AsyncLoggerTest, concurrentFlushTest ) {
+    ASSERT_TRUE( AsyncLogger::start( &AsyncLoggerTest::collectMessage, 1 << 14 ) );
+
+    // every flush returns once the drain thread signals its messages
+    ThreadPool pool( 4 );
+    pool.parallelFor( 8, []( size_t ) {
+        for( size_t j = 0; j < 100; j++ ) {
+            AsyncLogger::log( ddl_info_msg, "message" );
+            AsyncLogger::flush();
+        }
+    } );
+    AsyncLogger::flush();
+    EXPECT_EQ( 0U, AsyncLogger::getNumDropped() );
+    EXPECT_EQ( 800U, s_messages.size() );
+
+    // a flush of a stopped logger returns at once
+    AsyncLogger::stop();
+    AsyncLogger::flush();
+}
+
+TEST_F( AsyncLoggerTest, parserLogTest ) {
+    ASSERT_TRUE( AsyncLogger::start( &AsyncLoggerTest::collectMessage ) );
+    char token[] = "GeometryNode ] {}";
+    OpenDDLParser theParser;
+    theParser.setLogCallback( &AsyncLogger::log );
+    theParser.setBuffer( token, strlen( token ) );
+    EXPECT_FALSE( theParser.parse() );
+
+    AsyncLogger::flush();
+    ASSERT_EQ( 1U, s_messages.size() );
+    EXPECT_EQ( 1U, s_numErrors );
+}
+
+END_ODDLPARSER_NS
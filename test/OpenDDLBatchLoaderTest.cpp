@@ -0,0 +1,154 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "gtest/gtest.h"
+
+#include <openddlparser/OpenDDLBatchLoader.h>
+#include <openddlparser/OpenDDLParser.h>
+#include <openddlparser/DDLNode.h>
+
+#include "UnitTestCommon.h"
+
+#include <cstdio>
+#include <sstream>
+
+#ifdef _WIN32
+#   include <direct.h>
+#else
+#   include <sys/stat.h>
+#endif // _WIN32
+
+BEGIN_ODDLPARSER_NS
+
+class OpenDDLBatchLoaderTest : public testing::Test {
+protected:
+    std::string m_directory;
+    std::vector<std::string> m_files;
+
+    virtual void SetUp() {
+        m_directory = "batchLoaderTest";
+#ifdef _WIN32
+        ::_mkdir( m_directory.c_str() );
+#else
+        ::mkdir( m_directory.c_str(), 0755 );
+#endif // _WIN32
+    }
+
+    virtual void TearDown() {
+        for( size_t i = 0; i < m_files.size(); i++ ) {
+            ::remove( m_files[ i ].c_str() );
+        }
+        ::remove( m_directory.c_str() );
+    }
+
+    std::string writeFile( const std::string &name, const std::string &content ) {
+        const std::string path( m_directory + "/" + name );
+        FILE *file( ::fopen( path.c_str(), "wb" ) );
+        EXPECT_NE( ddl_nullptr, file );
+        if( ddl_nullptr != file ) {
+            ::fwrite( content.c_str(), 1, content.size(), file );
+            ::fclose( file );
+            m_files.push_back( path );
+        }
+
+        return path;
+    }
+
+    static std::string createDocument( size_t numNodes ) {
+        std::stringstream stream;
+        for( size_t i = 0; i < numNodes; i++ ) {
+            stream << "GeometryNode $node" << i << " { Metric { float { " << i << ", 2 } } }\n";
+        }
+
+        return stream.str();
+    }
+};
+
+TEST_F( OpenDDLBatchLoaderTest, loadTest ) {
+    // one big file and many small ones
+    std::vector<std::string> paths;
+    for( size_t i = 0; i < 40; i++ ) {
+        std::stringstream name;
+        name << "file" << i << ".ogex";
+        paths.push_back( writeFile( name.str(), createDocument( 0 == i % 20 ? 2000 : i % 5 + 1 ) ) );
+    }
+
+    OpenDDLBatchLoader loader( 3 );
+    loader.setUseStructuralIndex( true );
+    EXPECT_TRUE( loader.isStructuralIndexEnabled() );
+    ASSERT_TRUE( loader.load( paths ) );
+    ASSERT_EQ( paths.size(), loader.getNumResults() );
+
+    // the nodes of the batch are independent from other parsers
+    OpenDDLParser theParser;
+    const std::string token( createDocument( 1 ) );
+    theParser.setBuffer( token.c_str(), token.size() );
+    EXPECT_TRUE( theParser.parse() );
+    theParser.clear();
+
+    for( size_t i = 0; i < paths.size(); i++ ) {
+        const BatchResult &result( loader.getResult( i ) );
+        EXPECT_EQ( paths[ i ], result.m_path );
+        EXPECT_TRUE( result.m_error.empty() );
+        EXPECT_LT( 0U, result.m_size );
+        EXPECT_LE( 0.0, result.m_readTime );
+        EXPECT_LE( 0.0, result.m_parseTime );
+        ASSERT_NE( ddl_nullptr, result.m_context );
+        ASSERT_NE( ddl_nullptr, result.m_context->m_root );
+
+        const DDLNode::DllNodeList &childs( result.m_context->m_root->getChildNodeList() );
+        ASSERT_EQ( 0 == i % 20 ? 2000U : i % 5 + 1, childs.size() );
+        DDLNode *last( childs.back() );
+        std::stringstream name;
+        name << "node" << childs.size() - 1;
+        EXPECT_EQ( name.str(), last->getName() );
+        ASSERT_EQ( 1U, last->getChildNodeList().size() );
+        ASSERT_NE( ddl_nullptr, last->getChildNodeList()[ 0 ]->getValue() );
+        EXPECT_FLOAT_EQ( static_cast<float>( childs.size() - 1 ), last->getChildNodeList()[ 0 ]->getValue()->getFloat() );
+    }
+
+    loader.clear();
+    EXPECT_EQ( 0U, loader.getNumResults() );
+}
+
+TEST_F( OpenDDLBatchLoaderTest, errorTest ) {
+    std::vector<std::string> paths;
+    paths.push_back( writeFile( "valid.ogex", createDocument( 3 ) ) );
+    paths.push_back( m_directory + "/missing.ogex" );
+    paths.push_back( writeFile( "empty.ogex", "" ) );
+
+    OpenDDLBatchLoader loader;
+    EXPECT_FALSE( loader.load( paths ) );
+    ASSERT_EQ( 3U, loader.getNumResults() );
+    ASSERT_NE( ddl_nullptr, loader.getResult( 0 ).m_context );
+    EXPECT_EQ( 3U, loader.getResult( 0 ).m_context->m_root->getChildNodeList().size() );
+    EXPECT_EQ( ddl_nullptr, loader.getResult( 1 ).m_context );
+    EXPECT_FALSE( loader.getResult( 1 ).m_error.empty() );
+    EXPECT_EQ( ddl_nullptr, loader.getResult( 2 ).m_context );
+    EXPECT_FALSE( loader.getResult( 2 ).m_error.empty() );
+
+    // a new batch replaces the results
+    EXPECT_TRUE( loader.load( std::vector<std::string>() ) );
+    EXPECT_EQ( 0U, loader.getNumResults() );
+}
+
+END_ODDLPARSER_NS
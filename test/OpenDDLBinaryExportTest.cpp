@@ -0,0 +1,141 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "gtest/gtest.h"
+
+#include <openddlparser/OpenDDLBinaryExport.h>
+#include <openddlparser/OpenDDLParser.h>
+#include <openddlparser/DDLNode.h>
+
+#include "UnitTestCommon.h"
+
+BEGIN_ODDLPARSER_NS
+
+class OpenDDLBinaryExportTest : public testing::Test {
+protected:
+    template<class T>
+    static T readAt( const std::vector<char> &buffer, size_t pos ) {
+        T data;
+        ::memcpy( &data, &buffer[ pos ], sizeof( T ) );
+        return data;
+    }
+
+    static std::string readString( const std::vector<char> &buffer, uint32 id ) {
+        const BinaryHeader header( readAt<BinaryHeader>( buffer, 0 ) );
+        const BinaryString entry( readAt<BinaryString>( buffer, header.m_stringTableOffset + id * sizeof( BinaryString ) ) );
+        return std::string( &buffer[ header.m_stringTableOffset + entry.m_offset ], entry.m_length );
+    }
+};
+
+static const char BinaryToken[] =
+    "GeometryNode $node1 {\n"
+    "    Metric (key = \"distance\") { float { 1.5, 2, 3 } }\n"
+    "    Metric (key = \"angle\") { float { 4 } }\n"
+    "    Array { int32[ 2 ] { { 1, 2 }, { 3, 4 } } }\n"
+    "    Names { string { \"a\", \"b\" } }\n"
+    "}\n";
+
+TEST_F( OpenDDLBinaryExportTest, exportTest ) {
+    OpenDDLParser theParser;
+    theParser.setBuffer( BinaryToken, strlen( BinaryToken ) );
+    ASSERT_TRUE( theParser.parse() );
+
+    std::vector<char> buffer;
+    OpenDDLBinaryExport myExporter;
+    ASSERT_TRUE( myExporter.exportContext( theParser.getContext(), buffer ) );
+    ASSERT_LE( sizeof( BinaryHeader ), buffer.size() );
+
+    const BinaryHeader header( readAt<BinaryHeader>( buffer, 0 ) );
+    EXPECT_EQ( 0, ::memcmp( header.m_magic, BinaryMagic, sizeof( BinaryMagic ) ) );
+    EXPECT_EQ( BinaryVersion, header.m_version );
+    EXPECT_EQ( buffer.size(), header.m_fileSize );
+    EXPECT_EQ( 0U, header.m_rootOffset % BinaryAlignment );
+    EXPECT_EQ( 0U, header.m_stringTableOffset % BinaryAlignment );
+
+    const BinaryStructure root( readAt<BinaryStructure>( buffer, header.m_rootOffset ) );
+    EXPECT_EQ( 1U, root.m_numChildren );
+    EXPECT_EQ( header.m_stringTableOffset - header.m_rootOffset, root.m_size );
+
+    const size_t nodePos( header.m_rootOffset + readAt<uint32>( buffer, header.m_rootOffset + sizeof( BinaryStructure ) ) );
+    const BinaryStructure node( readAt<BinaryStructure>( buffer, nodePos ) );
+    EXPECT_EQ( "GeometryNode", readString( buffer, node.m_type ) );
+    EXPECT_EQ( "node1", readString( buffer, node.m_name ) );
+    ASSERT_EQ( 4U, node.m_numChildren );
+
+    // both metrics share the interned type name
+    const size_t childOffsets( nodePos + sizeof( BinaryStructure ) );
+    const BinaryStructure metric1( readAt<BinaryStructure>( buffer, nodePos + readAt<uint32>( buffer, childOffsets ) ) );
+    const BinaryStructure metric2( readAt<BinaryStructure>( buffer, nodePos + readAt<uint32>( buffer, childOffsets + 4 ) ) );
+    EXPECT_EQ( metric1.m_type, metric2.m_type );
+    EXPECT_EQ( BinaryNoString, metric1.m_name );
+    EXPECT_EQ( 1U, metric1.m_numProperties );
+    EXPECT_EQ( 1U, metric1.m_numData );
+
+    // the float list is stored as raw aligned array
+    size_t pos( nodePos + readAt<uint32>( buffer, childOffsets ) + sizeof( BinaryStructure ) );
+    const BinaryProperty prop( readAt<BinaryProperty>( buffer, pos ) );
+    EXPECT_EQ( "key", readString( buffer, prop.m_key ) );
+    EXPECT_EQ( static_cast<uint32>( Value::ddl_string ), prop.m_type );
+    EXPECT_EQ( "distance", readString( buffer, static_cast<uint32>( prop.m_value ) ) );
+    pos += sizeof( BinaryProperty );
+    const BinaryData data( readAt<BinaryData>( buffer, pos ) );
+    EXPECT_EQ( static_cast<uint32>( Value::ddl_float ), data.m_type );
+    EXPECT_EQ( 0U, data.m_arraySize );
+    ASSERT_EQ( 3U, data.m_numValues );
+    EXPECT_EQ( 16U, data.m_payloadSize );
+    pos += sizeof( BinaryData );
+    EXPECT_EQ( 0U, pos % BinaryAlignment );
+    EXPECT_FLOAT_EQ( 1.5f, readAt<float>( buffer, pos ) );
+    EXPECT_FLOAT_EQ( 2.0f, readAt<float>( buffer, pos + 4 ) );
+    EXPECT_FLOAT_EQ( 3.0f, readAt<float>( buffer, pos + 8 ) );
+
+    // the array list keeps the size of the sub-arrays
+    const size_t arrayPos( nodePos + readAt<uint32>( buffer, childOffsets + 8 ) );
+    const BinaryStructure array( readAt<BinaryStructure>( buffer, arrayPos ) );
+    ASSERT_EQ( 1U, array.m_numData );
+    const BinaryData arrayData( readAt<BinaryData>( buffer, arrayPos + sizeof( BinaryStructure ) ) );
+    EXPECT_EQ( static_cast<uint32>( Value::ddl_int32 ), arrayData.m_type );
+    EXPECT_EQ( 2U, arrayData.m_arraySize );
+    ASSERT_EQ( 4U, arrayData.m_numValues );
+    for( int32 i = 0; i < 4; i++ ) {
+        EXPECT_EQ( i + 1, readAt<int32>( buffer, arrayPos + sizeof( BinaryStructure ) + sizeof( BinaryData ) + i * 4 ) );
+    }
+
+    // strings are stored as string indices
+    const size_t namesPos( nodePos + readAt<uint32>( buffer, childOffsets + 12 ) );
+    const size_t namesData( namesPos + sizeof( BinaryStructure ) + sizeof( BinaryData ) );
+    EXPECT_EQ( "a", readString( buffer, readAt<uint32>( buffer, namesData ) ) );
+    EXPECT_EQ( "b", readString( buffer, readAt<uint32>( buffer, namesData + 4 ) ) );
+}
+
+TEST_F( OpenDDLBinaryExportTest, invalidContextTest ) {
+    std::vector<char> buffer;
+    OpenDDLBinaryExport myExporter;
+    EXPECT_FALSE( myExporter.exportContext( ddl_nullptr, buffer ) );
+    EXPECT_TRUE( buffer.empty() );
+
+    Context ctx;
+    EXPECT_FALSE( myExporter.exportContext( &ctx, buffer ) );
+    EXPECT_FALSE( myExporter.exportContext( &ctx, std::string() ) );
+}
+
+END_ODDLPARSER_NS
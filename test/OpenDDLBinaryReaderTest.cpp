@@ -0,0 +1,202 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "gtest/gtest.h"
+
+#include <openddlparser/OpenDDLBinaryReader.h>
+#include <openddlparser/OpenDDLBinaryExport.h>
+#include <openddlparser/OpenDDLParser.h>
+#include <openddlparser/DDLNode.h>
+
+#include "UnitTestCommon.h"
+
+BEGIN_ODDLPARSER_NS
+
+class OpenDDLBinaryReaderTest : public testing::Test {
+protected:
+    static bool encode( const char *token, std::vector<char> &buffer ) {
+        OpenDDLParser theParser;
+        theParser.setBuffer( token, strlen( token ) );
+        if( !theParser.parse() ) {
+            return false;
+        }
+
+        OpenDDLBinaryExport myExporter;
+        return myExporter.exportContext( theParser.getContext(), buffer );
+    }
+};
+
+static const char ReaderToken[] =
+    "GeometryNode $node1 {\n"
+    "    Metric (key = \"distance\") { float { 1.5, 2, 3 } }\n"
+    "    Scale (value = 2.5) { float { 1 } }\n"
+    "    Array { int32[ 2 ] { { 1, 2 }, { 3, 4 } } }\n"
+    "    Names { string { \"a\", \"b\" } }\n"
+    "    Links { ref { $node1, %local } }\n"
+    "}\n";
+
+TEST_F( OpenDDLBinaryReaderTest, readBufferTest ) {
+    std::vector<char> buffer;
+    ASSERT_TRUE( encode( ReaderToken, buffer ) );
+
+    OpenDDLBinaryReader reader;
+    ASSERT_TRUE( reader.setBuffer( &buffer[ 0 ], buffer.size() ) );
+    EXPECT_TRUE( reader.isOpen() );
+
+    BinaryNodeView root( reader.getRoot() );
+    ASSERT_TRUE( root.isValid() );
+    ASSERT_EQ( 1U, root.getNumChildren() );
+    BinaryNodeView node( root.getChild( 0 ) );
+    EXPECT_STREQ( "GeometryNode", node.getType() );
+    EXPECT_STREQ( "node1", node.getName() );
+    EXPECT_EQ( 5U, node.getNumChildren() );
+    EXPECT_FALSE( node.getChild( 5 ).isValid() );
+
+    BinaryNodeView metric( node.findChild( "Metric" ) );
+    ASSERT_TRUE( metric.isValid() );
+    EXPECT_STREQ( "", metric.getName() );
+    EXPECT_STREQ( "distance", metric.findProperty( "key" ).getString() );
+    BinaryPropertyView scale( node.findChild( "Scale" ).findProperty( "value" ) );
+    EXPECT_EQ( Value::ddl_float, scale.getType() );
+    EXPECT_DOUBLE_EQ( 2.5, scale.getDouble() );
+    EXPECT_FALSE( metric.findProperty( "unknown" ).isValid() );
+
+    // the values are handed out in place
+    ASSERT_EQ( 1U, metric.getNumData() );
+    BinarySpan<float> floats( metric.getData( 0 ).getValues<float>() );
+    ASSERT_EQ( 3U, floats.size() );
+    EXPECT_EQ( 0U, reinterpret_cast<size_t>( floats.data() ) % 4 );
+    EXPECT_TRUE( reader.isInside( floats.data(), floats.size() * sizeof( float ) ) );
+    EXPECT_FLOAT_EQ( 1.5f, floats[ 0 ] );
+    EXPECT_FLOAT_EQ( 3.0f, floats[ 2 ] );
+    EXPECT_TRUE( metric.getData( 0 ).getValues<double>().empty() );
+
+    BinaryDataView array( node.findChild( "Array" ).getData( 0 ) );
+    EXPECT_EQ( Value::ddl_int32, array.getType() );
+    EXPECT_EQ( 2U, array.getArraySize() );
+    int32 sum( 0 );
+    BinarySpan<int32> ints( array.getValues<int32>() );
+    for( const int32 *it = ints.begin(); it != ints.end(); ++it ) {
+        sum += *it;
+    }
+    EXPECT_EQ( 10, sum );
+
+    BinaryDataView names( node.findChild( "Names" ).getData( 0 ) );
+    EXPECT_STREQ( "a", names.getString( 0 ) );
+    EXPECT_STREQ( "b", names.getString( 1 ) );
+    EXPECT_STREQ( "", names.getString( 2 ) );
+
+    BinaryDataView links( node.findChild( "Links" ).getData( 0 ) );
+    EXPECT_EQ( Value::ddl_ref, links.getType() );
+    EXPECT_STREQ( "$node1", links.getString( 0 ) );
+    EXPECT_STREQ( "%local", links.getString( 1 ) );
+
+    reader.close();
+    EXPECT_FALSE( reader.isOpen() );
+    EXPECT_FALSE( reader.getRoot().isValid() );
+}
+
+TEST_F( OpenDDLBinaryReaderTest, halfPropertyTest ) {
+    Context ctx;
+    ctx.m_root = DDLNode::create( "root", "" );
+    DDLNode *node( DDLNode::create( "Scale", "", ctx.m_root ) );
+    Value *value( ValueAllocator::allocPrimData( Value::ddl_half ) );
+    const uint16 bits( 0x3e00 );
+    ::memcpy( value->m_data, &bits, sizeof( uint16 ) );
+    Property *prop( new Property( new Text( "value", 5 ) ) );
+    prop->m_value = value;
+    node->setProperties( prop );
+
+    std::vector<char> buffer;
+    OpenDDLBinaryExport myExporter;
+    ASSERT_TRUE( myExporter.exportContext( &ctx, buffer ) );
+
+    // half values are converted like float values
+    OpenDDLBinaryReader reader;
+    ASSERT_TRUE( reader.setBuffer( &buffer[ 0 ], buffer.size() ) );
+    BinaryPropertyView scale( reader.getRoot().getChild( 0 ).findProperty( "value" ) );
+    EXPECT_EQ( Value::ddl_half, scale.getType() );
+    EXPECT_DOUBLE_EQ( 1.5, scale.getDouble() );
+}
+
+TEST_F( OpenDDLBinaryReaderTest, readFileTest ) {
+    OpenDDLParser theParser;
+    theParser.setBuffer( ReaderToken, strlen( ReaderToken ) );
+    ASSERT_TRUE( theParser.parse() );
+
+    const std::string filename( "readFileTest.oddb" );
+    OpenDDLBinaryExport myExporter;
+    ASSERT_TRUE( myExporter.exportContext( theParser.getContext(), filename ) );
+
+    OpenDDLBinaryReader reader;
+    EXPECT_TRUE( reader.open( filename ) );
+    BinaryNodeView node( reader.getRoot().getChild( 0 ) );
+    EXPECT_STREQ( "GeometryNode", node.getType() );
+    EXPECT_EQ( 3U, node.findChild( "Metric" ).getData( 0 ).getNumValues() );
+    reader.close();
+    ::remove( filename.c_str() );
+
+    EXPECT_FALSE( reader.open( filename ) );
+    EXPECT_FALSE( reader.open( "" ) );
+}
+
+TEST_F( OpenDDLBinaryReaderTest, invalidBufferTest ) {
+    std::vector<char> buffer;
+    ASSERT_TRUE( encode( ReaderToken, buffer ) );
+
+    OpenDDLBinaryReader reader;
+    EXPECT_FALSE( reader.setBuffer( ddl_nullptr, 0 ) );
+    EXPECT_FALSE( reader.setBuffer( &buffer[ 0 ], sizeof( BinaryHeader ) - 1 ) );
+    EXPECT_FALSE( reader.setBuffer( &buffer[ 0 ], buffer.size() - 8 ) );
+
+    std::vector<char> wrongMagic( buffer );
+    wrongMagic[ 0 ] = 'X';
+    EXPECT_FALSE( reader.setBuffer( &wrongMagic[ 0 ], wrongMagic.size() ) );
+
+    std::vector<char> wrongVersion( buffer );
+    wrongVersion[ 4 ]++;
+    EXPECT_FALSE( reader.setBuffer( &wrongVersion[ 0 ], wrongVersion.size() ) );
+
+    // broken records are rejected on access
+    std::vector<char> brokenChild( buffer );
+    BinaryHeader header;
+    ::memcpy( &header, &brokenChild[ 0 ], sizeof( BinaryHeader ) );
+    const uint32 offset( 0xfffffff0 );
+    ::memcpy( &brokenChild[ header.m_rootOffset + sizeof( BinaryStructure ) ], &offset, sizeof( uint32 ) );
+    ASSERT_TRUE( reader.setBuffer( &brokenChild[ 0 ], brokenChild.size() ) );
+    EXPECT_EQ( 1U, reader.getRoot().getNumChildren() );
+    EXPECT_FALSE( reader.getRoot().getChild( 0 ).isValid() );
+    EXPECT_STREQ( "", reader.getString( BinaryNoString ) );
+    EXPECT_EQ( ddl_nullptr, reader.createNodeTree() );
+
+    // offsets pointing to the record itself or into its header are rejected as well
+    const uint32 backOffsets[] = { 0, sizeof( BinaryStructure ) };
+    for( size_t i = 0; i < 2; i++ ) {
+        std::vector<char> selfChild( buffer );
+        ::memcpy( &selfChild[ header.m_rootOffset + sizeof( BinaryStructure ) ], &backOffsets[ i ], sizeof( uint32 ) );
+        ASSERT_TRUE( reader.setBuffer( &selfChild[ 0 ], selfChild.size() ) );
+        EXPECT_FALSE( reader.getRoot().getChild( 0 ).isValid() );
+        EXPECT_EQ( ddl_nullptr, reader.createNodeTree() );
+    }
+}
+
+END_ODDLPARSER_NS
@@ -0,0 +1,100 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "gtest/gtest.h"
+
+#include <openddlparser/OpenDDLBlockReader.h>
+
+#include <cstdio>
+
+BEGIN_ODDLPARSER_NS
+
+class OpenDDLBlockReaderTest : public testing::Test {
+protected:
+    std::string m_filename;
+
+    virtual void SetUp() {
+        m_filename = "blockReaderTest.ddl";
+    }
+
+    virtual void TearDown() {
+        ::remove( m_filename.c_str() );
+    }
+
+    void writeFile( const std::string &content ) {
+        FILE *file( ::fopen( m_filename.c_str(), "wb" ) );
+        ASSERT_NE( ddl_nullptr, file );
+        ::fwrite( content.c_str(), 1, content.size(), file );
+        ::fclose( file );
+    }
+};
+
+TEST_F( OpenDDLBlockReaderTest, readTest ) {
+    std::string content;
+    for( int i = 0; i < 1000; i++ ) {
+        content += static_cast<char>( 'a' + i % 26 );
+    }
+    writeFile( content );
+
+    BlockReader reader;
+    EXPECT_FALSE( reader.isOpen() );
+    ASSERT_TRUE( reader.open( m_filename, 64 ) );
+    EXPECT_TRUE( reader.isOpen() );
+    EXPECT_EQ( 64U, reader.getBlockSize() );
+
+    std::vector<char> block;
+    std::string result;
+    size_t numBlocks( 0 );
+    while( reader.read( block ) ) {
+        EXPECT_LE( block.size(), 64U );
+        result.append( block.begin(), block.end() );
+        numBlocks++;
+    }
+    EXPECT_EQ( content, result );
+    EXPECT_EQ( 16U, numBlocks );
+    EXPECT_FALSE( reader.hasError() );
+    EXPECT_FALSE( reader.read( block ) );
+
+    reader.close();
+    EXPECT_FALSE( reader.isOpen() );
+}
+
+TEST_F( OpenDDLBlockReaderTest, closeEarlyTest ) {
+    writeFile( std::string( 4096, 'x' ) );
+
+    // the reader thread waits for free buffers and must stop on close
+    BlockReader reader;
+    ASSERT_TRUE( reader.open( m_filename, 16 ) );
+    std::vector<char> block;
+    EXPECT_TRUE( reader.read( block ) );
+    EXPECT_EQ( 16U, block.size() );
+    reader.close();
+    EXPECT_FALSE( reader.read( block ) );
+}
+
+TEST_F( OpenDDLBlockReaderTest, openFailedTest ) {
+    BlockReader reader;
+    EXPECT_FALSE( reader.open( "notExisting.ddl" ) );
+    EXPECT_FALSE( reader.isOpen() );
+}
+
+END_ODDLPARSER_NS
@@ -27,6 +27,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <openddlparser/Value.h>
 #include "UnitTestCommon.h"
 
+#include <chrono>
+
 BEGIN_ODDLPARSER_NS
 
 class OpenDDLExportMock : public OpenDDLExport {
@@ -151,6 +153,14 @@ TEST_F( OpenDDLExportTest, writeNodeHeaderTest ) {
     ok = myExport.writeNodeHeaderTester( m_root, statement );
     EXPECT_TRUE( ok );
     EXPECT_EQ( "test $root", statement );
+    statement.clear();
+
+    DDLNode *local( DDLNode::create( "Translation", "xpos", m_root ) );
+    local->setNameType( LocalName );
+    EXPECT_EQ( LocalName, local->getNameType() );
+    ok = myExport.writeNodeHeaderTester( local, statement );
+    EXPECT_TRUE( ok );
+    EXPECT_EQ( "Translation %xpos", statement );
 }
 
 TEST_F( OpenDDLExportTest, writeBoolTest ) {
@@ -221,6 +231,81 @@ TEST_F( OpenDDLExportTest, writeFloatTest ) {
     ValueAllocator::releasePrimData( &v );
 }
 
+TEST_F( OpenDDLExportTest, writeLimitsTest ) {
+    OpenDDLExportMock myExport;
+    std::string statement;
+    Value *v = ValueAllocator::allocPrimData( Value::ddl_int64 );
+    v->setInt64( -9223372036854775807LL - 1 );
+    EXPECT_TRUE( myExport.writeValueTester( v, statement ) );
+    EXPECT_EQ( "-9223372036854775808", statement );
+    ValueAllocator::releasePrimData( &v );
+
+    statement.clear();
+    v = ValueAllocator::allocPrimData( Value::ddl_unsigned_int64 );
+    v->setUnsignedInt64( 18446744073709551615ULL );
+    EXPECT_TRUE( myExport.writeValueTester( v, statement ) );
+    EXPECT_EQ( "18446744073709551615", statement );
+    ValueAllocator::releasePrimData( &v );
+
+    statement.clear();
+    v = ValueAllocator::allocPrimData( Value::ddl_int8 );
+    v->setInt8( -128 );
+    EXPECT_TRUE( myExport.writeValueTester( v, statement ) );
+    EXPECT_EQ( "-128", statement );
+    ValueAllocator::releasePrimData( &v );
+
+    statement.clear();
+    v = ValueAllocator::allocPrimData( Value::ddl_unsigned_int32 );
+    v->setUnsignedInt32( 4294967295U );
+    EXPECT_TRUE( myExport.writeValueTester( v, statement ) );
+    EXPECT_EQ( "4294967295", statement );
+    ValueAllocator::releasePrimData( &v );
+}
+
+TEST_F( OpenDDLExportTest, writeFloatRoundTripTest ) {
+    OpenDDLExportMock myExport;
+    Value *v = ValueAllocator::allocPrimData( Value::ddl_float );
+    const float values[] = { 0.1f, -2.5f, 3.14159274f, 1.0e-20f, 123456789.0f, 16777216.0f, -0.0f, 0.0f };
+    const char *expected[] = { "0.1", "-2.5", "3.1415927", "1e-20", "1.2345679e+08", "16777216", "-0", "0" };
+    for( size_t i = 0; i < sizeof( values ) / sizeof( float ); i++ ) {
+        std::string statement;
+        v->setFloat( values[ i ] );
+        EXPECT_TRUE( myExport.writeValueTester( v, statement ) );
+        EXPECT_EQ( expected[ i ], statement );
+        EXPECT_EQ( values[ i ], static_cast<float>( ::atof( statement.c_str() ) ) );
+    }
+    ValueAllocator::releasePrimData( &v );
+
+    std::string statement;
+    v = ValueAllocator::allocPrimData( Value::ddl_double );
+    v->setDouble( 0.1 );
+    EXPECT_TRUE( myExport.writeValueTester( v, statement ) );
+    EXPECT_EQ( "0.1", statement );
+    statement.clear();
+    v->setDouble( 1.0 / 3.0 );
+    EXPECT_TRUE( myExport.writeValueTester( v, statement ) );
+    EXPECT_EQ( 1.0 / 3.0, ::atof( statement.c_str() ) );
+    ValueAllocator::releasePrimData( &v );
+
+    // 0x3E00 is 1.5 as half
+    statement.clear();
+    v = ValueAllocator::allocPrimData( Value::ddl_half );
+    const uint16 half( 0x3E00 );
+    ::memcpy( v->m_data, &half, sizeof( uint16 ) );
+    EXPECT_TRUE( myExport.writeValueTester( v, statement ) );
+    EXPECT_EQ( "1.5", statement );
+    ValueAllocator::releasePrimData( &v );
+
+    // nan has no literal, the bits are written
+    statement.clear();
+    v = ValueAllocator::allocPrimData( Value::ddl_float );
+    const uint32 nan( 0x7FC00000 );
+    ::memcpy( v->m_data, &nan, sizeof( uint32 ) );
+    EXPECT_TRUE( myExport.writeValueTester( v, statement ) );
+    EXPECT_EQ( "0x7FC00000", statement );
+    ValueAllocator::releasePrimData( &v );
+}
+
 TEST_F( OpenDDLExportTest, writeStringTest ) {
     OpenDDLExportMock myExport;
     Value *v = ValueAllocator::allocPrimData( Value::ddl_string );
@@ -231,6 +316,15 @@ TEST_F( OpenDDLExportTest, writeStringTest ) {
     EXPECT_TRUE( ok );
     EXPECT_EQ( "\"huhu\"", statement );
     ValueAllocator::releasePrimData( &v );
+
+    // backslashes are kept, the parser reads them back unchanged
+    const std::string path( "C:\\tex\\wood.png" );
+    statement.clear();
+    v = ValueAllocator::allocPrimData( Value::ddl_string, path.size() );
+    v->setString( path );
+    EXPECT_TRUE( myExport.writeValueTester( v, statement ) );
+    EXPECT_EQ( "\"C:\\tex\\wood.png\"", statement );
+    ValueAllocator::releasePrimData( &v );
 }
 
 TEST_F( OpenDDLExportTest, writeValueTypeTest ) {
@@ -305,4 +399,200 @@ TEST_F( OpenDDLExportTest, writeValueArrayTest ) {
     EXPECT_EQ( "{ 1, 2, 3 }", statement );
 }
 
+TEST_F( OpenDDLExportTest, stringStreamTest ) {
+    std::string result;
+    StringStream *stream( new StringStream( result ) );
+    EXPECT_TRUE( stream->isOpen() );
+    EXPECT_EQ( 0U, stream->getBufferSize() );
+    EXPECT_EQ( 4U, stream->write( "test" ) );
+    EXPECT_EQ( "test", result );
+
+    OpenDDLExport myExporter( stream );
+    Context ctx;
+    ctx.m_root = DDLNode::create( "root", "" );
+    DDLNode *child( DDLNode::create( "Metric", "metric", ctx.m_root ) );
+    DDLNode::create( "Node", "", child );
+    EXPECT_TRUE( myExporter.exportContext( &ctx, "" ) );
+    EXPECT_EQ( "testMetric $metric {\n    Node {\n    }\n}\n", result );
+}
+
+class PrefixFormatter : public StreamFormatterBase {
+public:
+    virtual std::string format( const std::string &statement ) {
+        return "#" + statement;
+    }
+};
+
+TEST_F( OpenDDLExportTest, formatterStreamTest ) {
+    std::string result;
+    StringStream *stream( new StringStream( result, new PrefixFormatter ) );
+    EXPECT_EQ( 4U, stream->write( std::string( "test" ) ) );
+    EXPECT_EQ( "#test", result );
+    result.clear();
+
+    // the formatter changes the length of each statement, all nodes are written
+    OpenDDLExport myExporter( stream );
+    Context ctx;
+    ctx.m_root = DDLNode::create( "root", "" );
+    DDLNode::create( "Metric", "", ctx.m_root );
+    DDLNode::create( "Node", "", ctx.m_root );
+    EXPECT_TRUE( myExporter.exportContext( &ctx, "" ) );
+    EXPECT_EQ( "#Metric {\n}\n#Node {\n}\n", result );
+}
+
+TEST_F( OpenDDLExportTest, bufferedStreamTest ) {
+    std::vector<char> result;
+    VectorStream stream( result );
+    stream.setBufferSize( 8 );
+    EXPECT_EQ( 4U, stream.write( "1234", 4 ) );
+    EXPECT_TRUE( result.empty() );
+    // the backend only gets whole blocks of the buffer size
+    EXPECT_EQ( 6U, stream.write( "567890", 6 ) );
+    EXPECT_EQ( 8U, result.size() );
+    EXPECT_EQ( 16U, stream.write( "abcdefghijklmnop", 16 ) );
+    EXPECT_EQ( 24U, result.size() );
+    EXPECT_EQ( 1U, stream.write( "q", 1 ) );
+    EXPECT_TRUE( stream.flush() );
+    EXPECT_EQ( "1234567890abcdefghijklmnopq", std::string( result.begin(), result.end() ) );
+
+    // the file stream writes nothing while it is closed
+    IOStreamBase fileStream;
+    EXPECT_FALSE( fileStream.isOpen() );
+    EXPECT_EQ( 0U, fileStream.write( "test" ) );
+}
+
+TEST_F( OpenDDLExportTest, callbackStreamTest ) {
+    std::string result;
+    std::vector<size_t> chunks;
+    size_t retries( 2 );
+    CallbackStream stream( [&]( const char *data, size_t len ) {
+        // the receiver is busy twice before it accepts the first chunk
+        if( retries > 0 ) {
+            retries--;
+            return CallbackStream::ChunkRetry;
+        }
+        result.append( data, len );
+        chunks.push_back( len );
+        return CallbackStream::ChunkAccepted;
+    }, 4 );
+    EXPECT_TRUE( stream.open( "" ) );
+    const std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+    EXPECT_EQ( 10U, stream.write( "0123456789", 10 ) );
+    EXPECT_EQ( 3U, stream.write( "abc", 3 ) );
+    EXPECT_TRUE( stream.close() );
+
+    // the writer slept before both retries, the second wait is doubled
+    EXPECT_GE( std::chrono::steady_clock::now() - start, std::chrono::microseconds( 150 ) );
+    EXPECT_EQ( "0123456789abc", result );
+    ASSERT_EQ( 4U, chunks.size() );
+    EXPECT_EQ( 4U, chunks[ 0 ] );
+    EXPECT_EQ( 4U, chunks[ 1 ] );
+    EXPECT_EQ( 4U, chunks[ 2 ] );
+    EXPECT_EQ( 1U, chunks[ 3 ] );
+    EXPECT_EQ( 0U, retries );
+}
+
+TEST_F( OpenDDLExportTest, callbackStreamAbortTest ) {
+    Context ctx;
+    ctx.m_root = DDLNode::create( "root", "" );
+    for( size_t i = 0; i < 100; i++ ) {
+        DDLNode::create( "Metric", "", ctx.m_root );
+    }
+
+    // the export stops with the first rejected chunk
+    size_t calls( 0 );
+    CallbackStream *stream( new CallbackStream( [&calls]( const char *, size_t ) {
+        calls++;
+        return calls < 3 ? CallbackStream::ChunkAccepted : CallbackStream::ChunkAbort;
+    }, 16 ) );
+    OpenDDLExport myExporter( stream );
+    EXPECT_FALSE( myExporter.exportContext( &ctx, "" ) );
+    EXPECT_TRUE( stream->isAborted() );
+    EXPECT_FALSE( stream->isOpen() );
+    EXPECT_EQ( 3U, calls );
+    EXPECT_EQ( 0U, stream->write( "Metric" ) );
+    EXPECT_FALSE( myExporter.handleNodeBegin( ctx.m_root->getChildNodeList()[ 0 ], 0 ) );
+    EXPECT_FALSE( myExporter.handleNodeEnd( ctx.m_root->getChildNodeList()[ 0 ], 0 ) );
+    EXPECT_FALSE( stream->close() );
+
+    // a new open resets the stream
+    EXPECT_TRUE( stream->open( "" ) );
+    EXPECT_FALSE( stream->isAborted() );
+}
+
+TEST_F( OpenDDLExportTest, fileStreamTest ) {
+    const std::string filename( "fileStreamTest.ddl" );
+    for( size_t i = 0; i < 2; i++ ) {
+        // a second export must replace the file, not append to it
+        IOStreamBase stream;
+        EXPECT_TRUE( stream.open( filename ) );
+        EXPECT_TRUE( stream.isOpen() );
+        EXPECT_EQ( 6U, stream.write( "Metric" ) );
+        EXPECT_TRUE( stream.close() );
+    }
+
+    FILE *file( ::fopen( filename.c_str(), "rb" ) );
+    ASSERT_NE( ddl_nullptr, file );
+    char buffer[ 32 ];
+    const size_t len( ::fread( buffer, 1, sizeof( buffer ), file ) );
+    ::fclose( file );
+    ::remove( filename.c_str() );
+    EXPECT_EQ( "Metric", std::string( buffer, len ) );
+}
+
+TEST_F( OpenDDLExportTest, parallelExportTest ) {
+    Context ctx;
+    ctx.m_root = DDLNode::create( "root", "" );
+    for( int32 i = 0; i < 100; i++ ) {
+        DDLNode *geometry( DDLNode::create( "GeometryObject", "", ctx.m_root ) );
+        DDLNode *mesh( DDLNode::create( "Mesh", "", geometry ) );
+        Value *v( ValueAllocator::allocPrimData( Value::ddl_int32 ) );
+        v->setInt32( i );
+        mesh->setValue( v );
+    }
+
+    std::string serial;
+    OpenDDLExport serialExporter( new StringStream( serial ) );
+    EXPECT_TRUE( serialExporter.exportContext( &ctx, "" ) );
+
+    std::string parallel;
+    OpenDDLExport parallelExporter( new StringStream( parallel ) );
+    parallelExporter.setNumThreads( 4 );
+    EXPECT_EQ( 4U, parallelExporter.getNumThreads() );
+    EXPECT_TRUE( parallelExporter.exportContext( &ctx, "" ) );
+    EXPECT_EQ( serial, parallel );
+    EXPECT_NE( std::string::npos, parallel.find( "int32 { 99 }" ) );
+}
+
+TEST_F( OpenDDLExportTest, writeBulkValueArrayTest ) {
+    // the list is longer than the formatting chunk
+    DataArrayList *dataArrayList( new DataArrayList );
+    Value *prev( ddl_nullptr );
+    std::string expected( "{ " );
+    for( uint32 i = 0; i < 5000; i++ ) {
+        Value *v( ValueAllocator::allocPrimData( Value::ddl_unsigned_int32 ) );
+        v->setUnsignedInt32( i * 997U );
+        if( ddl_nullptr == prev ) {
+            dataArrayList->m_dataList = v;
+        } else {
+            prev->setNext( v );
+            expected += ", ";
+        }
+        prev = v;
+        std::string number;
+        OpenDDLExportMock myExporter;
+        myExporter.writeValueTester( v, number );
+        expected += number;
+    }
+    expected += " }";
+    dataArrayList->m_numItems = 5000;
+
+    OpenDDLExportMock myExporter;
+    std::string statement;
+    EXPECT_TRUE( myExporter.writeValueArrayTester( dataArrayList, statement ) );
+    EXPECT_EQ( expected, statement );
+    EXPECT_NE( std::string::npos, statement.find( ", 4984003 }" ) );
+    delete dataArrayList;
+}
+
 END_ODDLPARSER_NS
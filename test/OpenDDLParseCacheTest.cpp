@@ -0,0 +1,252 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "gtest/gtest.h"
+
+#include <openddlparser/OpenDDLParseCache.h>
+#include <openddlparser/OpenDDLBinaryFormat.h>
+#include <openddlparser/OpenDDLParser.h>
+#include <openddlparser/OpenDDLValidator.h>
+#include <openddlparser/DDLNode.h>
+
+#include "UnitTestCommon.h"
+
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#   include <direct.h>
+#else
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif // _WIN32
+
+BEGIN_ODDLPARSER_NS
+
+class OpenDDLParseCacheTest : public testing::Test {
+protected:
+    std::string m_directory;
+
+    virtual void SetUp() {
+        m_directory = "parseCacheTest";
+#ifdef _WIN32
+        ::_mkdir( m_directory.c_str() );
+#else
+        ::mkdir( m_directory.c_str(), 0755 );
+#endif // _WIN32
+        OpenDDLParseCache( m_directory ).clear();
+    }
+
+    virtual void TearDown() {
+        OpenDDLParseCache( m_directory ).clear();
+#ifdef _WIN32
+        ::_rmdir( m_directory.c_str() );
+#else
+        ::rmdir( m_directory.c_str() );
+#endif // _WIN32
+    }
+
+    static void waitForNextTimestamp() {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+    }
+};
+
+static const char CacheToken[] =
+    "GeometryNode $node1 {\n"
+    "    Metric (key = \"distance\") { float { 1, 2 } }\n"
+    "    Array { int32[ 2 ] { { 1, 2 }, { 3, 4 } } }\n"
+    "}\n";
+
+TEST_F( OpenDDLParseCacheTest, hashTest ) {
+    EXPECT_EQ( 0xef46db3751d8e999ULL, OpenDDLParseCache::computeHash( "", 0 ) );
+    EXPECT_EQ( 0x44bc2cf5ad770999ULL, OpenDDLParseCache::computeHash( "abc", 3 ) );
+    const char text[] = "Nobody inspects the spammish repetition";
+    EXPECT_EQ( 0xfbcea83c8a378bf1ULL, OpenDDLParseCache::computeHash( text, strlen( text ) ) );
+    EXPECT_NE( OpenDDLParseCache::computeHash( text, strlen( text ) ), OpenDDLParseCache::computeHash( text, strlen( text ), 1 ) );
+    EXPECT_NE( OpenDDLParseCache::computeHash( text, strlen( text ) ), OpenDDLParseCache::computeKey( text, strlen( text ) ) );
+}
+
+TEST_F( OpenDDLParseCacheTest, parseWithCacheTest ) {
+    OpenDDLParseCache cache( m_directory );
+    const uint64 key( OpenDDLParseCache::computeKey( CacheToken, strlen( CacheToken ) ) );
+    EXPECT_FALSE( cache.contains( key ) );
+
+    OpenDDLParser theParser;
+    theParser.setCache( &cache );
+    EXPECT_EQ( &cache, theParser.getCache() );
+    theParser.setBuffer( CacheToken, strlen( CacheToken ) );
+    ASSERT_TRUE( theParser.parse() );
+    EXPECT_TRUE( cache.contains( key ) );
+    EXPECT_LT( 0U, cache.getSize() );
+
+    // the second parse creates the tree from the cache entry
+    theParser.setBuffer( CacheToken, strlen( CacheToken ) );
+    ASSERT_TRUE( theParser.parse() );
+    DDLNode *root( theParser.getRoot() );
+    ASSERT_NE( ddl_nullptr, root );
+    ASSERT_EQ( 1U, root->getChildNodeList().size() );
+    DDLNode *node( root->getChildNodeList()[ 0 ] );
+    EXPECT_EQ( "GeometryNode", node->getType() );
+    EXPECT_EQ( "node1", node->getName() );
+    ASSERT_EQ( 2U, node->getChildNodeList().size() );
+    DDLNode *metric( node->getChildNodeList()[ 0 ] );
+    ASSERT_NE( ddl_nullptr, metric->getProperties() );
+    EXPECT_STREQ( "distance", metric->getProperties()->m_value->getString() );
+    ASSERT_NE( ddl_nullptr, metric->getValue() );
+    EXPECT_FLOAT_EQ( 1.0f, metric->getValue()->getFloat() );
+    DataArrayList *al( node->getChildNodeList()[ 1 ]->getDataArrayList() );
+    ASSERT_NE( ddl_nullptr, al );
+    EXPECT_EQ( 2U, al->m_numItems );
+    ASSERT_NE( ddl_nullptr, al->m_next );
+    EXPECT_EQ( 3, al->m_next->m_dataList->getInt32() );
+}
+
+TEST_F( OpenDDLParseCacheTest, nameTypeTest ) {
+    static const char token[] =
+        "A { B %x { float { 1 } } }\n"
+        "A { B %x { float { 2 } } }\n";
+
+    OpenDDLParseCache cache( m_directory );
+    OpenDDLParser theParser;
+    theParser.setCache( &cache );
+    theParser.setBuffer( token, strlen( token ) );
+    ASSERT_TRUE( theParser.parse() );
+    ASSERT_TRUE( cache.contains( OpenDDLParseCache::computeKey( token, strlen( token ) ) ) );
+
+    // the local names stay local on a cache hit, so they are no duplicate global names
+    theParser.setBuffer( token, strlen( token ) );
+    ASSERT_TRUE( theParser.parse() );
+    const DDLNode::DllNodeList &childs( theParser.getRoot()->getChildNodeList() );
+    ASSERT_EQ( 2U, childs.size() );
+    for( size_t i = 0; i < childs.size(); i++ ) {
+        ASSERT_EQ( 1U, childs[ i ]->getChildNodeList().size() );
+        EXPECT_EQ( "x", childs[ i ]->getChildNodeList()[ 0 ]->getName() );
+        EXPECT_EQ( LocalName, childs[ i ]->getChildNodeList()[ 0 ]->getNameType() );
+    }
+
+    OpenDDLValidator validator( 1 );
+    EXPECT_TRUE( validator.validate( theParser.getContext() ) );
+    EXPECT_EQ( 0U, validator.getNumErrors() );
+}
+
+TEST_F( OpenDDLParseCacheTest, loadFromCacheTest ) {
+    OpenDDLParseCache cache( m_directory );
+    const uint64 key( OpenDDLParseCache::computeKey( CacheToken, strlen( CacheToken ) ) );
+    EXPECT_EQ( ddl_nullptr, cache.load( key ) );
+
+    // an entry for the buffer replaces the parsing
+    DDLNode *root( DDLNode::create( "root", "" ) );
+    DDLNode *cached( DDLNode::create( "Cached", "cached", root ) );
+    cached->setNameType( LocalName );
+    DDLNode::create( "Child", "", cached );
+    ASSERT_TRUE( cache.store( key, root ) );
+
+    OpenDDLParser theParser;
+    theParser.setCache( &cache );
+    theParser.setBuffer( CacheToken, strlen( CacheToken ) );
+    ASSERT_TRUE( theParser.parse() );
+    DDLNode *loaded( theParser.getRoot() );
+    ASSERT_EQ( 1U, loaded->getChildNodeList().size() );
+    DDLNode *node( loaded->getChildNodeList()[ 0 ] );
+    EXPECT_EQ( "Cached", node->getType() );
+    EXPECT_EQ( "cached", node->getName() );
+    EXPECT_EQ( LocalName, node->getNameType() );
+
+    // the loaded tree is numbered like a parsed one
+    ASSERT_EQ( 1U, node->getChildNodeList().size() );
+    EXPECT_EQ( 0U, loaded->getTreeIndex() );
+    EXPECT_EQ( 1U, node->getTreeIndex() );
+    EXPECT_EQ( 2U, node->getChildNodeList()[ 0 ]->getTreeIndex() );
+    EXPECT_EQ( 3U, loaded->getSubtreeSize() );
+    EXPECT_TRUE( loaded->isAncestorOf( node->getChildNodeList()[ 0 ] ) );
+
+    // outdated or broken entries are removed
+    const std::string path( m_directory + "/" + "0123456789abcdef.oddb" );
+    FILE *file( ::fopen( path.c_str(), "wb" ) );
+    ASSERT_NE( ddl_nullptr, file );
+    ::fputs( "ODDB broken", file );
+    ::fclose( file );
+    EXPECT_TRUE( cache.contains( 0x0123456789abcdefULL ) );
+    EXPECT_EQ( ddl_nullptr, cache.load( 0x0123456789abcdefULL ) );
+    EXPECT_FALSE( cache.contains( 0x0123456789abcdefULL ) );
+}
+
+TEST_F( OpenDDLParseCacheTest, corruptedEntryTest ) {
+    OpenDDLParseCache cache( m_directory );
+    const uint64 key( OpenDDLParseCache::computeKey( CacheToken, strlen( CacheToken ) ) );
+    DDLNode *root( DDLNode::create( "root", "" ) );
+    DDLNode::create( "Cached", "", root );
+    ASSERT_TRUE( cache.store( key, root ) );
+
+    // the child offset of the root record points back to the record itself
+    char name[ 32 ];
+    ::snprintf( name, sizeof( name ), "%016llx.oddb", static_cast<unsigned long long>( key ) );
+    const std::string path( m_directory + "/" + name );
+    FILE *file( ::fopen( path.c_str(), "r+b" ) );
+    ASSERT_NE( ddl_nullptr, file );
+    BinaryHeader header;
+    ASSERT_EQ( 1U, ::fread( &header, sizeof( BinaryHeader ), 1, file ) );
+    const uint32 offset( 0 );
+    ::fseek( file, static_cast<long>( header.m_rootOffset + sizeof( BinaryStructure ) ), SEEK_SET );
+    ::fwrite( &offset, sizeof( uint32 ), 1, file );
+    ::fclose( file );
+
+    // the broken entry is dropped and the buffer is parsed
+    OpenDDLParser theParser;
+    theParser.setCache( &cache );
+    theParser.setBuffer( CacheToken, strlen( CacheToken ) );
+    ASSERT_TRUE( theParser.parse() );
+    ASSERT_EQ( 1U, theParser.getRoot()->getChildNodeList().size() );
+    EXPECT_EQ( "GeometryNode", theParser.getRoot()->getChildNodeList()[ 0 ]->getType() );
+}
+
+TEST_F( OpenDDLParseCacheTest, evictionTest ) {
+    DDLNode *root( DDLNode::create( "root", "" ) );
+    DDLNode::create( "Metric", "", root );
+
+    OpenDDLParseCache cache( m_directory );
+    ASSERT_TRUE( cache.store( 1, root ) );
+    const uint64 entrySize( cache.getSize() );
+    ASSERT_LT( 0U, entrySize );
+    cache.setMaxSize( entrySize * 2 );
+    EXPECT_EQ( entrySize * 2, cache.getMaxSize() );
+    waitForNextTimestamp();
+    ASSERT_TRUE( cache.store( 2, root ) );
+    waitForNextTimestamp();
+
+    // the use of entry 1 makes entry 2 the least recently used one
+    DDLNode *loaded( cache.load( 1 ) );
+    EXPECT_NE( ddl_nullptr, loaded );
+    waitForNextTimestamp();
+    ASSERT_TRUE( cache.store( 3, root ) );
+    EXPECT_TRUE( cache.contains( 1 ) );
+    EXPECT_FALSE( cache.contains( 2 ) );
+    EXPECT_TRUE( cache.contains( 3 ) );
+    EXPECT_EQ( entrySize * 2, cache.getSize() );
+
+    EXPECT_TRUE( cache.remove( 1 ) );
+    EXPECT_FALSE( cache.remove( 1 ) );
+    cache.clear();
+    EXPECT_EQ( 0U, cache.getSize() );
+}
+
+END_ODDLPARSER_NS
@@ -0,0 +1,100 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "gtest/gtest.h"
+
+#include <openddlparser/OpenDDLParseHandle.h>
+#include <openddlparser/OpenDDLParser.h>
+#include <openddlparser/DDLNode.h>
+
+#include "UnitTestCommon.h"
+
+#include <memory>
+#include <sstream>
+
+BEGIN_ODDLPARSER_NS
+
+class ParseHandleTest : public testing::Test {
+protected:
+    static std::string createDocument( size_t numNodes ) {
+        std::stringstream stream;
+        for( size_t i = 0; i < numNodes; i++ ) {
+            stream << "GeometryNode $node" << i << " { Metric { float { " << i << ", 2 } } }\n";
+        }
+
+        return stream.str();
+    }
+};
+
+TEST_F( ParseHandleTest, parseAsyncTest ) {
+    const std::string token( createDocument( 500 ) );
+    OpenDDLParser theParser;
+    std::unique_ptr<ParseHandle> handle( theParser.parseAsync( token.c_str(), token.size() ) );
+    ASSERT_NE( ddl_nullptr, handle.get() );
+
+    // the nodes of the handle are independent from other parsers
+    OpenDDLParser otherParser;
+    const std::string other( createDocument( 2 ) );
+    otherParser.setBuffer( other.c_str(), other.size() );
+    EXPECT_TRUE( otherParser.parse() );
+    otherParser.clear();
+
+    EXPECT_EQ( ParseHandle::Succeeded, handle->wait() );
+    EXPECT_TRUE( handle->isDone() );
+    EXPECT_EQ( ParseHandle::Succeeded, handle->getState() );
+    EXPECT_EQ( ParseHandle::Succeeded, handle->waitFor( 10 ) );
+    EXPECT_DOUBLE_EQ( 1.0, handle->getProgress() );
+    Context *ctx( handle->getContext() );
+    ASSERT_NE( ddl_nullptr, ctx );
+    ASSERT_NE( ddl_nullptr, ctx->m_root );
+    const DDLNode::DllNodeList &childs( ctx->m_root->getChildNodeList() );
+    ASSERT_EQ( 500U, childs.size() );
+    EXPECT_EQ( "node499", childs[ 499 ]->getName() );
+    ASSERT_NE( ddl_nullptr, childs[ 499 ]->getChildNodeList()[ 0 ]->getValue() );
+    EXPECT_FLOAT_EQ( 499.0f, childs[ 499 ]->getChildNodeList()[ 0 ]->getValue()->getFloat() );
+}
+
+TEST_F( ParseHandleTest, cancelTest ) {
+    const std::string token( createDocument( 100000 ) );
+    OpenDDLParser theParser;
+    std::unique_ptr<ParseHandle> handle( theParser.parseAsync( token.c_str(), token.size() ) );
+    handle->cancel();
+    EXPECT_EQ( ParseHandle::Cancelled, handle->wait() );
+    EXPECT_EQ( ddl_nullptr, handle->getContext() );
+    EXPECT_LT( handle->getProgress(), 1.0 );
+
+    // a running parsing is cancelled by the destructor
+    handle.reset( theParser.parseAsync( token.c_str(), token.size() ) );
+    handle.reset();
+}
+
+TEST_F( ParseHandleTest, failedTest ) {
+    std::string token( createDocument( 10 ) );
+    token += "GeometryNode ] { }\n";
+    OpenDDLParser theParser;
+    theParser.setLogSeverity( ddl_none_msg );
+    std::unique_ptr<ParseHandle> handle( theParser.parseAsync( token.c_str(), token.size() ) );
+    EXPECT_EQ( ParseHandle::Failed, handle->wait() );
+    EXPECT_EQ( ddl_nullptr, handle->getContext() );
+}
+
+END_ODDLPARSER_NS
@@ -23,9 +23,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "gtest/gtest.h"
 
 #include <openddlparser/OpenDDLParser.h>
+#include <openddlparser/OpenDDLExport.h>
+#include <openddlparser/OpenDDLQuery.h>
+#include <openddlparser/OpenDDLThreadPool.h>
 
 #include "UnitTestCommon.h"
 
+#include <cmath>
 #include <iostream>
 
 BEGIN_ODDLPARSER_NS
@@ -54,6 +58,10 @@ public:
         m_logs.push_back( msg );
     }
 
+    const std::vector<std::string> &getLogs() const {
+        return m_logs;
+    }
+
     void clearTestLog() {
         m_logs.clear();
     }
@@ -98,6 +106,16 @@ TEST_F( OpenDDLParserTest, getNextSeparatorTest ) {
     EXPECT_TRUE( res );
 }
 
+TEST_F( OpenDDLParserTest, lookForNextTokenAtEndTest ) {
+    // The buffer is exactly as long as its content, end must not be dereferenced.
+    std::vector<char> buffer( 3, ' ' );
+    buffer[ 1 ] = ',';
+    char *in( &buffer[ 0 ] );
+    char *end( in + buffer.size() );
+    EXPECT_EQ( end, lookForNextToken( in, end ) );
+    EXPECT_EQ( end, lookForNextToken( end, end ) );
+}
+
 TEST_F( OpenDDLParserTest, hex2DecimalTest ) {
     int res = hex2Decimal( '1' );
     EXPECT_EQ( 1, res );
@@ -142,6 +160,36 @@ TEST_F( OpenDDLParserTest, setLogCallbackTest ) {
     EXPECT_NE( &OpenDDLParserTest::testLogCallback, myParser.getLogCallback() );
 }
 
+TEST_F( OpenDDLParserTest, logSeverityTest ) {
+    // only a short excerpt of the rest of the buffer is part of the message
+    std::string token( "GeometryNode ] " );
+    token += std::string( 100000, 'x' );
+
+    OpenDDLParser myParser;
+    EXPECT_EQ( ddl_debug_msg, myParser.getLogSeverity() );
+    EXPECT_TRUE( myParser.isLogEnabled( ddl_debug_msg ) );
+    myParser.setLogCallback( OpenDDLParserTest::testLogCallback );
+    myParser.setBuffer( token.c_str(), token.size() );
+    EXPECT_FALSE( myParser.parse() );
+    ASSERT_EQ( 1U, getLogs().size() );
+    EXPECT_NE( std::string::npos, getLogs()[ 0 ].find( "expected \"{\"" ) );
+    EXPECT_LT( getLogs()[ 0 ].size(), 100U );
+    clearTestLog();
+
+    // filtered messages do not reach the callback
+    myParser.setLogSeverity( ddl_none_msg );
+    EXPECT_FALSE( myParser.isLogEnabled( ddl_error_msg ) );
+    myParser.setBuffer( token.c_str(), token.size() );
+    EXPECT_FALSE( myParser.parse() );
+    EXPECT_TRUE( getLogs().empty() );
+
+    myParser.setLogSeverity( ddl_warn_msg );
+    EXPECT_FALSE( myParser.isLogEnabled( ddl_info_msg ) );
+    EXPECT_TRUE( myParser.isLogEnabled( ddl_error_msg ) );
+    EXPECT_FALSE( myParser.parseFile( "notExisting.ddl" ) );
+    EXPECT_EQ( 1U, getLogs().size() );
+}
+
 TEST_F( OpenDDLParserTest, accessBufferTest ) {
     static const size_t len = 100;
     char *buffer = new char[ len ];
@@ -636,6 +684,66 @@ TEST_F( OpenDDLParserTest, parseDataArrayListWithArrayTest ) {
 }
 
 
+TEST_F( OpenDDLParserTest, parseHexFloatListTest ) {
+    static const char token[] =
+        "Metric { float { 0x7FC00000, 0x7F800000, 0x3F800000 } }\n"
+        "Metric { double { 0xFFF0000000000000 } }\n"
+        "Metric { half { 0x3E00 } }\n";
+
+    // the hex literals of floating point lists are bits, also with the structural index
+    for( int i = 0; i < 2; i++ ) {
+        OpenDDLParser theParser;
+        theParser.setUseStructuralIndex( 1 == i );
+        theParser.setBuffer( token, strlen( token ) );
+        ASSERT_TRUE( theParser.parse() );
+        const DDLNode::DllNodeList &childs( theParser.getRoot()->getChildNodeList() );
+        ASSERT_EQ( 3U, childs.size() );
+
+        Value *value( childs[ 0 ]->getValue() );
+        ASSERT_NE( ddl_nullptr, value );
+        EXPECT_EQ( Value::ddl_float, value->m_type );
+        EXPECT_TRUE( std::isnan( value->getFloat() ) );
+        ASSERT_NE( ddl_nullptr, value->m_next );
+        EXPECT_TRUE( std::isinf( value->m_next->getFloat() ) );
+        ASSERT_NE( ddl_nullptr, value->m_next->m_next );
+        EXPECT_FLOAT_EQ( 1.0f, value->m_next->m_next->getFloat() );
+
+        value = childs[ 1 ]->getValue();
+        ASSERT_NE( ddl_nullptr, value );
+        EXPECT_EQ( Value::ddl_double, value->m_type );
+        EXPECT_TRUE( std::isinf( value->getDouble() ) );
+        EXPECT_GT( 0.0, value->getDouble() );
+
+        value = childs[ 2 ]->getValue();
+        ASSERT_NE( ddl_nullptr, value );
+        EXPECT_EQ( Value::ddl_float, value->m_type );
+        EXPECT_FLOAT_EQ( 1.5f, value->getFloat() );
+    }
+
+    // the exporter writes nan and infinity as bits, they read back with their type
+    OpenDDLParser theParser;
+    theParser.setBuffer( token, strlen( token ) );
+    ASSERT_TRUE( theParser.parse() );
+    std::string result;
+    OpenDDLExport myExporter( new StringStream( result ) );
+    ASSERT_TRUE( myExporter.exportContext( theParser.getContext(), "" ) );
+    EXPECT_NE( std::string::npos, result.find( "0x7FC00000, 0x7F800000, 1" ) );
+    EXPECT_NE( std::string::npos, result.find( "0xFFF0000000000000" ) );
+
+    OpenDDLParser reparser;
+    reparser.setBuffer( result.c_str(), result.size() );
+    ASSERT_TRUE( reparser.parse() );
+    ASSERT_EQ( 3U, reparser.getRoot()->getChildNodeList().size() );
+    Value *value( reparser.getRoot()->getChildNodeList()[ 0 ]->getValue() );
+    ASSERT_NE( ddl_nullptr, value );
+    EXPECT_EQ( Value::ddl_float, value->m_type );
+    EXPECT_TRUE( std::isnan( value->getFloat() ) );
+    value = reparser.getRoot()->getChildNodeList()[ 1 ]->getValue();
+    ASSERT_NE( ddl_nullptr, value );
+    EXPECT_EQ( Value::ddl_double, value->m_type );
+    EXPECT_TRUE( std::isinf( value->getDouble() ) );
+}
+
 TEST_F( OpenDDLParserTest, parseDataArrayListWithRefsTest ) {
     char token[] =
         "ref{ $alice }\n"; // data list with references
@@ -760,5 +868,625 @@ TEST_F( OpenDDLParserTest, parseHexValueLiteralTest ) {
     EXPECT_FLOAT_EQ( 1.0f, val );
 }
 
+TEST_F( OpenDDLParserTest, treeIndexTest ) {
+    char token[] =
+        "GeometryObject {\n"
+        "    Mesh { VertexArray { float { 1.0 } } }\n"
+        "}\n"
+        "Metric { float { 1.0 } }\n";
+
+    OpenDDLParser theParser;
+    theParser.setBuffer( token, strlen( token ) );
+    ASSERT_TRUE( theParser.parse() );
+
+    DDLNode *root( theParser.getRoot() );
+    ASSERT_NE( ddl_nullptr, root );
+    EXPECT_EQ( 0U, root->getTreeIndex() );
+    EXPECT_EQ( 5U, root->getSubtreeSize() );
+
+    DDLNode *geometry( root->getChildNodeList()[ 0 ] );
+    DDLNode *mesh( geometry->getChildNodeList()[ 0 ] );
+    DDLNode *vertexArray( mesh->getChildNodeList()[ 0 ] );
+    DDLNode *metric( root->getChildNodeList()[ 1 ] );
+    EXPECT_EQ( 1U, geometry->getTreeIndex() );
+    EXPECT_EQ( 3U, geometry->getSubtreeSize() );
+    EXPECT_EQ( 3U, vertexArray->getTreeIndex() );
+    EXPECT_EQ( 4U, metric->getTreeIndex() );
+    EXPECT_EQ( 1U, metric->getSubtreeSize() );
+    EXPECT_TRUE( geometry->isAncestorOf( vertexArray ) );
+    EXPECT_TRUE( vertexArray->isDescendantOf( root ) );
+    EXPECT_FALSE( metric->isAncestorOf( vertexArray ) );
+}
+
+TEST_F( OpenDDLParserTest, lazyTreeIndexTest ) {
+    char token[] =
+        "GeometryObject { Mesh { float { 1.0 } } }\n"
+        "Metric { float { 1.0 } }\n";
+
+    OpenDDLParser theParser;
+    theParser.setLazyParsing( true, 1 );
+    theParser.setBuffer( token, strlen( token ) );
+    ASSERT_TRUE( theParser.parse() );
+
+    // materialized children are not numbered, the checks fall back to the parents
+    DDLNode *root( theParser.getRoot() );
+    DDLNode *geometry( root->getChildNodeList()[ 0 ] );
+    DDLNode *metric( root->getChildNodeList()[ 1 ] );
+    EXPECT_EQ( 2U, metric->getTreeIndex() );
+    DDLNode *mesh( geometry->getChildNodeList()[ 0 ] );
+    EXPECT_EQ( DDLNode::InvalidTreeIndex, mesh->getTreeIndex() );
+    EXPECT_TRUE( root->isAncestorOf( mesh ) );
+    EXPECT_TRUE( geometry->isAncestorOf( mesh ) );
+    EXPECT_FALSE( metric->isAncestorOf( mesh ) );
+
+    root->updateTreeIndex();
+    EXPECT_EQ( 2U, mesh->getTreeIndex() );
+    EXPECT_EQ( 3U, metric->getTreeIndex() );
+    EXPECT_TRUE( geometry->isAncestorOf( mesh ) );
+}
+
+TEST_F( OpenDDLParserTest, lazyTypeMaskTest ) {
+    char token[] =
+        "GeometryObject { Mesh { Animation { float { 1.0 } } } }\n"
+        "Metric { float { 1.0 } }\n";
+
+    OpenDDLParser theParser;
+    theParser.setLazyParsing( true, 1 );
+    theParser.setBuffer( token, strlen( token ) );
+    ASSERT_TRUE( theParser.parse() );
+
+    // skipped bodies may contain every type, the search materializes them on demand
+    DDLNode *root( theParser.getRoot() );
+    DDLNode *geometry( root->getChildNodeList()[ 0 ] );
+    EXPECT_TRUE( geometry->mayContainType( "Skin" ) );
+    DDLNode *animation( root->findFirstNodeByType( "Animation" ) );
+    ASSERT_NE( ddl_nullptr, animation );
+    EXPECT_TRUE( animation->isDescendantOf( geometry ) );
+}
+
+TEST_F( OpenDDLParserTest, lazyParsingTest ) {
+    char token[] =
+        "GeometryObject $geometry1 {\n"
+        "    Mesh {\n"
+        "        VertexArray { float { 1.0, 2.0, 3.0 } }\n"
+        "        Name { string { \"{ not a bracket }\" } }\n"
+        "    }\n"
+        "}\n"
+        "Metric { float { 1.0 } }\n";
+
+    OpenDDLParser theParser;
+    EXPECT_FALSE( theParser.isLazyParsingEnabled() );
+    theParser.setLazyParsing( true, 1 );
+    EXPECT_TRUE( theParser.isLazyParsingEnabled() );
+    theParser.setBuffer( token, strlen( token ) );
+    ASSERT_TRUE( theParser.parse() );
+
+    DDLNode *root( theParser.getRoot() );
+    ASSERT_NE( ddl_nullptr, root );
+    const DDLNode::DllNodeList &childs( root->getChildNodeList() );
+    ASSERT_EQ( 2U, childs.size() );
+    DDLNode *geometry( childs[ 0 ] );
+    EXPECT_EQ( "GeometryObject", geometry->getType() );
+    EXPECT_EQ( "geometry1", geometry->getName() );
+    EXPECT_FALSE( geometry->isMaterialized() );
+    EXPECT_FALSE( childs[ 1 ]->isMaterialized() );
+
+    // the first access will parse the body, the nested structures are skipped again
+    const DDLNode::DllNodeList &meshes( geometry->getChildNodeList() );
+    EXPECT_TRUE( geometry->isMaterialized() );
+    ASSERT_EQ( 1U, meshes.size() );
+    EXPECT_EQ( "Mesh", meshes[ 0 ]->getType() );
+    EXPECT_FALSE( meshes[ 0 ]->isMaterialized() );
+
+    const DDLNode::DllNodeList &arrays( meshes[ 0 ]->getChildNodeList() );
+    ASSERT_EQ( 2U, arrays.size() );
+    Value *v( arrays[ 0 ]->getValue() );
+    ASSERT_NE( ddl_nullptr, v );
+    EXPECT_EQ( 3U, countItems( v ) );
+    EXPECT_FLOAT_EQ( 1.0f, v->getFloat() );
+
+    v = arrays[ 1 ]->getValue();
+    ASSERT_NE( ddl_nullptr, v );
+    EXPECT_STREQ( "{ not a bracket }", v->getString() );
+
+    v = childs[ 1 ]->getValue();
+    ASSERT_NE( ddl_nullptr, v );
+    EXPECT_FLOAT_EQ( 1.0f, v->getFloat() );
+}
+
+TEST_F( OpenDDLParserTest, lazyParsingDepthTest ) {
+    char token[] =
+        "GeometryObject {\n"
+        "    Mesh {\n"
+        "        VertexArray { float { 1.0 } }\n"
+        "    }\n"
+        "}\n";
+
+    OpenDDLParser theParser;
+    theParser.setLazyParsing( true, 2 );
+    theParser.setBuffer( token, strlen( token ) );
+    ASSERT_TRUE( theParser.parse() );
+
+    DDLNode *geometry( theParser.getRoot()->getChildNodeList()[ 0 ] );
+    EXPECT_TRUE( geometry->isMaterialized() );
+    DDLNode *mesh( geometry->getChildNodeList()[ 0 ] );
+    EXPECT_FALSE( mesh->isMaterialized() );
+    EXPECT_TRUE( mesh->materialize() );
+    EXPECT_TRUE( mesh->isMaterialized() );
+    ASSERT_EQ( 1U, mesh->getChildNodeList().size() );
+
+    // every materialization only parses the next level
+    DDLNode *vertexArray( mesh->getChildNodeList()[ 0 ] );
+    EXPECT_FALSE( vertexArray->isMaterialized() );
+    ASSERT_NE( ddl_nullptr, vertexArray->getValue() );
+    EXPECT_TRUE( vertexArray->isMaterialized() );
+}
+
+TEST_F( OpenDDLParserTest, indexedParsingTest ) {
+    char token[] =
+        "Metric( key = \"distance\" ) { float { 1 } }\n"
+        "GeometryObject $geometry1 { // comment { with brackets\n"
+        "    Mesh {\n"
+        "        VertexArray { float[ 3 ] { { 1.5, -2.0, 3 }, { 0x3F800000, 0, 0 } } }\n"
+        "        IndexArray { unsigned_int32 { 0, 1, 2, 4294967295 } }\n"
+        "        Offsets { int64 { 12, 9000000000 } }\n"
+        "        Scale { double { 0.25 } }\n"
+        "        Name { string { \"{ not a bracket }\" } }\n"
+        "    }\n"
+        "}\n";
+
+    OpenDDLParser theParser;
+    EXPECT_FALSE( theParser.isStructuralIndexEnabled() );
+    theParser.setUseStructuralIndex( true );
+    EXPECT_TRUE( theParser.isStructuralIndexEnabled() );
+    theParser.setBuffer( token, strlen( token ) );
+    ASSERT_TRUE( theParser.parse() );
+
+    DDLNode *root( theParser.getRoot() );
+    ASSERT_EQ( 2U, root->getChildNodeList().size() );
+    DDLNode *mesh( root->getChildNodeList()[ 1 ]->getChildNodeList()[ 0 ] );
+    const DDLNode::DllNodeList &childs( mesh->getChildNodeList() );
+    ASSERT_EQ( 5U, childs.size() );
+
+    DataArrayList *dtArrayList( childs[ 0 ]->getDataArrayList() );
+    ASSERT_NE( ddl_nullptr, dtArrayList );
+    EXPECT_EQ( 3U, dtArrayList->m_numItems );
+    std::list<float> expFloats;
+    expFloats.push_back( 1.5f );
+    expFloats.push_back( -2.0f );
+    expFloats.push_back( 3.0f );
+    EXPECT_TRUE( testValues( Value::ddl_float, dtArrayList->m_dataList, expFloats ) );
+    ASSERT_NE( ddl_nullptr, dtArrayList->m_next );
+    EXPECT_EQ( 3U, dtArrayList->m_next->m_numItems );
+    EXPECT_EQ( ddl_nullptr, dtArrayList->m_next->m_next );
+
+    std::list<uint32> expIndices;
+    expIndices.push_back( 0 );
+    expIndices.push_back( 1 );
+    expIndices.push_back( 2 );
+    expIndices.push_back( 4294967295U );
+    EXPECT_TRUE( testValues( Value::ddl_unsigned_int32, childs[ 1 ]->getValue(), expIndices ) );
+    EXPECT_EQ( 4U, countItems( childs[ 1 ]->getValue() ) );
+
+    std::list<int64> expOffsets;
+    expOffsets.push_back( 12 );
+    expOffsets.push_back( 9000000000LL );
+    EXPECT_TRUE( testValues( Value::ddl_int64, childs[ 2 ]->getValue(), expOffsets ) );
+
+    ASSERT_NE( ddl_nullptr, childs[ 3 ]->getValue() );
+    EXPECT_DOUBLE_EQ( 0.25, childs[ 3 ]->getValue()->getDouble() );
+    ASSERT_NE( ddl_nullptr, childs[ 4 ]->getValue() );
+    EXPECT_STREQ( "{ not a bracket }", childs[ 4 ]->getValue()->getString() );
+}
+
+TEST_F( OpenDDLParserTest, indexedLazyParsingTest ) {
+    char token[] =
+        "GeometryObject { Mesh { VertexArray { float { 1.0, 2.0 } } } }\n"
+        "GeometryObject { Name { string { \"}\" } } }\n";
+
+    OpenDDLParser theParser;
+    theParser.setUseStructuralIndex( true );
+    theParser.setLazyParsing( true, 1 );
+    theParser.setBuffer( token, strlen( token ) );
+    ASSERT_TRUE( theParser.parse() );
+
+    const DDLNode::DllNodeList &childs( theParser.getRoot()->getChildNodeList() );
+    ASSERT_EQ( 2U, childs.size() );
+    EXPECT_FALSE( childs[ 0 ]->isMaterialized() );
+    DDLNode *vertexArray( childs[ 0 ]->getChildNodeList()[ 0 ]->getChildNodeList()[ 0 ] );
+    EXPECT_EQ( 2U, countItems( vertexArray->getValue() ) );
+    EXPECT_STREQ( "}", childs[ 1 ]->getChildNodeList()[ 0 ]->getValue()->getString() );
+}
+
+TEST_F( OpenDDLParserTest, exportRoundTripTest ) {
+    char token[] =
+        "GeometryNode $node1 {\n"
+        "    Metric (key = \"distance\") { float { 1, 2 } }\n"
+        "    Array { int32[ 2 ] { { 1, 2 }, { 3, 4 } } }\n"
+        "}\n"
+        "Material $material1 { string { \"name\" } }\n";
+
+    OpenDDLParser theParser;
+    theParser.setBuffer( token, strlen( token ) );
+    ASSERT_TRUE( theParser.parse() );
+
+    std::string result;
+    OpenDDLExport myExporter( new StringStream( result ) );
+    EXPECT_TRUE( myExporter.exportContext( theParser.getContext(), "" ) );
+    EXPECT_EQ(
+        "GeometryNode $node1 {\n"
+        "    Metric (key = \"distance\") {\n"
+        "        float { 1, 2 }\n"
+        "    }\n"
+        "    Array {\n"
+        "        int32[2] { { 1, 2 }, { 3, 4 } }\n"
+        "    }\n"
+        "}\n"
+        "Material $material1 {\n"
+        "    string { \"name\" }\n"
+        "}\n", result );
+
+    // the exported text must lead to the same tree
+    OpenDDLParser reParser;
+    reParser.setBuffer( result.c_str(), result.size() );
+    ASSERT_TRUE( reParser.parse() );
+    std::string reExported;
+    OpenDDLExport reExporter( new StringStream( reExported ) );
+    EXPECT_TRUE( reExporter.exportContext( reParser.getContext(), "" ) );
+    EXPECT_EQ( result, reExported );
+}
+
+TEST_F( OpenDDLParserTest, exportOutputModeTest ) {
+    char token[] =
+        "GeometryNode $node1 {\n"
+        "    Metric (key = \"distance\") { float { 1, 2 } }\n"
+        "    Array { int32[ 2 ] { { 1, 2 }, { 3, 4 } } }\n"
+        "}\n";
+
+    OpenDDLParser theParser;
+    theParser.setBuffer( token, strlen( token ) );
+    ASSERT_TRUE( theParser.parse() );
+
+    std::string compact;
+    OpenDDLExport compactExporter( new StringStream( compact ) );
+    compactExporter.setOutputMode( OpenDDLExport::CompactOutput );
+    EXPECT_EQ( OpenDDLExport::CompactOutput, compactExporter.getOutputMode() );
+    EXPECT_TRUE( compactExporter.exportContext( theParser.getContext(), "" ) );
+    EXPECT_EQ( "GeometryNode $node1{Metric(key=\"distance\"){float{1,2}}Array{int32[2]{{1,2},{3,4}}}}", compact );
+
+    std::string pretty;
+    OpenDDLExport prettyExporter( new StringStream( pretty ) );
+    prettyExporter.setIndentation( 1, '\t' );
+    EXPECT_EQ( 1U, prettyExporter.getIndentationWidth() );
+    EXPECT_TRUE( prettyExporter.exportContext( theParser.getContext(), "" ) );
+    EXPECT_EQ(
+        "GeometryNode $node1 {\n"
+        "\tMetric (key = \"distance\") {\n"
+        "\t\tfloat { 1, 2 }\n"
+        "\t}\n"
+        "\tArray {\n"
+        "\t\tint32[2] { { 1, 2 }, { 3, 4 } }\n"
+        "\t}\n"
+        "}\n", pretty );
+
+    // both layouts describe the same tree
+    OpenDDLParser compactParser;
+    compactParser.setBuffer( compact.c_str(), compact.size() );
+    ASSERT_TRUE( compactParser.parse() );
+    std::string reExported;
+    OpenDDLExport reExporter( new StringStream( reExported ) );
+    reExporter.setIndentation( 1, '\t' );
+    EXPECT_TRUE( reExporter.exportContext( compactParser.getContext(), "" ) );
+    EXPECT_EQ( pretty, reExported );
+}
+
+TEST_F( OpenDDLParserTest, parallelParseTest ) {
+    std::string token;
+    for( int i = 0; i < 200; i++ ) {
+        char buffer[ 256 ];
+        ::snprintf( buffer, sizeof( buffer ),
+            "GeometryNode $node%d {\n"
+            "    Metric (key = \"{distance}\") { float { %d, 2 } }\n"
+            "    Array { int32[ 2 ] { { %d, 2 }, { 3, 4 } } }\n"
+            "}\n", i, i, i );
+        token += buffer;
+    }
+
+    OpenDDLParser serialParser;
+    serialParser.setBuffer( token.c_str(), token.size() );
+    ASSERT_TRUE( serialParser.parse() );
+    std::string serial;
+    OpenDDLExport serialExporter( new StringStream( serial ) );
+    EXPECT_TRUE( serialExporter.exportContext( serialParser.getContext(), "" ) );
+
+    OpenDDLParser theParser;
+    theParser.setParallelParsing( true, 4 );
+    theParser.setParallelThreshold( 0 );
+    EXPECT_TRUE( theParser.isParallelParsingEnabled() );
+    EXPECT_EQ( 0U, theParser.getParallelThreshold() );
+    theParser.setBuffer( token.c_str(), token.size() );
+    ASSERT_TRUE( theParser.parse() );
+
+    // the structures are in document order and numbered like a serial parse
+    DDLNode *root( theParser.getRoot() );
+    const DDLNode::DllNodeList &childs( root->getChildNodeList() );
+    ASSERT_EQ( 200U, childs.size() );
+    EXPECT_EQ( "node0", childs[ 0 ]->getName() );
+    EXPECT_EQ( "node199", childs[ 199 ]->getName() );
+    EXPECT_EQ( root, childs[ 199 ]->getParent() );
+    EXPECT_EQ( 0U, root->getTreeIndex() );
+    EXPECT_EQ( 601U, root->getSubtreeSize() );
+    EXPECT_EQ( 598U, childs[ 199 ]->getTreeIndex() );
+    EXPECT_TRUE( root->isAncestorOf( childs[ 100 ]->getChildNodeList()[ 1 ] ) );
+    EXPECT_TRUE( root->mayContainType( "Metric" ) );
+    EXPECT_EQ( childs[ 0 ]->getChildNodeList()[ 0 ], root->findFirstNodeByType( "Metric" ) );
+
+    std::string parallel;
+    OpenDDLExport parallelExporter( new StringStream( parallel ) );
+    EXPECT_TRUE( parallelExporter.exportContext( theParser.getContext(), "" ) );
+    EXPECT_EQ( serial, parallel );
+}
+
+TEST_F( OpenDDLParserTest, parallelParseErrorTest ) {
+    std::string token;
+    for( int i = 0; i < 100; i++ ) {
+        token += "GeometryNode { Metric { float { 1, 2 } } }\n";
+    }
+    token += "GeometryNode ] { }\n";
+    for( int i = 0; i < 100; i++ ) {
+        token += "GeometryNode { Metric { float { 1, 2 } } }\n";
+    }
+
+    // an error in one chunk fails the whole parse
+    OpenDDLParser theParser;
+    theParser.setLogCallback( OpenDDLParserTest::testLogCallback );
+    theParser.setParallelParsing( true, 4 );
+    theParser.setParallelThreshold( 0 );
+    theParser.setBuffer( token.c_str(), token.size() );
+    EXPECT_FALSE( theParser.parse() );
+    EXPECT_FALSE( getLogs().empty() );
+}
+
+TEST_F( OpenDDLParserTest, parallelDataListTest ) {
+    // one structure with big data lists, the lists are split instead of the document
+    std::stringstream stream;
+    stream << "Mesh {\n    VertexArray { float[3] { ";
+    for( int i = 0; i < 30000; i++ ) {
+        stream << ( 0 == i ? "" : ", " ) << "{ " << i << ".5, " << i << ", 0x" << std::hex << i << std::dec << " }";
+    }
+    stream << " } }\n    IndexArray { unsigned_int32 { ";
+    for( int i = 0; i < 100000; i++ ) {
+        stream << ( 0 == i ? "" : ", " ) << i;
+    }
+    stream << " } }\n    Weights { double { ";
+    for( int i = 0; i < 50000; i++ ) {
+        stream << ( 0 == i ? "" : "," ) << i << ".25";
+    }
+    stream << " } }\n}\n";
+    const std::string token( stream.str() );
+
+    OpenDDLParser serialParser;
+    serialParser.setBuffer( token.c_str(), token.size() );
+    ASSERT_TRUE( serialParser.parse() );
+    std::string serial;
+    OpenDDLExport serialExporter( new StringStream( serial ) );
+    EXPECT_TRUE( serialExporter.exportContext( serialParser.getContext(), "" ) );
+
+    OpenDDLParser theParser;
+    theParser.setParallelParsing( true, 4 );
+    theParser.setParallelThreshold( 0 );
+    theParser.setBuffer( token.c_str(), token.size() );
+    ASSERT_TRUE( theParser.parse() );
+    const DDLNode::DllNodeList &childs( theParser.getRoot()->getChildNodeList()[ 0 ]->getChildNodeList() );
+    ASSERT_EQ( 3U, childs.size() );
+    size_t numLists( 0 );
+    for( DataArrayList *list = childs[ 0 ]->getDataArrayList(); ddl_nullptr != list; list = list->m_next ) {
+        EXPECT_EQ( 3U, list->m_numItems );
+        numLists++;
+    }
+    EXPECT_EQ( 30000U, numLists );
+    ASSERT_NE( ddl_nullptr, childs[ 1 ]->getValue() );
+    EXPECT_EQ( 100000U, childs[ 1 ]->getValue()->size() );
+    EXPECT_EQ( 50000U, childs[ 2 ]->getValue()->size() );
+
+    std::string parallel;
+    OpenDDLExport parallelExporter( new StringStream( parallel ) );
+    EXPECT_TRUE( parallelExporter.exportContext( theParser.getContext(), "" ) );
+    EXPECT_EQ( serial, parallel );
+}
+
+TEST_F( OpenDDLParserTest, apostropheInStringTest ) {
+    // only the double quote delimits a string literal, in every bracket scanner
+    std::string token;
+    for( int i = 0; i < 100; i++ ) {
+        token += "Name { string { \"it's {\" } }\n";
+        token += "Metric { float { 1, 2 } }\n";
+    }
+
+    OpenDDLParser serialParser;
+    serialParser.setBuffer( token.c_str(), token.size() );
+    ASSERT_TRUE( serialParser.parse() );
+    ASSERT_EQ( 200U, serialParser.getRoot()->getChildNodeList().size() );
+    std::string serial;
+    OpenDDLExport serialExporter( new StringStream( serial ) );
+    EXPECT_TRUE( serialExporter.exportContext( serialParser.getContext(), "" ) );
+
+    OpenDDLParser parallelParser;
+    parallelParser.setParallelParsing( true, 4 );
+    parallelParser.setParallelThreshold( 0 );
+    parallelParser.setBuffer( token.c_str(), token.size() );
+    ASSERT_TRUE( parallelParser.parse() );
+    std::string parallel;
+    OpenDDLExport parallelExporter( new StringStream( parallel ) );
+    EXPECT_TRUE( parallelExporter.exportContext( parallelParser.getContext(), "" ) );
+    EXPECT_EQ( serial, parallel );
+
+    OpenDDLParser indexedParser;
+    indexedParser.setUseStructuralIndex( true );
+    indexedParser.setBuffer( token.c_str(), token.size() );
+    ASSERT_TRUE( indexedParser.parse() );
+    std::string indexed;
+    OpenDDLExport indexedExporter( new StringStream( indexed ) );
+    EXPECT_TRUE( indexedExporter.exportContext( indexedParser.getContext(), "" ) );
+    EXPECT_EQ( serial, indexed );
+
+    const char *filename( "apostropheInStringTest.ddl" );
+    FILE *file( ::fopen( filename, "wb" ) );
+    ASSERT_NE( ddl_nullptr, file );
+    ::fwrite( token.c_str(), 1, token.size(), file );
+    ::fclose( file );
+
+    OpenDDLParser lazyParser;
+    lazyParser.setLazyParsing( true );
+    ASSERT_TRUE( lazyParser.parseFile( filename, 16 ) );
+    ::remove( filename );
+    std::string lazy;
+    OpenDDLExport lazyExporter( new StringStream( lazy ) );
+    EXPECT_TRUE( lazyExporter.exportContext( lazyParser.getContext(), "" ) );
+    EXPECT_EQ( serial, lazy );
+}
+
+TEST_F( OpenDDLParserTest, parseFileTest ) {
+    std::string token;
+    for( int i = 0; i < 20; i++ ) {
+        char buffer[ 256 ];
+        ::snprintf( buffer, sizeof( buffer ),
+            "// structure { %d\n"
+            "GeometryNode $node%d {\n"
+            "    Metric (key = \"{dist}ance}\") { float { %d, 2 } } // }\n"
+            "    Array { int32[ 2 ] { { %d, 2 }, { 3, 4 } } }\n"
+            "}\n", i, i, i, i );
+        token += buffer;
+    }
+    token += "Material $material1 { string { \"name\" } } // no new line";
+
+    const char *filename( "parseFileTest.ddl" );
+    FILE *file( ::fopen( filename, "wb" ) );
+    ASSERT_NE( ddl_nullptr, file );
+    ::fwrite( token.c_str(), 1, token.size(), file );
+    ::fclose( file );
+
+    OpenDDLParser serialParser;
+    serialParser.setBuffer( token.c_str(), token.size() );
+    ASSERT_TRUE( serialParser.parse() );
+    std::string serial;
+    OpenDDLExport serialExporter( new StringStream( serial ) );
+    EXPECT_TRUE( serialExporter.exportContext( serialParser.getContext(), "" ) );
+
+    // small blocks split structures, strings and comments
+    OpenDDLParser theParser;
+    ASSERT_TRUE( theParser.parseFile( filename, 16 ) );
+    DDLNode *root( theParser.getRoot() );
+    ASSERT_EQ( 21U, root->getChildNodeList().size() );
+    EXPECT_EQ( "node19", root->getChildNodeList()[ 19 ]->getName() );
+    EXPECT_EQ( 62U, root->getSubtreeSize() );
+    std::string blocks;
+    OpenDDLExport blockExporter( new StringStream( blocks ) );
+    EXPECT_TRUE( blockExporter.exportContext( theParser.getContext(), "" ) );
+    EXPECT_EQ( serial, blocks );
+
+    // the lazy nodes are parsed from the grown buffer
+    OpenDDLParser lazyParser;
+    lazyParser.setLazyParsing( true );
+    ASSERT_TRUE( lazyParser.parseFile( filename, 7 ) );
+    std::string lazy;
+    OpenDDLExport lazyExporter( new StringStream( lazy ) );
+    EXPECT_TRUE( lazyExporter.exportContext( lazyParser.getContext(), "" ) );
+    EXPECT_EQ( serial, lazy );
+    ::remove( filename );
+
+    EXPECT_FALSE( theParser.parseFile( "notExisting.ddl" ) );
+}
+
+TEST_F( OpenDDLParserTest, progressCallbackTest ) {
+    static const char token[] =
+        "Metric { float { 1 } }\n"
+        "GeometryNode { Metric { float { 2 } } }\n"
+        "Metric { float { 3 } }\n";
+
+    std::vector<size_t> positions;
+    OpenDDLParser theParser;
+    theParser.setProgressCallback( [&positions]( size_t pos, size_t size ) {
+        EXPECT_LE( pos, size );
+        positions.push_back( pos );
+        return true;
+    } );
+    EXPECT_TRUE( static_cast<bool>( theParser.getProgressCallback() ) );
+    theParser.setBuffer( token, strlen( token ) );
+    ASSERT_TRUE( theParser.parse() );
+    ASSERT_EQ( 4U, positions.size() );
+    EXPECT_EQ( 0U, positions[ 0 ] );
+    for( size_t i = 1; i < positions.size(); i++ ) {
+        EXPECT_LT( positions[ i - 1 ], positions[ i ] );
+    }
+
+    // the callback cancels the parsing before the third structure
+    size_t numCalls( 0 );
+    theParser.setProgressCallback( [&numCalls]( size_t, size_t ) {
+        return ++numCalls < 3;
+    } );
+    theParser.setBuffer( token, strlen( token ) );
+    EXPECT_FALSE( theParser.parse() );
+    EXPECT_EQ( 3U, numCalls );
+}
+
+static float sumTree( const DDLNode *node, size_t &numNodes ) {
+    ++numNodes;
+    float sum( 0.0f );
+    for( const Value *v( node->getValue() ); ddl_nullptr != v; v = v->getNext() ) {
+        if( Value::ddl_float == v->m_type ) {
+            sum += v->getFloat();
+        }
+    }
+    const DDLNode::DllNodeList &childs( node->getChildNodeList() );
+    for( size_t i = 0; i < childs.size(); i++ ) {
+        sum += sumTree( childs[ i ], numNodes );
+    }
+
+    return sum;
+}
+
+TEST_F( OpenDDLParserTest, concurrentReadTest ) {
+    std::string token;
+    for( int i = 0; i < 50; i++ ) {
+        char buffer[ 256 ];
+        ::snprintf( buffer, sizeof( buffer ),
+            "GeometryObject $geometry%d {\n"
+            "    Mesh (lod = %d) {\n"
+            "        VertexArray { float { %d, 1, 2 } }\n"
+            "        Name { string { \"mesh\" } }\n"
+            "    }\n"
+            "}\n", i, i, i );
+        token += buffer;
+    }
+
+    // the lazy bodies are parsed by the first thread which reads them
+    OpenDDLParser theParser;
+    theParser.setLazyParsing( true, 1 );
+    theParser.setBuffer( token.c_str(), token.size() );
+    ASSERT_TRUE( theParser.parse() );
+    const DDLNode *root( theParser.getRoot() );
+    const OpenDDLQuery query( "GeometryObject/Mesh[lod=7]/VertexArray" );
+
+    const size_t numReaders( 8 );
+    std::vector<float> sums( numReaders, 0.0f );
+    std::vector<size_t> numNodes( numReaders, 0 ), numArrays( numReaders, 0 );
+    std::vector<DDLNode*> found( numReaders, ddl_nullptr );
+    ThreadPool pool( 4 );
+    pool.parallelFor( numReaders, [&]( size_t i ) {
+        DDLNode::DllNodeList arrays;
+        numArrays[ i ] = root->findNodesByType( "VertexArray", arrays );
+        found[ i ] = query.executeFirst( root );
+        sums[ i ] = sumTree( root, numNodes[ i ] );
+    } );
+
+    for( size_t i = 0; i < numReaders; i++ ) {
+        EXPECT_FLOAT_EQ( 1225.0f + 150.0f, sums[ i ] );
+        EXPECT_EQ( 201U, numNodes[ i ] );
+        EXPECT_EQ( 50U, numArrays[ i ] );
+        ASSERT_NE( ddl_nullptr, found[ i ] );
+        EXPECT_FLOAT_EQ( 7.0f, found[ i ]->getValue()->getFloat() );
+    }
+}
 
 END_ODDLPARSER_NS
@@ -189,6 +189,22 @@ TEST_F( OpenDDLParserUtilsTest, isStringLiteralTest ) {
     EXPECT_FALSE( isStringLiteral<char>( val ) );
 }
 
+TEST_F( OpenDDLParserUtilsTest, skipStringLiteralTest ) {
+    // the apostrophe is a plain character, the escaped quote does not close the literal
+    const char token[] = "\"it's \\\" {\" }";
+    const char *end( token + strlen( token ) );
+    const char *close( skipStringLiteral( token, end ) );
+    ASSERT_NE( end, close );
+    EXPECT_EQ( 10, close - token );
+
+    const char open[] = "\"it's {";
+    EXPECT_EQ( open + strlen( open ), skipStringLiteral( open, open + strlen( open ) ) );
+
+    const char brackets[] = "{ 'a' \"}'\" { } }";
+    const char *bracketsEnd( brackets + strlen( brackets ) );
+    EXPECT_EQ( bracketsEnd - 1, findMatchingBracket( brackets, bracketsEnd ) );
+}
+
 TEST_F( OpenDDLParserUtilsTest, isHexLiteralTest ) {
     size_t len( 0 );
     char token1[] = "0x10";
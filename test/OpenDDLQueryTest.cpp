@@ -0,0 +1,124 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "gtest/gtest.h"
+
+#include <openddlparser/OpenDDLParser.h>
+#include <openddlparser/OpenDDLQuery.h>
+
+#include "UnitTestCommon.h"
+
+BEGIN_ODDLPARSER_NS
+
+class OpenDDLQueryTest : public testing::Test {
+protected:
+    OpenDDLParser m_parser;
+
+    virtual void SetUp() {
+        char token[] =
+            "GeometryObject $geometry1 {\n"
+            "    Mesh( lod = 0 ) {\n"
+            "        VertexArray( attrib = \"position\" ) { float[ 3 ] { { 1.0, 2.0, 3.0 } } }\n"
+            "        VertexArray( attrib = \"normal\" ) { float[ 3 ] { { 0.0, 0.0, 1.0 } } }\n"
+            "        IndexArray { unsigned_int32 { 0, 1, 2 } }\n"
+            "    }\n"
+            "    Mesh( primitive = \"triangles\" ) {\n"
+            "        VertexArray( attrib = \"position\" ) { float[ 3 ] { { 4.0, 5.0, 6.0 } } }\n"
+            "    }\n"
+            "}\n"
+            "GeometryNode $node1 {\n"
+            "    ObjectRef { ref { $geometry1 } }\n"
+            "}\n";
+        m_parser.setBuffer( token, strlen( token ) );
+        ASSERT_TRUE( m_parser.parse() );
+    }
+};
+
+TEST_F( OpenDDLQueryTest, compileTest ) {
+    OpenDDLQuery query;
+    EXPECT_FALSE( query.isValid() );
+    EXPECT_FALSE( query.compile( "" ) );
+    EXPECT_FALSE( query.compile( "Mesh[lod=0" ) );
+    EXPECT_FALSE( query.compile( "float/Mesh" ) );
+    EXPECT_FALSE( query.compile( "Mesh[=0]" ) );
+
+    EXPECT_TRUE( query.compile( "GeometryObject/Mesh[lod=0]/VertexArray[attrib=\"position\"]/float" ) );
+    EXPECT_TRUE( query.isValid() );
+    EXPECT_EQ( "GeometryObject/Mesh[lod=0]/VertexArray[attrib=\"position\"]/float", query.getExpression() );
+}
+
+TEST_F( OpenDDLQueryTest, executePathTest ) {
+    OpenDDLQuery query( "GeometryObject/Mesh[lod=0]/VertexArray[attrib=\"position\"]/float" );
+    ASSERT_TRUE( query.isValid() );
+
+    DDLNode::DllNodeList result;
+    EXPECT_EQ( 1U, query.execute( m_parser.getRoot(), result ) );
+    ASSERT_EQ( 1U, result.size() );
+    EXPECT_EQ( "VertexArray", result[ 0 ]->getType() );
+    EXPECT_EQ( "Mesh", result[ 0 ]->getParent()->getType() );
+
+    // a compiled query can be executed several times
+    result.clear();
+    EXPECT_EQ( 1U, query.execute( m_parser.getRoot(), result ) );
+
+    OpenDDLQuery intQuery( "GeometryObject/Mesh/IndexArray/float" );
+    EXPECT_EQ( ddl_nullptr, intQuery.executeFirst( m_parser.getRoot() ) );
+    intQuery.compile( "GeometryObject/Mesh/IndexArray/unsigned_int32" );
+    EXPECT_NE( ddl_nullptr, intQuery.executeFirst( m_parser.getRoot() ) );
+}
+
+TEST_F( OpenDDLQueryTest, executeDescendantsTest ) {
+    DDLNode::DllNodeList result;
+    OpenDDLQuery query( "//VertexArray" );
+    EXPECT_EQ( 3U, query.execute( m_parser.getRoot(), result ) );
+
+    result.clear();
+    query.compile( "//VertexArray[attrib=\"position\"]" );
+    EXPECT_EQ( 2U, query.execute( m_parser.getRoot(), result ) );
+
+    result.clear();
+    query.compile( "GeometryObject/*[primitive=\"triangles\"]//VertexArray" );
+    EXPECT_EQ( 1U, query.execute( m_parser.getRoot(), result ) );
+
+    result.clear();
+    query.compile( "//Mesh[primitive]" );
+    EXPECT_EQ( 1U, query.execute( m_parser.getRoot(), result ) );
+
+    result.clear();
+    query.compile( "//ref" );
+    EXPECT_EQ( 1U, query.execute( m_parser.getRoot(), result ) );
+    ASSERT_EQ( 1U, result.size() );
+    EXPECT_EQ( "ObjectRef", result[ 0 ]->getType() );
+}
+
+TEST_F( OpenDDLQueryTest, executeInvalidTest ) {
+    OpenDDLQuery query;
+    DDLNode::DllNodeList result;
+    EXPECT_EQ( 0U, query.execute( m_parser.getRoot(), result ) );
+
+    query.compile( "Mesh" );
+    EXPECT_EQ( 0U, query.execute( ddl_nullptr, result ) );
+    EXPECT_EQ( 0U, query.execute( m_parser.getRoot(), result ) );
+    EXPECT_TRUE( result.empty() );
+}
+
+END_ODDLPARSER_NS
@@ -0,0 +1,102 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "gtest/gtest.h"
+
+#include <openddlparser/OpenDDLReclaimer.h>
+#include <openddlparser/OpenDDLParser.h>
+#include <openddlparser/DDLNode.h>
+
+#include <sstream>
+
+BEGIN_ODDLPARSER_NS
+
+class ReclaimerTest : public testing::Test {
+protected:
+    static std::string createDocument( size_t numNodes ) {
+        std::stringstream stream;
+        for( size_t i = 0; i < numNodes; i++ ) {
+            stream << "GeometryNode $node" << i << " { Metric (key = \"distance\") { float { " << i << ", 2 } } }\n";
+        }
+
+        return stream.str();
+    }
+};
+
+TEST_F( ReclaimerTest, parserClearTest ) {
+    Reclaimer reclaimer;
+    EXPECT_FALSE( reclaimer.hasPending() );
+    const std::string token( createDocument( 20000 ) );
+    OpenDDLParser theParser;
+    EXPECT_EQ( ddl_nullptr, theParser.getReclaimer() );
+    theParser.setReclaimer( &reclaimer );
+    EXPECT_EQ( &reclaimer, theParser.getReclaimer() );
+
+    // the next parse creates nodes while the former ones are deleted
+    for( size_t i = 0; i < 3; i++ ) {
+        theParser.setBuffer( token.c_str(), token.size() );
+        ASSERT_TRUE( theParser.parse() );
+        EXPECT_EQ( 20000U, theParser.getRoot()->getChildNodeList().size() );
+    }
+    theParser.clear();
+    reclaimer.wait();
+    EXPECT_FALSE( reclaimer.hasPending() );
+}
+
+TEST_F( ReclaimerTest, retireSubtreeTest ) {
+    Reclaimer reclaimer;
+    const std::string token( createDocument( 100 ) );
+    OpenDDLParser theParser;
+    theParser.setBuffer( token.c_str(), token.size() );
+    ASSERT_TRUE( theParser.parse() );
+
+    DDLNode *root( theParser.getRoot() );
+    DDLNode *node( root->getChildNodeList()[ 10 ] );
+    reclaimer.retire( node );
+    ASSERT_EQ( 99U, root->getChildNodeList().size() );
+    EXPECT_EQ( "node11", root->getChildNodeList()[ 10 ]->getName() );
+    reclaimer.wait();
+
+    // the parser releases the remaining nodes only
+    theParser.clear();
+}
+
+TEST_F( ReclaimerTest, retireContextTest ) {
+    const std::string token( createDocument( 100 ) );
+    OpenDDLParser theParser;
+    theParser.setBuffer( token.c_str(), token.size() );
+    ASSERT_TRUE( theParser.parse() );
+
+    Context context;
+    context.m_root = theParser.getRoot()->getChildNodeList()[ 0 ];
+    {
+        // the destructor deletes the pending nodes
+        Reclaimer reclaimer;
+        reclaimer.retire( &context );
+        reclaimer.retire( static_cast<Context*>( ddl_nullptr ) );
+        reclaimer.retire( static_cast<DDLNode*>( ddl_nullptr ) );
+    }
+    EXPECT_EQ( ddl_nullptr, context.m_root );
+    EXPECT_EQ( 99U, theParser.getRoot()->getChildNodeList().size() );
+}
+
+END_ODDLPARSER_NS
@@ -0,0 +1,189 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "gtest/gtest.h"
+
+#include <openddlparser/OpenDDLSnapshot.h>
+#include <openddlparser/OpenDDLParser.h>
+#include <openddlparser/OpenDDLThreadPool.h>
+#include <openddlparser/DDLNode.h>
+#include <openddlparser/Value.h>
+
+#include <atomic>
+#include <cstring>
+
+BEGIN_ODDLPARSER_NS
+
+class SnapshotTest : public testing::Test {
+protected:
+    OpenDDLParser m_parser;
+
+    virtual void SetUp() {
+        char token[] =
+            "GeometryNode $node1 {\n"
+            "    Metric (key = \"distance\") { float { 1, 2 } }\n"
+            "    ObjectRef { ref { $node1 } }\n"
+            "}\n"
+            "Material $material1 { string { \"name\" } }\n";
+        m_parser.setBuffer( token, strlen( token ) );
+        ASSERT_TRUE( m_parser.parse() );
+    }
+
+    virtual void TearDown() {
+        m_parser.clear();
+    }
+};
+
+TEST_F( SnapshotTest, takeTest ) {
+    EXPECT_EQ( ddl_nullptr, Snapshot::take( static_cast<Context*>( ddl_nullptr ) ).get() );
+    DDLNode *root( m_parser.getRoot() );
+    EXPECT_TRUE( root->isDirty() );
+
+    SnapshotPtr snapshot( Snapshot::take( m_parser.getContext() ) );
+    ASSERT_NE( ddl_nullptr, snapshot.get() );
+    EXPECT_FALSE( root->isDirty() );
+    const SnapshotNode *snapshotRoot( snapshot->getRoot() );
+    ASSERT_EQ( 2U, snapshotRoot->getChildNodeList().size() );
+    const SnapshotNode *geometry( snapshotRoot->getChildNodeList()[ 0 ].get() );
+    EXPECT_EQ( "GeometryNode", geometry->getType() );
+    EXPECT_EQ( "node1", geometry->getName() );
+    const SnapshotNode *metric( geometry->getChildNodeList()[ 0 ].get() );
+    ASSERT_NE( ddl_nullptr, metric->findPropertyByName( "key" ) );
+    EXPECT_EQ( ddl_nullptr, metric->findPropertyByName( "other" ) );
+    EXPECT_STREQ( "distance", metric->findPropertyByName( "key" )->m_value->getString() );
+    ASSERT_NE( ddl_nullptr, metric->getValue() );
+    EXPECT_FLOAT_EQ( 1.0f, metric->getValue()->getFloat() );
+    EXPECT_FLOAT_EQ( 2.0f, metric->getValue()->getNext()->getFloat() );
+
+    // the snapshot owns copies of the data
+    EXPECT_NE( root->getChildNodeList()[ 0 ]->getChildNodeList()[ 0 ]->getValue(), metric->getValue() );
+}
+
+TEST_F( SnapshotTest, copyOnWriteTest ) {
+    DDLNode *root( m_parser.getRoot() );
+    DDLNode *geometryNode( root->getChildNodeList()[ 0 ] );
+    DDLNode *metricNode( geometryNode->getChildNodeList()[ 0 ] );
+    SnapshotPtr first( Snapshot::take( m_parser.getContext() ) );
+
+    // nothing changed, the whole tree is shared
+    SnapshotPtr same( Snapshot::take( m_parser.getContext() ) );
+    EXPECT_EQ( first->getRoot(), same->getRoot() );
+    EXPECT_LT( first->getVersion(), same->getVersion() );
+
+    // only the changed node and its path to the root are copied
+    metricNode->setName( "metric" );
+    EXPECT_TRUE( root->isDirty() );
+    EXPECT_FALSE( root->getChildNodeList()[ 1 ]->isDirty() );
+    DDLNode::create( "Color", "", root );
+    SnapshotPtr second( Snapshot::take( m_parser.getContext() ) );
+    EXPECT_NE( first->getRoot(), second->getRoot() );
+    ASSERT_EQ( 2U, first->getRoot()->getChildNodeList().size() );
+    ASSERT_EQ( 3U, second->getRoot()->getChildNodeList().size() );
+    EXPECT_EQ( "Color", second->getRoot()->getChildNodeList()[ 2 ]->getType() );
+    EXPECT_EQ( first->getRoot()->getChildNodeList()[ 1 ], second->getRoot()->getChildNodeList()[ 1 ] );
+
+    const SnapshotNode *oldGeometry( first->getRoot()->getChildNodeList()[ 0 ].get() );
+    const SnapshotNode *newGeometry( second->getRoot()->getChildNodeList()[ 0 ].get() );
+    EXPECT_NE( oldGeometry, newGeometry );
+    EXPECT_EQ( oldGeometry->getName(), newGeometry->getName() );
+    EXPECT_EQ( "", oldGeometry->getChildNodeList()[ 0 ]->getName() );
+    EXPECT_EQ( "metric", newGeometry->getChildNodeList()[ 0 ]->getName() );
+
+    // the unchanged data of a node on the path is shared as well
+    EXPECT_EQ( oldGeometry->getProperties(), newGeometry->getProperties() );
+    EXPECT_EQ( &oldGeometry->getType(), &newGeometry->getType() );
+    EXPECT_NE( oldGeometry->getChildNodeList()[ 0 ].get(), newGeometry->getChildNodeList()[ 0 ].get() );
+
+    // in-place changes need a touch
+    metricNode->getValue()->setFloat( 5.0f );
+    metricNode->touch();
+    SnapshotPtr third( Snapshot::take( m_parser.getContext() ) );
+    EXPECT_FLOAT_EQ( 1.0f, second->getRoot()->getChildNodeList()[ 0 ]->getChildNodeList()[ 0 ]->getValue()->getFloat() );
+    EXPECT_FLOAT_EQ( 5.0f, third->getRoot()->getChildNodeList()[ 0 ]->getChildNodeList()[ 0 ]->getValue()->getFloat() );
+
+    // a detached subtree is gone from the next snapshot, the old ones keep it
+    DDLNode *color( root->getChildNodeList()[ 2 ] );
+    color->detachParent();
+    delete color;
+    SnapshotPtr fourth( Snapshot::take( m_parser.getContext() ) );
+    EXPECT_EQ( 2U, fourth->getRoot()->getChildNodeList().size() );
+    EXPECT_EQ( "Color", third->getRoot()->getChildNodeList()[ 2 ]->getType() );
+}
+
+TEST_F( SnapshotTest, repeatedTakeTest ) {
+    DDLNode *root( m_parser.getRoot() );
+    DDLNode *metricNode( root->getChildNodeList()[ 0 ]->getChildNodeList()[ 0 ] );
+    DDLNode *objectRef( root->getChildNodeList()[ 0 ]->getChildNodeList()[ 1 ] );
+    ASSERT_NE( ddl_nullptr, objectRef->getReferences() );
+    Value *value( ValueAllocator::allocPrimData( Value::ddl_ref ) );
+    value->setRef( objectRef->getReferences() );
+    objectRef->setValue( value );
+
+    // every take copies the changed nodes and releases the copies of the former snapshot,
+    // the leak check of the address sanitizer covers the released payloads
+    SnapshotPtr snapshot;
+    for( int i = 0; i < 1000; i++ ) {
+        metricNode->getValue()->setFloat( static_cast<float>( i ) );
+        metricNode->touch();
+        objectRef->touch();
+        snapshot = Snapshot::take( m_parser.getContext() );
+    }
+    const SnapshotNode *geometry( snapshot->getRoot()->getChildNodeList()[ 0 ].get() );
+    EXPECT_FLOAT_EQ( 999.0f, geometry->getChildNodeList()[ 0 ]->getValue()->getFloat() );
+
+    // the names of a reference value are copied with their ids
+    const Reference *copy( geometry->getChildNodeList()[ 1 ]->getValue()->getRef() );
+    ASSERT_NE( ddl_nullptr, copy );
+    ASSERT_EQ( 1U, copy->m_numRefs );
+    EXPECT_NE( value->getRef()->m_referencedName[ 0 ]->m_id, copy->m_referencedName[ 0 ]->m_id );
+    EXPECT_EQ( "node1", std::string( copy->m_referencedName[ 0 ]->m_id->m_buffer ) );
+}
+
+TEST_F( SnapshotTest, concurrentReadTest ) {
+    DDLNode *root( m_parser.getRoot() );
+    DDLNode *metricNode( root->getChildNodeList()[ 0 ]->getChildNodeList()[ 0 ] );
+    SnapshotPtr snapshot( Snapshot::take( m_parser.getContext() ) );
+
+    // the readers see their snapshot while the tree changes
+    std::atomic<size_t> numMismatches( 0 );
+    ThreadPool pool( 4 );
+    for( size_t i = 0; i < 4; i++ ) {
+        pool.enqueue( [&]() {
+            for( size_t j = 0; j < 1000; j++ ) {
+                const SnapshotNode *metric( snapshot->getRoot()->getChildNodeList()[ 0 ]->getChildNodeList()[ 0 ].get() );
+                if( "" != metric->getName() || 2U != snapshot->getRoot()->getChildNodeList().size() ) {
+                    numMismatches++;
+                }
+            }
+        } );
+    }
+    for( size_t i = 0; i < 100; i++ ) {
+        metricNode->setName( "metric" );
+        DDLNode::create( "Color", "", root );
+        SnapshotPtr next( Snapshot::take( m_parser.getContext() ) );
+        EXPECT_EQ( i + 3, next->getRoot()->getChildNodeList().size() );
+    }
+    pool.wait();
+    EXPECT_EQ( 0U, numMismatches.load() );
+}
+
+END_ODDLPARSER_NS
@@ -0,0 +1,115 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "gtest/gtest.h"
+
+#include <openddlparser/OpenDDLStructuralIndex.h>
+
+#include "UnitTestCommon.h"
+
+BEGIN_ODDLPARSER_NS
+
+class OpenDDLStructuralIndexTest : public testing::Test {
+protected:
+    std::string getTokens( const StructuralIndex &index ) {
+        std::string tokens;
+        for( size_t i = 0; i < index.size(); i++ ) {
+            tokens += index.getToken( i );
+        }
+        return tokens;
+    }
+};
+
+TEST_F( OpenDDLStructuralIndexTest, buildTest ) {
+    StructuralIndex index;
+    EXPECT_TRUE( index.empty() );
+    EXPECT_TRUE( index.build( ddl_nullptr, 0 ) );
+    EXPECT_TRUE( index.empty() );
+
+    const char token[] = "Metric( key = \"distance\" ) { float[ 2 ] { { 1, 2 } } }";
+    EXPECT_TRUE( index.build( token, strlen( token ) ) );
+    EXPECT_EQ( "(=\"\"){[]{{,}}}", getTokens( index ) );
+    EXPECT_TRUE( index.isBalanced() );
+    EXPECT_EQ( 6U, index.getPosition( 0 ) );
+    EXPECT_EQ( token, index.getBuffer() );
+    EXPECT_TRUE( index.contains( token ) );
+    EXPECT_FALSE( index.contains( token + strlen( token ) ) );
+
+    index.clear();
+    EXPECT_TRUE( index.empty() );
+}
+
+TEST_F( OpenDDLStructuralIndexTest, maskStringsAndCommentsTest ) {
+    StructuralIndex index;
+    const char token[] =
+        "Name { string { \"{,} = ( [ a very long string, with separators ] )\" } } // { comment, }\n"
+        "Name { string { \"escaped \\\" quote {\" } }";
+    EXPECT_TRUE( index.build( token, strlen( token ) ) );
+    EXPECT_EQ( "{{\"\"}}{{\"\"}}", getTokens( index ) );
+    EXPECT_TRUE( index.isBalanced() );
+}
+
+TEST_F( OpenDDLStructuralIndexTest, matchTest ) {
+    StructuralIndex index;
+    const char token[] = "a { b ( c = 1 ) { d [ 2 ] } }";
+    EXPECT_TRUE( index.build( token, strlen( token ) ) );
+    ASSERT_EQ( "{(=){[]}}", getTokens( index ) );
+    EXPECT_EQ( 8U, index.getMatch( 0 ) );
+    EXPECT_EQ( 0U, index.getMatch( 8 ) );
+    EXPECT_EQ( 3U, index.getMatch( 1 ) );
+    EXPECT_EQ( 7U, index.getMatch( 4 ) );
+    EXPECT_EQ( StructuralIndex::InvalidIndex, index.getMatch( 2 ) );
+
+    EXPECT_EQ( 0U, index.find( 0 ) );
+    EXPECT_EQ( 0U, index.find( 2 ) );
+    EXPECT_EQ( 1U, index.find( 3 ) );
+    EXPECT_EQ( StructuralIndex::InvalidIndex, index.find( strlen( token ) ) );
+
+    const char unbalanced[] = "a { b ( }";
+    EXPECT_TRUE( index.build( unbalanced, strlen( unbalanced ) ) );
+    EXPECT_FALSE( index.isBalanced() );
+}
+
+TEST_F( OpenDDLStructuralIndexTest, blockBoundaryTest ) {
+    // strings, escapes and comments crossing the block boundaries must be tracked
+    std::string token;
+    std::string expected;
+    for( size_t i = 0; i < 64; i++ ) {
+        token += std::string( i % 17, ' ' );
+        token += "{\"";
+        token += std::string( i % 13, 'x' );
+        token += ",\\\"}";
+        token += "\"";
+        token += "} // ,{\n";
+        expected += "{\"\"}";
+    }
+
+    StructuralIndex index;
+    EXPECT_TRUE( index.build( token.c_str(), token.size() ) );
+    EXPECT_EQ( expected, getTokens( index ) );
+    EXPECT_TRUE( index.isBalanced() );
+    for( size_t i = 0; i < index.size(); i++ ) {
+        EXPECT_EQ( token[ index.getPosition( i ) ], index.getToken( i ) );
+    }
+}
+
+END_ODDLPARSER_NS
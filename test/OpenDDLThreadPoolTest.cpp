@@ -0,0 +1,71 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "gtest/gtest.h"
+
+#include <openddlparser/OpenDDLThreadPool.h>
+
+#include "UnitTestCommon.h"
+
+#include <atomic>
+
+BEGIN_ODDLPARSER_NS
+
+class OpenDDLThreadPoolTest : public testing::Test {
+    // empty
+};
+
+TEST_F( OpenDDLThreadPoolTest, createTest ) {
+    ThreadPool pool( 3 );
+    EXPECT_EQ( 3U, pool.getNumThreads() );
+    EXPECT_LE( 1U, ThreadPool::getHardwareThreads() );
+}
+
+TEST_F( OpenDDLThreadPoolTest, enqueueTest ) {
+    ThreadPool pool( 4 );
+    std::atomic<size_t> counter( 0 );
+    for( size_t i = 0; i < 100; i++ ) {
+        pool.enqueue( [&counter]() { counter++; } );
+    }
+    pool.wait();
+    EXPECT_EQ( 100U, counter.load() );
+}
+
+TEST_F( OpenDDLThreadPoolTest, parallelForTest ) {
+    ThreadPool pool( 4 );
+    std::vector<size_t> results( 1000, 0 );
+    pool.parallelFor( results.size(), [&results]( size_t i ) {
+        results[ i ] = i * 2;
+    } );
+    for( size_t i = 0; i < results.size(); i++ ) {
+        EXPECT_EQ( i * 2, results[ i ] );
+    }
+
+    // nested calls are executed by the calling thread as well
+    std::atomic<size_t> counter( 0 );
+    pool.parallelFor( 8, [&pool, &counter]( size_t ) {
+        pool.parallelFor( 8, [&counter]( size_t ) { counter++; } );
+    } );
+    EXPECT_EQ( 64U, counter.load() );
+}
+
+END_ODDLPARSER_NS
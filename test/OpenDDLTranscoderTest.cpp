@@ -0,0 +1,162 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "gtest/gtest.h"
+
+#include <openddlparser/OpenDDLTranscoder.h>
+#include <openddlparser/OpenDDLExport.h>
+#include <openddlparser/DDLNode.h>
+
+#include "UnitTestCommon.h"
+
+BEGIN_ODDLPARSER_NS
+
+class OpenDDLTranscoderTest : public testing::Test {
+protected:
+    static bool dropMaterials( const DDLNode *node ) {
+        return "Material" != node->getType();
+    }
+};
+
+class CountingTranscoder : public OpenDDLTranscoder {
+public:
+    CountingTranscoder( OpenDDLExport *exporter )
+    : OpenDDLTranscoder( exporter )
+    , m_numStructures( 0 ) {
+        // empty
+    }
+
+    virtual bool onStructureBegin( DDLNode *node, size_t level ) {
+        m_numStructures++;
+        return OpenDDLTranscoder::onStructureBegin( node, level );
+    }
+
+    size_t m_numStructures;
+};
+
+static const char TranscoderToken[] =
+    "GeometryNode $node1 {\n"
+    "    Metric (key = \"distance\") { float { 1, 2 } }\n"
+    "    Array { int32[ 2 ] { { 1, 2 }, { 3, 4 } } }\n"
+    "}\n"
+    "Material $material1 { Texture { string { \"name\" } } }\n"
+    "Metric { float { 3 } }\n";
+
+TEST_F( OpenDDLTranscoderTest, transcodeTest ) {
+    OpenDDLParser theParser;
+    theParser.setBuffer( TranscoderToken, strlen( TranscoderToken ) );
+
+    std::string result;
+    OpenDDLExport myExporter( new StringStream( result ) );
+    OpenDDLTranscoder myTranscoder( &myExporter );
+    EXPECT_TRUE( myTranscoder.transcode( theParser ) );
+    EXPECT_FALSE( theParser.isStreamingEnabled() );
+
+    // no tree was built
+    ASSERT_NE( ddl_nullptr, theParser.getRoot() );
+    EXPECT_TRUE( theParser.getRoot()->getChildNodeList().empty() );
+
+    // the result is the same as the export of the tree
+    OpenDDLParser treeParser;
+    treeParser.setBuffer( TranscoderToken, strlen( TranscoderToken ) );
+    ASSERT_TRUE( treeParser.parse() );
+    std::string expected;
+    OpenDDLExport treeExporter( new StringStream( expected ) );
+    EXPECT_TRUE( treeExporter.exportContext( treeParser.getContext(), "" ) );
+    EXPECT_EQ( expected, result );
+}
+
+TEST_F( OpenDDLTranscoderTest, filterTest ) {
+    OpenDDLParser theParser;
+    theParser.setBuffer( TranscoderToken, strlen( TranscoderToken ) );
+
+    std::string result;
+    OpenDDLExport myExporter( new StringStream( result ) );
+    OpenDDLTranscoder myTranscoder( &myExporter );
+    myTranscoder.setFilter( dropMaterials );
+    EXPECT_TRUE( myTranscoder.transcode( theParser ) );
+    EXPECT_EQ( std::string::npos, result.find( "Material" ) );
+    EXPECT_EQ( std::string::npos, result.find( "Texture" ) );
+    EXPECT_NE( std::string::npos, result.find( "float { 3 }" ) );
+}
+
+TEST_F( OpenDDLTranscoderTest, transcodeFileTest ) {
+    std::string token;
+    for( size_t i = 0; i < 50; i++ ) {
+        token += TranscoderToken;
+    }
+    const char *filename( "transcodeFileTest.ddl" );
+    FILE *file( ::fopen( filename, "wb" ) );
+    ASSERT_NE( ddl_nullptr, file );
+    ::fwrite( token.c_str(), 1, token.size(), file );
+    ::fclose( file );
+
+    OpenDDLParser theParser;
+    std::string result;
+    OpenDDLExport myExporter( new StringStream( result ) );
+    OpenDDLTranscoder myTranscoder( &myExporter );
+    EXPECT_TRUE( myTranscoder.transcodeFile( theParser, filename, 64 ) );
+    EXPECT_FALSE( theParser.isStreamingEnabled() );
+
+    // the parser buffer holds only the last parsed segment, not the whole file
+    EXPECT_LT( theParser.getBufferSize(), 256U );
+    EXPECT_LT( 256U, token.size() );
+    EXPECT_TRUE( theParser.getRoot()->getChildNodeList().empty() );
+
+    OpenDDLParser treeParser;
+    treeParser.setBuffer( token.c_str(), token.size() );
+    ASSERT_TRUE( treeParser.parse() );
+    std::string expected;
+    OpenDDLExport treeExporter( new StringStream( expected ) );
+    EXPECT_TRUE( treeExporter.exportContext( treeParser.getContext(), "" ) );
+    EXPECT_EQ( expected, result );
+    ::remove( filename );
+
+    EXPECT_FALSE( myTranscoder.transcodeFile( theParser, "notExisting.ddl" ) );
+    EXPECT_FALSE( myTranscoder.transcodeFile( theParser, "" ) );
+}
+
+TEST_F( OpenDDLTranscoderTest, abortTest ) {
+    std::string token;
+    for( size_t i = 0; i < 100; i++ ) {
+        token += "Metric { float { 1, 2, 3 } }\n";
+    }
+    OpenDDLParser theParser;
+    theParser.setBuffer( token.c_str(), token.size() );
+
+    // the receiver rejects the second chunk, the transcoding fails
+    size_t calls( 0 );
+    CallbackStream *stream( new CallbackStream( [&calls]( const char *, size_t ) {
+        calls++;
+        return calls < 2 ? CallbackStream::ChunkAccepted : CallbackStream::ChunkAbort;
+    }, 16 ) );
+    OpenDDLExport myExporter( stream );
+    CountingTranscoder myTranscoder( &myExporter );
+    EXPECT_FALSE( myTranscoder.transcode( theParser ) );
+    EXPECT_TRUE( stream->isAborted() );
+    EXPECT_EQ( 2U, calls );
+
+    // the parser stopped at the failed write
+    EXPECT_LT( myTranscoder.m_numStructures, 100U );
+}
+
+END_ODDLPARSER_NS
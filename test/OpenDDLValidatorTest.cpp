@@ -0,0 +1,137 @@
+/*-----------------------------------------------------------------------------------------------
+The MIT License (MIT)
+
+Copyright (c) 2014-2015 Kim Kulling
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+-----------------------------------------------------------------------------------------------*/
+#include "gtest/gtest.h"
+
+#include <openddlparser/OpenDDLValidator.h>
+#include <openddlparser/OpenDDLParser.h>
+#include <openddlparser/DDLNode.h>
+
+#include "UnitTestCommon.h"
+
+#include <sstream>
+
+BEGIN_ODDLPARSER_NS
+
+class OpenDDLValidatorTest : public testing::Test {
+protected:
+    static std::vector<std::string> getMessages( const OpenDDLValidator &validator ) {
+        std::vector<std::string> messages;
+        for( size_t i = 0; i < validator.getDiagnostics().size(); i++ ) {
+            messages.push_back( validator.getDiagnostics()[ i ].m_message );
+        }
+
+        return messages;
+    }
+};
+
+TEST_F( OpenDDLValidatorTest, validDocumentTest ) {
+    static const char token[] =
+        "GeometryNode $node1 { Name { string { \"a\" } } ObjectRef { ref { $geometry1 } } }\n"
+        "GeometryObject $geometry1 { Mesh { VertexArray { float[ 2 ] { { 1, 2 }, { 3, 4 } } } } }\n"
+        "Animation { Translation %xpos { float { 1 } } Track (target = %xpos) { float { 1 } } }\n";
+
+    OpenDDLParser theParser;
+    theParser.setBuffer( token, strlen( token ) );
+    ASSERT_TRUE( theParser.parse() );
+
+    OpenDDLValidator validator( 2 );
+    EXPECT_TRUE( validator.validate( theParser.getContext() ) );
+    EXPECT_EQ( 0U, validator.getNumErrors() );
+    EXPECT_TRUE( validator.getDiagnostics().empty() );
+}
+
+TEST_F( OpenDDLValidatorTest, invalidDocumentTest ) {
+    static const char token[] =
+        "GeometryNode $node1 { ObjectRef { ref { $missing } } }\n"
+        "GeometryNode $node1 { Translation %a { float { 1 } } Translation %a { float { 2 } } }\n"
+        "VertexArray { float[ 2 ] { { 1, 2 }, { 3 } } }\n"
+        "Track (target = %nothing) { float { 1 } }\n";
+
+    OpenDDLParser theParser;
+    theParser.setBuffer( token, strlen( token ) );
+    ASSERT_TRUE( theParser.parse() );
+    const DDLNode::DllNodeList &childs( theParser.getRoot()->getChildNodeList() );
+    ASSERT_EQ( 4U, childs.size() );
+
+    OpenDDLValidator validator( 2 );
+    EXPECT_FALSE( validator.validate( theParser.getRoot() ) );
+    EXPECT_EQ( 5U, validator.getNumErrors() );
+    const std::vector<Diagnostic> &diagnostics( validator.getDiagnostics() );
+    ASSERT_EQ( 5U, diagnostics.size() );
+    EXPECT_EQ( "ObjectRef: unresolved reference $missing", diagnostics[ 0 ].m_message );
+    EXPECT_EQ( childs[ 0 ]->getChildNodeList()[ 0 ], diagnostics[ 0 ].m_node );
+    EXPECT_EQ( "GeometryNode: duplicate global name $node1", diagnostics[ 1 ].m_message );
+    EXPECT_EQ( childs[ 1 ], diagnostics[ 1 ].m_node );
+    EXPECT_EQ( "Translation: duplicate local name %a", diagnostics[ 2 ].m_message );
+    EXPECT_EQ( childs[ 1 ]->getChildNodeList()[ 1 ], diagnostics[ 2 ].m_node );
+    EXPECT_EQ( "VertexArray: subarray 1 has 1 items, expected 2", diagnostics[ 3 ].m_message );
+    EXPECT_EQ( "Track: unresolved reference %nothing", diagnostics[ 4 ].m_message );
+    EXPECT_EQ( ddl_error_msg, diagnostics[ 4 ].m_severity );
+
+    validator.clear();
+    EXPECT_TRUE( validator.getDiagnostics().empty() );
+}
+
+TEST_F( OpenDDLValidatorTest, duplicatePropertyTest ) {
+    DDLNode *node( DDLNode::create( "Metric", "" ) );
+    Property *first( new Property( new Text( "key", 3 ) ) );
+    first->m_next = new Property( new Text( "key", 3 ) );
+    node->setProperties( first );
+
+    OpenDDLValidator validator( 1 );
+    EXPECT_TRUE( validator.validate( node ) );
+    ASSERT_EQ( 1U, validator.getDiagnostics().size() );
+    EXPECT_EQ( ddl_warn_msg, validator.getDiagnostics()[ 0 ].m_severity );
+    EXPECT_EQ( "Metric: duplicate property key", validator.getDiagnostics()[ 0 ].m_message );
+    delete node;
+}
+
+TEST_F( OpenDDLValidatorTest, deterministicTest ) {
+    std::stringstream stream;
+    for( int i = 0; i < 300; i++ ) {
+        stream << "GeometryNode $node" << ( i % 150 ) << " {\n"
+               << "    Translation %xpos { float { 1 } }\n"
+               << "    ObjectRef { ref { $geometry" << i % 7 << " } }\n"
+               << "}\n";
+    }
+    for( int i = 0; i < 5; i++ ) {
+        stream << "GeometryObject $geometry" << i << " { Metric { float { 1 } } }\n";
+    }
+    const std::string token( stream.str() );
+
+    OpenDDLParser theParser;
+    theParser.setBuffer( token.c_str(), token.size() );
+    ASSERT_TRUE( theParser.parse() );
+
+    // 150 duplicates and 2 of 7 references unresolved
+    OpenDDLValidator serial( 1 ), parallel( 8 );
+    EXPECT_FALSE( serial.validate( theParser.getRoot() ) );
+    EXPECT_FALSE( parallel.validate( theParser.getRoot() ) );
+    EXPECT_EQ( 150U + 85U, serial.getNumErrors() );
+    EXPECT_EQ( getMessages( serial ), getMessages( parallel ) );
+    for( size_t i = 0; i < serial.getDiagnostics().size(); i++ ) {
+        EXPECT_EQ( serial.getDiagnostics()[ i ].m_node, parallel.getDiagnostics()[ i ].m_node );
+    }
+}
+
+END_ODDLPARSER_NS
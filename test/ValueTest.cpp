@@ -146,6 +146,30 @@ TEST_F( ValueTest, IteratePostIncTest ) {
     }
 }
 
+TEST_F( ValueTest, IteratePostIncResultTest ) {
+    Value *val( createValueList() );
+    Value::Iterator it( val );
+    Value::Iterator tmp = it++;
+    EXPECT_EQ( val, tmp.operator->() );
+    EXPECT_EQ( val->getNext(), it.operator->() );
+
+    // the end of the list is kept by each iterator on its own
+    Value::Iterator end1( ddl_nullptr ), end2( ddl_nullptr );
+    ++end1;
+    end1++;
+    EXPECT_EQ( ddl_nullptr, end1.operator->() );
+    EXPECT_TRUE( end1 == end2 );
+}
+
+TEST_F( ValueTest, constAccessTest ) {
+    Value *data = ValueAllocator::allocPrimData( Value::ddl_int32 );
+    data->setInt32( 10 );
+    const Value &constData( *data );
+    EXPECT_EQ( 10, constData.getInt32() );
+    EXPECT_EQ( 1U, constData.size() );
+    ValueAllocator::releasePrimData( &data );
+}
+
 TEST_F( ValueTest, accessInt8Test ) {
     Value *data = ValueAllocator::allocPrimData( Value::ddl_int8 );
     data->setInt8( 10 );